@@ -304,11 +304,11 @@ void CSVExportWizard::on_apply()
 	//Write data
 	//TODO: lots of redundant casting, this can probably be optimized!
 	int64_t lastTimestamp = LONG_LONG_MIN;
-	for(size_t i=0; i<timebaseWaveform->m_offsets.size(); i++)
+	for(size_t i=0; i<timebaseWaveform->size(); i++)
 	{
 		//Get current timestamp
 		auto timestamp =
-			(timebaseWaveform->m_offsets[i] * timebaseWaveform->m_timescale) +
+			(timebaseWaveform->GetOffset(i) * timebaseWaveform->m_timescale) +
 			timebaseWaveform->m_triggerPhase;
 
 		//Write timestamp
@@ -325,7 +325,7 @@ void CSVExportWizard::on_apply()
 		{
 			case OscilloscopeChannel::CHANNEL_TYPE_ANALOG:
 				{
-					auto refan = dynamic_cast<AnalogWaveform*>(timebaseWaveform);
+					auto refan = GetAnalogWaveform(timebaseWaveform);
 					fprintf(fp, ",%f", refan->m_samples[i].m_value);
 				}
 				break;
@@ -356,10 +356,10 @@ void CSVExportWizard::on_apply()
 			auto w = waveforms[j];
 			int64_t sstart = 0;
 			int64_t send = 0;
-			for(; k < w->m_offsets.size(); k++)
+			for(; k < w->size(); k++)
 			{
-				sstart = (w->m_offsets[k] * w->m_timescale) + w->m_triggerPhase;
-				send = sstart + (w->m_durations[k] * w->m_timescale);
+				sstart = (w->GetOffset(k) * w->m_timescale) + w->m_triggerPhase;
+				send = sstart + (w->GetDuration(k) * w->m_timescale);
 
 				//If this sample ends in the future, we're good to go.
 				if(send > timestamp)
@@ -382,8 +382,8 @@ void CSVExportWizard::on_apply()
 				case OscilloscopeChannel::CHANNEL_TYPE_ANALOG:
 					{
 						//No interpolation for last sample since there's no next to lerp to
-						auto an = dynamic_cast<AnalogWaveform*>(w);
-						if(k+1 > w->m_offsets.size())
+						auto an = GetAnalogWaveform(w);
+						if(k+1 > w->size())
 							fprintf(fp, ",%f", an->m_samples[k].m_value);
 
 						//Interpolate
@@ -393,7 +393,7 @@ void CSVExportWizard::on_apply()
 							float vright = an->m_samples[k+1].m_value;
 
 							int64_t tleft = sstart;
-							int64_t tright = (w->m_offsets[k+1] * w->m_timescale) + w->m_triggerPhase;
+							int64_t tright = (w->GetOffset(k+1) * w->m_timescale) + w->m_triggerPhase;
 
 							float frac = 1.0 * (timestamp - tleft) / (tright - tleft);
 
@@ -274,8 +274,8 @@ void TouchstoneExportWizard::on_apply()
 
 			auto magrow = group->m_magBox.get_active_row_number();
 			auto angrow = group->m_angBox.get_active_row_number();
-			auto magData = dynamic_cast<AnalogWaveform*>(group->m_magStreams[magrow].GetData());
-			auto angData = dynamic_cast<AnalogWaveform*>(group->m_angStreams[angrow].GetData());
+			auto magData = GetAnalogWaveform(group->m_magStreams[magrow].GetData());
+			auto angData = GetAnalogWaveform(group->m_angStreams[angrow].GetData());
 			if(!magData || !angData)
 			{
 				LogError("Missing mag or angle data\n");
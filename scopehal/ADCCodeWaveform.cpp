@@ -0,0 +1,135 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* libscopehal v0.1                                                                                                     *
+*                                                                                                                      *
+* Copyright (c) 2012-2022 Andrew D. Zonenberg and contributors                                                         *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of ADCCodeWaveformBase
+ */
+
+#include "scopehal.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+ADCCodeWaveformBase::ADCCodeWaveformBase()
+	: m_gain(1)
+	, m_offset(0)
+	, m_voltageCache(NULL)
+	, m_voltageCacheRevision(0)
+{
+}
+
+ADCCodeWaveformBase::~ADCCodeWaveformBase()
+{
+	InvalidateVoltageCache();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Conversion
+
+/**
+	@brief Gets the waveform converted to volts, converting it if this hasn't been done for the current revision
+
+	The copy is uniformly sampled, so it costs 4 bytes per sample rather than the 20 of an AnalogWaveform. It's owned
+	by this object and remains valid until the codes or scaling are next modified (see MarkModified()), resized or
+	cleared.
+ */
+UniformAnalogWaveform* ADCCodeWaveformBase::GetVoltageWaveform()
+{
+	lock_guard<mutex> lock(m_voltageCacheMutex);
+	if(m_voltageCache && (m_voltageCacheRevision == m_revision))
+		return m_voltageCache;
+
+	//Reuse the old copy's buffer if the codes changed since it was made
+	size_t len = size();
+	auto cap = m_voltageCache;
+	if(cap == NULL)
+		cap = WaveformPool::Get<UniformAnalogWaveform>(len);
+	cap->m_timescale = m_timescale;
+	cap->m_startTimestamp = m_startTimestamp;
+	cap->m_startFemtoseconds = m_startFemtoseconds;
+	cap->m_triggerPhase = m_triggerPhase;
+	cap->m_flags = m_flags;
+	cap->Resize(len);
+
+	//Convert in blocks small enough that the codes and the floats stay in L2 while we work on them
+	const size_t blocksize = 16384;
+	size_t numblocks = (len + blocksize - 1) / blocksize;
+	#pragma omp parallel for
+	for(size_t i=0; i<numblocks; i++)
+	{
+		size_t start = i*blocksize;
+		size_t end = min(len, start + blocksize);
+		ConvertToVolts((float*)&cap->m_samples[start], start, end - start);
+	}
+	cap->MarkModified();
+
+	m_voltageCache = cap;
+	m_voltageCacheRevision = m_revision;
+	return cap;
+}
+
+/**
+	@brief Discards the converted copies of the waveform (both the uniform one and the sparse one), if there are any
+ */
+void ADCCodeWaveformBase::InvalidateVoltageCache()
+{
+	InvalidateSparseCopy();
+
+	lock_guard<mutex> lock(m_voltageCacheMutex);
+	if(m_voltageCache)
+	{
+		WaveformPool::Return(m_voltageCache);
+		m_voltageCache = NULL;
+	}
+}
+
+/**
+	@brief Resets the waveform for recycling, including the scaling
+ */
+void ADCCodeWaveformBase::ResetForReuse()
+{
+	UniformWaveformBase::ResetForReuse();
+	m_gain = 1;
+	m_offset = 0;
+}
+
+/**
+	@brief Gets the number of bytes used by the converted copy of the waveform
+ */
+size_t ADCCodeWaveformBase::GetVoltageCacheBytes() const
+{
+	lock_guard<mutex> lock(m_voltageCacheMutex);
+	if(m_voltageCache)
+		return m_voltageCache->GetAllocatedBytes();
+	return 0;
+}
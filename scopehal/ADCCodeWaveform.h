@@ -0,0 +1,209 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* libscopehal v0.1                                                                                                     *
+*                                                                                                                      *
+* Copyright (c) 2012-2022 Andrew D. Zonenberg and contributors                                                         *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of ADCCodeWaveformBase and ADCCodeWaveform
+ */
+
+#ifndef ADCCodeWaveform_h
+#define ADCCodeWaveform_h
+
+#include <mutex>
+
+#include "Waveform.h"
+
+/**
+	@brief Base class for uniformly sampled analog waveforms which store raw ADC codes rather than volts
+
+	The voltage of sample i is m_samples[i] * m_gain - m_offset, the same convention used by
+	Oscilloscope::Convert8BitSamples() and friends.
+
+	Nothing is converted up front. Consumers that only compare against a threshold can work on the codes directly
+	(see VoltageToCode()), and ConvertToVolts() converts just the range a consumer asks for. Consumers that need the
+	whole waveform in volts call GetVoltageWaveform(), which converts into a UniformAnalogWaveform (no timestamps) the
+	first time it's called and keeps the result for the current revision of the codes. Code that modifies samples or
+	scaling in place must call MarkModified() afterwards (SetScaling() does this itself).
+ */
+class ADCCodeWaveformBase : public UniformWaveformBase
+{
+public:
+	ADCCodeWaveformBase();
+	virtual ~ADCCodeWaveformBase();
+
+	///@brief Volts per ADC code. Call MarkModified() after changing, or use SetScaling().
+	float m_gain;
+
+	///@brief Offset subtracted from the scaled code to get volts. Call MarkModified() after changing, or use SetScaling().
+	float m_offset;
+
+	///@brief Sets the code-to-volts scaling, invalidating anything converted with the old values
+	void SetScaling(float gain, float offset)
+	{
+		m_gain = gain;
+		m_offset = offset;
+		MarkModified();
+	}
+
+	virtual float GetVoltage(size_t i) const =0;
+	virtual void ConvertToVolts(float* out, size_t start, size_t count) const =0;
+
+	UniformAnalogWaveform* GetVoltageWaveform();
+	void InvalidateVoltageCache();
+
+	virtual bool HasAnalogSamples() const
+	{ return true; }
+
+	virtual void ResetForReuse();
+
+	/**
+		@brief Converts a voltage to the equivalent (fractional) ADC code
+
+		Note that if m_gain is negative, higher voltages map to lower codes.
+	 */
+	float VoltageToCode(float volts) const
+	{ return (volts + m_offset) / m_gain; }
+
+protected:
+	virtual void GetAnalogSamples(float* out, size_t start, size_t count) const
+	{ ConvertToVolts(out, start, count); }
+
+	size_t GetVoltageCacheBytes() const;
+
+	///@brief Mutex protecting m_voltageCache and m_voltageCacheRevision
+	mutable std::mutex m_voltageCacheMutex;
+
+	///@brief Floating point copy of the waveform, or NULL if not converted yet
+	UniformAnalogWaveform* m_voltageCache;
+
+	///@brief Value of m_revision when m_voltageCache was converted
+	uint64_t m_voltageCacheRevision;
+};
+
+/**
+	@brief A uniformly sampled analog waveform stored as raw ADC codes of type T
+ */
+template<class T>
+class ADCCodeWaveform : public ADCCodeWaveformBase
+{
+public:
+
+	///@brief Raw ADC codes
+	std::vector< T, AlignedAllocator<T, 64> > m_samples;
+
+	virtual size_t size() const
+	{ return m_samples.size(); }
+
+	virtual size_t capacity() const
+	{ return m_samples.capacity(); }
+
+	virtual size_t GetAllocatedBytes() const
+	{ return m_samples.capacity() * sizeof(T) + GetVoltageCacheBytes() + GetSparseCopyBytes(); }
+
+	virtual void Resize(size_t size)
+	{
+		InvalidateVoltageCache();
+		m_samples.resize(size);
+	}
+
+	virtual void Reserve(size_t size)
+	{ m_samples.reserve(size); }
+
+	virtual void clear()
+	{
+		InvalidateVoltageCache();
+		m_samples.clear();
+	}
+
+	virtual float GetVoltage(size_t i) const
+	{ return m_samples[i] * m_gain - m_offset; }
+
+	virtual void ConvertToVolts(float* out, size_t start, size_t count) const
+	{
+		const T* in = &m_samples[start];
+		for(size_t i=0; i<count; i++)
+			out[i] = in[i] * m_gain - m_offset;
+	}
+};
+
+typedef ADCCodeWaveform<int8_t>		ADC8Waveform;
+typedef ADCCodeWaveform<int16_t>	ADC16Waveform;
+
+/**
+	@brief Gets a waveform as floating point volts with explicit timestamps
+
+	@return	The waveform itself if it's an AnalogWaveform, a converted copy if it's uniformly sampled (including raw ADC
+			codes), or NULL if it isn't analog at all.
+ */
+inline AnalogWaveform* GetAnalogWaveform(WaveformBase* wfm)
+{
+	auto awfm = dynamic_cast<AnalogWaveform*>(wfm);
+	if(awfm)
+		return awfm;
+
+	auto uwfm = dynamic_cast<UniformWaveformBase*>(wfm);
+	if(uwfm)
+		return uwfm->GetSparseAnalogCopy();
+
+	return NULL;
+}
+
+/**
+	@brief Gets a uniformly sampled waveform as floating point volts
+
+	@return	The waveform itself if it's a UniformAnalogWaveform, the converted copy if it's made of raw ADC codes, or NULL
+			otherwise.
+ */
+inline UniformAnalogWaveform* GetUniformAnalogWaveform(WaveformBase* wfm)
+{
+	auto uwfm = dynamic_cast<UniformAnalogWaveform*>(wfm);
+	if(uwfm)
+		return uwfm;
+
+	auto codes = dynamic_cast<ADCCodeWaveformBase*>(wfm);
+	if(codes)
+		return codes->GetVoltageWaveform();
+
+	return NULL;
+}
+
+/**
+	@brief Returns true if a waveform is analog, in any representation, without converting it
+ */
+inline bool IsAnalogWaveform(WaveformBase* wfm)
+{
+	if(dynamic_cast<AnalogWaveform*>(wfm))
+		return true;
+
+	auto uwfm = dynamic_cast<UniformWaveformBase*>(wfm);
+	return uwfm && uwfm->HasAnalogSamples();
+}
+
+#endif
@@ -578,7 +578,7 @@ void AgilentOscilloscope::ProcessDigitalWaveforms(
 		auto channel = m_digitalChannelBase + chan_start + i;
 		if (IsChannelEnabled(channel))
 		{
-			auto cap = new DigitalWaveform;
+			auto cap = WaveformPool::Get<DigitalWaveform>();
 			int64_t fs_per_sample = round(preamble.xincrement * FS_PER_SECOND);
 			cap->m_timescale = fs_per_sample;
 			cap->m_startFemtoseconds = 0;
@@ -648,7 +648,7 @@ bool AgilentOscilloscope::AcquireData()
 
 		//Set up the capture we're going to store our data into
 		//(no TDC data available on Agilent scopes?)
-		AnalogWaveform* cap = new AnalogWaveform;
+		AnalogWaveform* cap = WaveformPool::Get<AnalogWaveform>();
 		cap->m_timescale = fs_per_sample;
 		cap->m_triggerPhase = 0;
 		cap->m_startTimestamp = time(NULL);
@@ -374,7 +374,7 @@ bool AntikernelLabsOscilloscope::AcquireData()
 	LogIndenter li;
 
 	//1600 ps per sample for now, hard coded
-	AnalogWaveform* cap = new AnalogWaveform;
+	AnalogWaveform* cap = WaveformPool::Get<AnalogWaveform>();
 	cap->m_timescale = 1600;
 	cap->m_triggerPhase = 0;
 	double t = GetTime();
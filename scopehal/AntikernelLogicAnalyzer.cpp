@@ -317,7 +317,7 @@ bool AntikernelLogicAnalyzer::AcquireData()
 	double time = GetTime();
 	double fs = (time - floor(time)) * FS_PER_SECOND;
 	{
-		DigitalWaveform* cap = new DigitalWaveform;
+		DigitalWaveform* cap = WaveformPool::Get<DigitalWaveform>();
 		cap->m_timescale = m_samplePeriod / 2;
 		cap->m_triggerPhase = 0;
 		cap->m_startTimestamp = time;
@@ -355,7 +355,7 @@ bool AntikernelLogicAnalyzer::AcquireData()
 			size_t nbit = nlow % 8;
 
 			//Create the channel
-			DigitalWaveform* cap = new DigitalWaveform;
+			DigitalWaveform* cap = WaveformPool::Get<DigitalWaveform>();
 			cap->m_timescale = m_samplePeriod;
 			cap->m_triggerPhase = 0;
 			cap->m_startTimestamp = time;
@@ -379,26 +379,28 @@ bool AntikernelLogicAnalyzer::AcquireData()
 		else
 		{
 			//Create the channel
-			DigitalBusWaveform* cap = new DigitalBusWaveform;
+			DigitalBusWaveform* cap = WaveformPool::Get<DigitalBusWaveform>(m_memoryDepth);
 			cap->m_timescale = m_samplePeriod;
 			cap->m_triggerPhase = 0;
 			cap->m_startTimestamp = time;
 			cap->m_startFemtoseconds = fs;
-			cap->m_samples.resize(m_memoryDepth);
+			cap->m_width = cwidth;
+			cap->Resize(m_memoryDepth);
 
 			for(size_t j=0; j<m_memoryDepth; j++)
 			{
 				cap->m_offsets[j] = j;
 				cap->m_durations[j] = 1;
 
-				vector<bool> bits;
+				uint64_t bits = 0;
 				for(size_t k=0; k<cwidth; k++)
 				{
 					size_t off = nlow + k;
 					size_t nbyte = off / 8;
 					size_t nbit = off % 8;
 					uint8_t s = data[j*bytewidth + nbyte];
-					bits.push_back((s >> nbit) & 1 ? true : false);
+					if( (s >> nbit) & 1)
+						bits |= (1ULL << k);
 				}
 
 				cap->m_samples[j] = bits;
@@ -376,7 +376,7 @@ bool DSLabsOscilloscope::AcquireData()
 				return false;
 
 			//Create our waveform
-			AnalogWaveform* cap = new AnalogWaveform;
+			AnalogWaveform* cap = WaveformPool::Get<AnalogWaveform>();
 			cap->m_timescale = fs_per_sample;
 			cap->m_triggerPhase = trigphase;
 			cap->m_startTimestamp = time(NULL);
@@ -403,7 +403,7 @@ bool DSLabsOscilloscope::AcquireData()
 				return false;
 
 			//Create buffers for output waveforms
-			DigitalWaveform* cap = new DigitalWaveform;
+			DigitalWaveform* cap = WaveformPool::Get<DigitalWaveform>();
 			s[m_channels[chnum]] = cap;
 			cap->m_timescale = fs_per_sample;
 			cap->m_triggerPhase = 0;
@@ -489,7 +489,7 @@ bool DSLabsOscilloscope::AcquireData()
 	{
 		SequenceSet set = *m_pendingWaveforms.begin();
 		for(auto it : set)
-			delete it.second;
+			WaveformPool::Return(it.second);
 		m_pendingWaveforms.pop_front();
 
 		dropped++;
@@ -299,7 +299,7 @@ bool DigilentOscilloscope::AcquireData()
 				return false;
 
 			//Create our waveform
-			AnalogWaveform* cap = new AnalogWaveform;
+			AnalogWaveform* cap = WaveformPool::Get<AnalogWaveform>();
 			cap->m_timescale = fs_per_sample;
 			cap->m_triggerPhase = trigphase;
 			cap->m_startTimestamp = time(NULL);
@@ -334,7 +334,7 @@ bool DigilentOscilloscope::AcquireData()
 			DigitalWaveform* caps[8];
 			for(size_t j=0; j<8; j++)
 			{
-				caps[j] = new DigitalWaveform;
+				caps[j] = WaveformPool::Get<DigitalWaveform>();
 				s[m_channels[m_digitalChannelBase + 8*podnum + j] ] = caps[j];
 			}
 
@@ -0,0 +1,168 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* libscopehal v0.1                                                                                                     *
+*                                                                                                                      *
+* Copyright (c) 2012-2022 Andrew D. Zonenberg and contributors                                                         *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of EdgeCache
+ */
+
+#include "scopehal.h"
+#include "EdgeCache.h"
+
+using namespace std;
+
+mutex EdgeCache::m_mutex;
+EdgeCache::EntryMap EdgeCache::m_entries;
+EdgeCache::LRUList EdgeCache::m_lru;
+size_t EdgeCache::m_byteBudget = 256LL * 1024LL * 1024LL;
+size_t EdgeCache::m_bytesUsed = 0;
+size_t EdgeCache::m_hits = 0;
+size_t EdgeCache::m_misses = 0;
+size_t EdgeCache::m_evictions = 0;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Lookup and insertion
+
+/**
+	@brief Looks up the edges of the current revision of a waveform
+
+	@return The cached list, or NULL if there is none
+ */
+EdgeCache::EdgeList EdgeCache::Find(WaveformBase* wfm, float threshold, EdgeType type)
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	auto it = m_entries.find(Key(wfm, wfm->m_revision, threshold, type));
+	if(it == m_entries.end())
+	{
+		m_misses ++;
+		return NULL;
+	}
+	m_hits ++;
+
+	//Move to the front of the LRU list
+	m_lru.splice(m_lru.begin(), m_lru, it->second.m_lruPosition);
+	return it->second.m_edges;
+}
+
+/**
+	@brief Adds the edges of the current revision of a waveform to the cache
+
+	Anything cached for older revisions of the same waveform is discarded, since it can never be looked up again.
+ */
+void EdgeCache::Insert(WaveformBase* wfm, float threshold, EdgeType type, EdgeList edges)
+{
+	if(edges == NULL)
+		return;
+
+	lock_guard<mutex> lock(m_mutex);
+
+	uint64_t revision = wfm->m_revision;
+
+	//Entries are sorted by waveform then revision, so all of this waveform's entries are contiguous.
+	//Drop any for other revisions.
+	bool found = false;
+	auto it = m_entries.lower_bound(Key(wfm, 0, 0, EDGE_RISING));
+	while( (it != m_entries.end()) && (it->first.m_waveform == wfm) )
+	{
+		if(it->first.m_revision != revision)
+		{
+			auto next = it;
+			++next;
+			Remove(it);
+			it = next;
+			continue;
+		}
+
+		//Someone else found the same edges while we were working on them
+		if( (it->first.m_threshold == threshold) && (it->first.m_type == type) )
+			found = true;
+		++it;
+	}
+	if(found)
+		return;
+
+	Key key(wfm, revision, threshold, type);
+	m_lru.push_front(key);
+
+	Entry& entry = m_entries[key];
+	entry.m_edges = edges;
+	entry.m_bytes = edges->capacity() * sizeof(int64_t);
+	entry.m_lruPosition = m_lru.begin();
+	m_bytesUsed += entry.m_bytes;
+
+	EvictToBudget();
+}
+
+/**
+	@brief Removes an entry from the cache. The caller must hold m_mutex.
+ */
+void EdgeCache::Remove(EntryMap::iterator it)
+{
+	m_bytesUsed -= it->second.m_bytes;
+	m_lru.erase(it->second.m_lruPosition);
+	m_entries.erase(it);
+}
+
+/**
+	@brief Evicts least recently used entries until the cache is within its byte budget. The caller must hold m_mutex.
+ */
+void EdgeCache::EvictToBudget()
+{
+	while( (m_bytesUsed > m_byteBudget) && !m_lru.empty() )
+	{
+		Remove(m_entries.find(m_lru.back()));
+		m_evictions ++;
+	}
+}
+
+/**
+	@brief Discards all cached edges
+
+	Lists which have already been handed out remain valid.
+ */
+void EdgeCache::Clear()
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_entries.clear();
+	m_lru.clear();
+	m_bytesUsed = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Statistics
+
+void EdgeCache::ResetStatistics()
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_hits = 0;
+	m_misses = 0;
+	m_evictions = 0;
+}
@@ -0,0 +1,182 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* libscopehal v0.1                                                                                                     *
+*                                                                                                                      *
+* Copyright (c) 2012-2022 Andrew D. Zonenberg and contributors                                                         *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of EdgeCache
+ */
+
+#ifndef EdgeCache_h
+#define EdgeCache_h
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "Waveform.h"
+
+/**
+	@brief Shared cache of edge timestamps found in waveforms.
+
+	Many filters look for edges in the same waveform at the same threshold (a clock feeding several decodes, or the
+	period, frequency, and duty cycle of one signal). Rather than having each one scan the waveform, Filter::GetEdges()
+	stores the edges it finds here and hands out the same immutable list to everyone who asks.
+
+	Entries are keyed by waveform, revision (see WaveformBase::MarkModified()), threshold, and edge type. Since a
+	waveform gets a new revision whenever its content changes, a stale list can never be returned; lists for older
+	revisions of a waveform are dropped as soon as one for a newer revision is added.
+
+	The cache holds at most GetByteBudget() bytes of edge lists. When over budget, the least recently used lists are
+	evicted. Lists which have been handed out stay valid for as long as the caller holds a reference to them.
+ */
+class EdgeCache
+{
+public:
+
+	enum EdgeType
+	{
+		EDGE_RISING,
+		EDGE_FALLING,
+		EDGE_ANY
+	};
+
+	typedef std::shared_ptr<const std::vector<int64_t> > EdgeList;
+
+	static EdgeList Find(WaveformBase* wfm, float threshold, EdgeType type);
+	static void Insert(WaveformBase* wfm, float threshold, EdgeType type, EdgeList edges);
+	static void Clear();
+
+	///@brief Sets the maximum number of bytes of edge lists to keep around
+	static void SetByteBudget(size_t bytes)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_byteBudget = bytes;
+		EvictToBudget();
+	}
+
+	static size_t GetByteBudget()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_byteBudget;
+	}
+
+	///@brief Number of bytes of edge lists currently held by the cache
+	static size_t GetBytesUsed()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_bytesUsed;
+	}
+
+	///@brief Number of Find() calls which returned a cached list
+	static size_t GetHitCount()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_hits;
+	}
+
+	///@brief Number of Find() calls which found nothing
+	static size_t GetMissCount()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_misses;
+	}
+
+	///@brief Number of lists evicted to stay under the byte budget
+	static size_t GetEvictionCount()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_evictions;
+	}
+
+	static void ResetStatistics();
+
+protected:
+
+	///@brief Identifies one set of edges in one revision of a waveform
+	class Key
+	{
+	public:
+		Key(WaveformBase* wfm, uint64_t revision, float threshold, EdgeType type)
+		: m_waveform(wfm)
+		, m_revision(revision)
+		, m_threshold(threshold)
+		, m_type(type)
+		{}
+
+		bool operator<(const Key& rhs) const
+		{
+			if(m_waveform != rhs.m_waveform)
+				return m_waveform < rhs.m_waveform;
+			if(m_revision != rhs.m_revision)
+				return m_revision < rhs.m_revision;
+			if(m_threshold != rhs.m_threshold)
+				return m_threshold < rhs.m_threshold;
+			return m_type < rhs.m_type;
+		}
+
+		WaveformBase* m_waveform;
+		uint64_t m_revision;
+		float m_threshold;
+		EdgeType m_type;
+	};
+
+	typedef std::list<Key> LRUList;
+
+	class Entry
+	{
+	public:
+		EdgeList m_edges;
+		size_t m_bytes;
+
+		///@brief Position of this entry in m_lru
+		LRUList::iterator m_lruPosition;
+	};
+
+	typedef std::map<Key, Entry> EntryMap;
+
+	static void Remove(EntryMap::iterator it);
+	static void EvictToBudget();
+
+	static std::mutex m_mutex;
+
+	static EntryMap m_entries;
+
+	///@brief Keys of all entries, most recently used first
+	static LRUList m_lru;
+
+	static size_t m_byteBudget;
+	static size_t m_bytesUsed;
+	static size_t m_hits;
+	static size_t m_misses;
+	static size_t m_evictions;
+};
+
+#endif
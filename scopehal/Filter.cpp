@@ -36,16 +36,19 @@
 #include "scopehal.h"
 #include "Filter.h"
 
+#include <immintrin.h>
+#include <omp.h>
+
 using namespace std;
 
 Filter::CreateMapType Filter::m_createprocs;
 set<Filter*> Filter::m_filters;
 
-mutex Filter::m_cacheMutex;
-map<pair<WaveformBase*, float>, vector<int64_t> > Filter::m_zeroCrossingCache;
-
 map<string, unsigned int> Filter::m_instanceCount;
 
+atomic<uint64_t> Filter::m_totalCacheHits(0);
+atomic<uint64_t> Filter::m_totalCacheMisses(0);
+
 Gdk::Color Filter::m_standardColors[STANDARD_COLOR_COUNT] =
 {
 	Gdk::Color("#336699"),	//COLOR_DATA
@@ -68,6 +71,11 @@ Filter::Filter(
 	const string& kernelPath,
 	const string& kernelName)
 	: OscilloscopeChannel(NULL, "", type, color, 1)	//TODO: handle this better?
+	, m_hasRefreshState(false)
+	, m_lastConfigurationHash(0)
+	, m_incrementalRefresh(false)
+	, m_cacheHits(0)
+	, m_cacheMisses(0)
 	, m_category(cat)
 	, m_dirty(true)
 	, m_usingDefault(true)
@@ -168,6 +176,75 @@ bool Filter::IsScalarOutput()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Refreshing
 
+/**
+	@brief Finds every filter whose output depends on any of the given streams, directly or through other filters
+
+	Only input edges of the filter graph are followed, so filters fed by unrelated channels (another instrument, an
+	import filter, etc) are not included.
+ */
+set<Filter*> Filter::GetDownstreamFilters(const set<StreamDescriptor>& streams)
+{
+	//Reverse the input edges of the graph: for each stream, which filters read it
+	map<StreamDescriptor, vector<Filter*> > consumers;
+	for(auto f : m_filters)
+	{
+		for(size_t i=0; i<f->GetInputCount(); i++)
+		{
+			auto in = f->GetInput(i);
+			if(in)
+				consumers[in].push_back(f);
+		}
+	}
+
+	//Walk downstream from the filters reading the starting streams.
+	//Once a filter is refreshed all of its outputs change, so everything reading any of its streams comes along.
+	set<Filter*> ret;
+	vector<Filter*> pending;
+	for(auto s : streams)
+	{
+		auto it = consumers.find(s);
+		if(it == consumers.end())
+			continue;
+		for(auto f : it->second)
+		{
+			if(ret.insert(f).second)
+				pending.push_back(f);
+		}
+	}
+	while(!pending.empty())
+	{
+		auto f = pending.back();
+		pending.pop_back();
+
+		for(size_t i=0; i<f->GetStreamCount(); i++)
+		{
+			auto it = consumers.find(StreamDescriptor(f, i));
+			if(it == consumers.end())
+				continue;
+			for(auto g : it->second)
+			{
+				if(ret.insert(g).second)
+					pending.push_back(g);
+			}
+		}
+	}
+
+	return ret;
+}
+
+/**
+	@brief Marks every filter that depends on any of the given streams as dirty, leaving the rest of the graph alone
+
+	@return The set of filters that were marked dirty
+ */
+set<Filter*> Filter::SetDirtyDownstreamOf(const set<StreamDescriptor>& streams)
+{
+	auto filters = GetDownstreamFilters(streams);
+	for(auto f : filters)
+		f->SetDirty();
+	return filters;
+}
+
 void Filter::RefreshInputsIfDirty()
 {
 	for(auto c : m_inputs)
@@ -185,11 +262,369 @@ void Filter::RefreshIfDirty()
 	if(m_dirty)
 	{
 		RefreshInputsIfDirty();
-		Refresh();
+
+		//If none of our inputs or parameters changed since last time, our output is still good
+		if(IsLastRefreshCurrent())
+		{
+			m_cacheHits ++;
+			m_totalCacheHits ++;
+		}
+
+		else
+		{
+			m_cacheMisses ++;
+			m_totalCacheMisses ++;
+
+			BeginIncrementalRefresh();
+			if(FilterProfiler::IsEnabled())
+				ProfiledRefresh();
+			else
+				Refresh();
+			SaveRefreshState();
+		}
+
 		m_dirty = false;
 	}
 }
 
+/**
+	@brief Returns true if our outputs depend only on our inputs and parameters.
+
+	If true (the default), RefreshIfDirty() skips Refresh() when no input revision, input vertical scale or parameter
+	has changed since the last refresh. Filters that generate new data on every refresh (signal generators, noise
+	sources, etc) must return false.
+ */
+bool Filter::IsResultCacheable()
+{
+	return true;
+}
+
+/**
+	@brief Returns true if this filter can extend its outputs using only newly appended input samples.
+
+	Filters that return true must check IsIncrementalRefresh() in Refresh(). Default is false, which means every
+	refresh recomputes the full output.
+ */
+bool Filter::SupportsIncrementalRefresh()
+{
+	return false;
+}
+
+/**
+	@brief Clears this filter's cache hit/miss counters
+ */
+void Filter::ResetCacheStatistics()
+{
+	m_cacheHits = 0;
+	m_cacheMisses = 0;
+}
+
+/**
+	@brief Clears the cache hit/miss counters of every filter, as well as the global totals
+ */
+void Filter::ResetAllCacheStatistics()
+{
+	for(auto f : m_filters)
+		f->ResetCacheStatistics();
+	m_totalCacheHits = 0;
+	m_totalCacheMisses = 0;
+}
+
+/**
+	@brief Returns true if nothing our outputs depend on has changed since the last Refresh() call
+ */
+bool Filter::IsLastRefreshCurrent()
+{
+	if(!m_hasRefreshState || !IsResultCacheable())
+		return false;
+
+	//Inputs must be the same waveforms with the same contents
+	size_t ninputs = GetInputCount();
+	if(m_lastInputs.size() != ninputs)
+		return false;
+	for(size_t i=0; i<ninputs; i++)
+	{
+		if(!m_lastInputs[i].IsCurrent(GetInputWaveform(i)))
+			return false;
+	}
+
+	//Outputs must not have been replaced or touched by anyone else (ClearSweeps() etc)
+	size_t nstreams = GetStreamCount();
+	if(m_lastOutputs.size() != nstreams)
+		return false;
+	for(size_t i=0; i<nstreams; i++)
+	{
+		if(!m_lastOutputs[i].IsCurrent(GetData(i)))
+			return false;
+	}
+
+	return (GetConfigurationHash() == m_lastConfigurationHash);
+}
+
+/**
+	@brief Decides whether the upcoming Refresh() call can be incremental
+ */
+void Filter::BeginIncrementalRefresh()
+{
+	m_incrementalRefresh = false;
+	if(!SupportsIncrementalRefresh() || !m_hasRefreshState)
+		return;
+
+	//Need state from a previous refresh of the same inputs
+	size_t ninputs = GetInputCount();
+	if(m_lastInputs.size() != ninputs)
+		return;
+
+	//All outputs must still be there for us to append to
+	for(size_t i=0; i<GetStreamCount(); i++)
+	{
+		if(GetData(i) == NULL)
+			return;
+	}
+
+	//Every input must be the same waveform, still in the same append-only session, and no shorter than before
+	for(size_t i=0; i<ninputs; i++)
+	{
+		auto data = GetInputWaveform(i);
+		auto& state = m_lastInputs[i];
+		if( (data == NULL) || (data != state.m_waveform) )
+			return;
+		if( (data->m_appendSession == 0) || (data->m_appendSession != state.m_session) )
+			return;
+		if(data->size() < state.m_size)
+			return;
+	}
+
+	//Any configuration change means a full recompute
+	if(GetConfigurationHash() != m_lastConfigurationHash)
+		return;
+
+	m_incrementalRefresh = true;
+}
+
+/**
+	@brief Records the state of our inputs and outputs after a Refresh() call.
+
+	This is what lets the next refresh be skipped if nothing changes, or pick up where this one left off if the
+	inputs are only appended to.
+ */
+void Filter::SaveRefreshState()
+{
+	//Our outputs have new contents now
+	size_t nstreams = GetStreamCount();
+	for(size_t i=0; i<nstreams; i++)
+	{
+		auto data = GetData(i);
+		if(!data)
+			continue;
+		data->MarkModified();
+
+		//After a full refresh our outputs were rewritten from scratch, so downstream state is no longer valid.
+		//From here on we only append to them until the next full refresh.
+		if(SupportsIncrementalRefresh() && !m_incrementalRefresh)
+			data->StartAppendSession();
+	}
+
+	size_t ninputs = GetInputCount();
+	m_lastInputs.resize(ninputs);
+	for(size_t i=0; i<ninputs; i++)
+		m_lastInputs[i].Save(GetInputWaveform(i));
+
+	m_lastOutputs.resize(nstreams);
+	for(size_t i=0; i<nstreams; i++)
+		m_lastOutputs[i].Save(GetData(i));
+
+	m_lastConfigurationHash = GetConfigurationHash();
+	m_hasRefreshState = true;
+	m_incrementalRefresh = false;
+}
+
+/**
+	@brief Mixes a block of data into a 64-bit FNV-1a hash
+ */
+static void HashBytes(uint64_t& hash, const void* data, size_t len)
+{
+	auto p = reinterpret_cast<const uint8_t*>(data);
+	for(size_t i=0; i<len; i++)
+	{
+		hash ^= p[i];
+		hash *= 0x100000001b3;
+	}
+}
+
+/**
+	@brief Returns a hash of everything besides input data that our outputs depend on.
+
+	This covers the names and values of all of our parameters, plus the vertical range and offset of each input,
+	since some filters scale their output by them and they can change without the input data changing.
+ */
+uint64_t Filter::GetConfigurationHash()
+{
+	uint64_t hash = 0xcbf29ce484222325;
+
+	for(size_t i=0; i<m_inputs.size(); i++)
+	{
+		float range = m_inputs[i].GetVoltageRange();
+		float offset = m_inputs[i].GetOffset();
+		HashBytes(hash, &range, sizeof(range));
+		HashBytes(hash, &offset, sizeof(offset));
+	}
+
+	for(auto& it : m_parameters)
+	{
+		auto& p = it.second;
+		int64_t ival = p.GetIntVal();
+		float fval = p.GetFloatVal();
+		string sval = p.GetFileName();
+
+		HashBytes(hash, it.first.c_str(), it.first.length() + 1);
+		HashBytes(hash, &ival, sizeof(ival));
+		HashBytes(hash, &fval, sizeof(fval));
+		HashBytes(hash, sval.c_str(), sval.length() + 1);
+	}
+
+	return hash;
+}
+
+/**
+	@brief Calls Refresh() and records how long it took and how much data it processed
+ */
+void Filter::ProfiledRefresh()
+{
+	FilterRefreshProfile profile;
+
+	profile.m_inputSamples = 0;
+	for(size_t i=0; i<GetInputCount(); i++)
+	{
+		auto data = GetInputWaveform(i);
+		if(data)
+			profile.m_inputSamples += data->size();
+	}
+
+	profile.m_thread = FilterProfiler::GetThreadIndex();
+	size_t allocstart = WaveformPool::GetThreadAllocatedBytes();
+	double cpustart = FilterProfiler::GetThreadCPUTime();
+	profile.m_start = FilterProfiler::GetTimestamp();
+
+	Refresh();
+
+	profile.m_wallTime = FilterProfiler::GetTimestamp() - profile.m_start;
+	profile.m_cpuTime = FilterProfiler::GetThreadCPUTime() - cpustart;
+	profile.m_allocatedBytes = WaveformPool::GetThreadAllocatedBytes() - allocstart;
+
+	profile.m_outputSamples = 0;
+	profile.m_outputBytes = 0;
+	for(size_t i=0; i<GetStreamCount(); i++)
+	{
+		auto data = GetData(i);
+		if(data)
+		{
+			profile.m_outputSamples += data->size();
+			profile.m_outputBytes += data->GetAllocatedBytes();
+		}
+	}
+
+	{
+		lock_guard<mutex> lock(m_profileMutex);
+		if(m_profileHistory.size() >= FilterProfiler::HISTORY_DEPTH)
+			m_profileHistory.pop_front();
+		m_profileHistory.push_back(profile);
+	}
+
+	FilterProfiler::AddTraceEvent(this, profile);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Profiling
+
+/**
+	@brief Gets min/mean/max/99th percentile of a metric over this filter's recent refreshes
+ */
+FilterProfileStatistics Filter::GetProfileStatistics(FilterProfiler::Metric metric)
+{
+	vector<double> values;
+	{
+		lock_guard<mutex> lock(m_profileMutex);
+		for(auto& p : m_profileHistory)
+		{
+			switch(metric)
+			{
+				case FilterProfiler::METRIC_WALL_TIME:
+					values.push_back(p.m_wallTime);
+					break;
+
+				case FilterProfiler::METRIC_CPU_TIME:
+					values.push_back(p.m_cpuTime);
+					break;
+
+				case FilterProfiler::METRIC_INPUT_SAMPLES:
+					values.push_back(p.m_inputSamples);
+					break;
+
+				case FilterProfiler::METRIC_OUTPUT_SAMPLES:
+					values.push_back(p.m_outputSamples);
+					break;
+
+				case FilterProfiler::METRIC_OUTPUT_BYTES:
+					values.push_back(p.m_outputBytes);
+					break;
+
+				case FilterProfiler::METRIC_ALLOCATED_BYTES:
+					values.push_back(p.m_allocatedBytes);
+					break;
+			}
+		}
+	}
+
+	FilterProfileStatistics stats;
+	if(values.empty())
+		return stats;
+
+	sort(values.begin(), values.end());
+	double sum = 0;
+	for(auto v : values)
+		sum += v;
+
+	//Nearest-rank percentile
+	size_t n = values.size();
+	size_t rank = (n*99 + 99) / 100;
+
+	stats.m_count = n;
+	stats.m_min = values[0];
+	stats.m_max = values[n-1];
+	stats.m_mean = sum / n;
+	stats.m_p99 = values[rank - 1];
+	return stats;
+}
+
+/**
+	@brief Gets the measurements from this filter's most recent refreshes, oldest first
+ */
+vector<FilterRefreshProfile> Filter::GetProfileHistory()
+{
+	lock_guard<mutex> lock(m_profileMutex);
+	return vector<FilterRefreshProfile>(m_profileHistory.begin(), m_profileHistory.end());
+}
+
+/**
+	@brief Discards this filter's profiling history
+ */
+void Filter::ResetProfile()
+{
+	lock_guard<mutex> lock(m_profileMutex);
+	m_profileHistory.clear();
+}
+
+/**
+	@brief Discards the profiling history of every filter, and the trace log
+ */
+void Filter::ResetAllProfiles()
+{
+	for(auto f : m_filters)
+		f->ResetProfile();
+	FilterProfiler::ClearTrace();
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Enumeration
 
@@ -235,7 +670,7 @@ bool Filter::VerifyInputOK(size_t i, bool allowEmpty)
 
 	if(!allowEmpty)
 	{
-		if(data->m_offsets.size() == 0)
+		if(data->empty())
 			return false;
 	}
 
@@ -269,11 +704,11 @@ bool Filter::VerifyAllInputsOKAndAnalog()
 		auto data = p.m_channel->GetData(p.m_stream);
 		if(data == NULL)
 			return false;
-		if(data->m_offsets.size() == 0)
+		if(data->empty())
 			return false;
 
-		auto adata = dynamic_cast<AnalogWaveform*>(data);
-		if(adata == NULL)
+		//Raw ADC codes and uniform waveforms count as analog, but don't force a conversion just to check
+		if(!IsAnalogWaveform(data))
 			return false;
 	}
 
@@ -293,7 +728,7 @@ bool Filter::VerifyAllInputsOKAndDigital()
 		auto data = p.m_channel->GetData(p.m_stream);
 		if(data == NULL)
 			return false;
-		if(data->m_offsets.size() == 0)
+		if(data->empty())
 			return false;
 
 		auto ddata = dynamic_cast<DigitalWaveform*>(data);
@@ -306,146 +741,288 @@ bool Filter::VerifyAllInputsOKAndDigital()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Sampling helpers
 
-/**
-	@brief Samples a digital waveform on the rising edges of a clock
+static inline bool GetDigitalSample(DigitalWaveform* data, size_t i)
+{ return data->m_samples[i]; }
 
-	The sampling rate of the data and clock signals need not be equal or uniform.
+static inline bool GetDigitalSample(PackedDigitalWaveform* data, size_t i)
+{ return data->Get(i); }
 
-	The sampled waveform has a time scale in femtoseconds regardless of the incoming waveform's time scale.
+static inline uint64_t GetDigitalSample(DigitalBusWaveform* data, size_t i)
+{ return data->m_samples[i]; }
 
-	@param data		The data signal to sample
-	@param clock	The clock signal to use
-	@param samples	Output waveform
- */
-void Filter::SampleOnRisingEdges(DigitalWaveform* data, DigitalWaveform* clock, DigitalWaveform& samples)
-{
-	samples.clear();
+static inline const int64_t* GetRawOffsets(SparseWaveformBase* data)
+{ return reinterpret_cast<const int64_t*>(&data->m_offsets[0]); }
 
-	size_t ndata = 0;
-	size_t len = clock->m_offsets.size();
-	size_t dlen = data->m_samples.size();
-	for(size_t i=1; i<len; i++)
-	{
-		//Throw away clock samples until we find a rising edge
-		if(!(clock->m_samples[i] && !clock->m_samples[i-1]))
-			continue;
+static inline const int64_t* GetRawOffsets(PackedDigitalWaveform* /*data*/)
+{ return NULL; }
 
-		//Throw away data samples until the data is synced with us
-		int64_t clkstart = clock->m_offsets[i] * clock->m_timescale + clock->m_triggerPhase;
-		while( (ndata+1 < dlen) && ((data->m_offsets[ndata+1] * data->m_timescale + data->m_triggerPhase) < clkstart) )
-			ndata ++;
-		if(ndata >= dlen)
-			break;
+/**
+	@brief Finds the first sample in [i, len) with an offset greater than key, or len if there is none
 
-		//Extend the previous sample's duration (if any) to our start
-		size_t ssize = samples.m_samples.size();
-		if(ssize)
-		{
-			size_t last = ssize - 1;
-			samples.m_durations[last] = clkstart - samples.m_offsets[last];
-		}
+	Short hops are the common case, so the next few samples are scanned in order. Longer hops gallop ahead in
+	exponentially growing steps and then binary search, so skipping over many samples costs O(log n).
+ */
+static size_t FindFirstOffsetAfter(const int64_t* offs, size_t i, size_t len, int64_t key)
+{
+	size_t end = min(len, i + 32);
+	for(; i<end; i++)
+	{
+		if(offs[i] > key)
+			return i;
+	}
+	if(i == len)
+		return len;
+
+	//Gallop until we overshoot.
+	//Invariant: offs[lo] <= key, and offs[hi] > key (or hi is past the end).
+	size_t lo = i - 1;
+	size_t step = 32;
+	size_t hi = i;
+	while( (hi < len) && (offs[hi] <= key) )
+	{
+		lo = hi;
+		step *= 2;
+		hi = lo + step;
+	}
+	hi = min(hi, len);
 
-		//Add the new sample
-		samples.m_offsets.push_back(clkstart);
-		samples.m_durations.push_back(1);
-		samples.m_samples.push_back(data->m_samples[ndata]);
+	while(hi - lo > 1)
+	{
+		size_t mid = lo + (hi - lo)/2;
+		if(offs[mid] <= key)
+			lo = mid;
+		else
+			hi = mid;
 	}
+	return hi;
 }
 
 /**
-	@brief Samples a digital bus waveform on the rising edges of a clock
-
-	The sampling rate of the data and clock signals need not be equal or uniform.
+	@brief Finds the index of the data sample that is current at a given time
 
-	The sampled waveform has a time scale in femtoseconds regardless of the incoming waveform's time scale.
+	Equivalent to advancing i one sample at a time until the next sample starts at or after the timestamp, but without
+	converting every offset to femtoseconds: the timestamp is converted to timebase units once, and the offsets are
+	compared against it directly. Uniformly sampled data doesn't need to be searched at all.
 
-	@param data		The data signal to sample
-	@param clock	The clock signal to use
-	@param samples	Output waveform
+	@param data			The data signal
+	@param i			Index of a data sample starting before the timestamp (or zero)
+	@param len			Number of samples in the data signal
+	@param timestamp	Time to look for, in femtoseconds
  */
-void Filter::SampleOnRisingEdges(DigitalBusWaveform* data, DigitalWaveform* clock, DigitalBusWaveform& samples)
+template<class T>
+static size_t AdvanceToEdge(T* data, size_t i, size_t len, int64_t timestamp)
 {
-	samples.clear();
+	if(i+1 >= len)
+		return i;
 
-	size_t ndata = 0;
-	size_t len = clock->m_offsets.size();
-	size_t dlen = data->m_samples.size();
-	for(size_t i=1; i<len; i++)
+	//Degenerate timebase, fall back to the slow path
+	int64_t scale = data->m_timescale;
+	if(scale <= 0)
 	{
-		//Throw away clock samples until we find a rising edge
-		if(!(clock->m_samples[i] && !clock->m_samples[i-1]))
-			continue;
-
-		//Throw away data samples until the data is synced with us
-		int64_t clkstart = clock->m_offsets[i] * clock->m_timescale + clock->m_triggerPhase;
-		while( (ndata+1 < dlen) && ((data->m_offsets[ndata+1] * data->m_timescale + data->m_triggerPhase) < clkstart) )
-			ndata ++;
-		if(ndata >= dlen)
-			break;
+		while( (i+1 < len) && (data->GetOffsetScaled(i+1) < timestamp) )
+			i++;
+		return i;
+	}
 
-		//Extend the previous sample's duration (if any) to our start
-		size_t ssize = samples.m_samples.size();
-		if(ssize)
-		{
-			size_t last = ssize - 1;
-			samples.m_durations[last] = clkstart - samples.m_offsets[last];
-		}
+	//Offset of the last sample that could start before the timestamp (rounding towards negative infinity)
+	int64_t rel = timestamp - data->m_triggerPhase - 1;
+	int64_t key = rel / scale;
+	if( (rel < 0) && (rel % scale) )
+		key --;
 
-		//Add the new sample
-		samples.m_offsets.push_back(clkstart);
-		samples.m_durations.push_back(1);
-		samples.m_samples.push_back(data->m_samples[ndata]);
+	if(data->m_densePacked)
+	{
+		if(key <= (int64_t)i)
+			return i;
+		return min((size_t)key, len-1);
 	}
+
+	return FindFirstOffsetAfter(GetRawOffsets(data), i+1, len, key) - 1;
 }
 
 /**
-	@brief Samples a digital waveform on the falling edges of a clock
-
-	The sampling rate of the data and clock signals need not be equal or uniform.
+	@brief Samples a signal at each of a list of clock edges
 
-	The sampled waveform has a time scale in femtoseconds regardless of the incoming waveform's time scale.
+	The output is sized once up front and written in place. Long edge lists are split into chunks which are sampled in
+	parallel; each chunk finds its own starting point in the data, so the results are the same either way.
 
 	@param data		The data signal to sample
-	@param clock	The clock signal to use
+	@param edges	Timestamps of the clock edges, in femtoseconds, in ascending order
 	@param samples	Output waveform
  */
-void Filter::SampleOnFallingEdges(DigitalWaveform* data, DigitalWaveform* clock, DigitalWaveform& samples)
+template<class T, class W>
+static void SampleOnEdgeList(T* data, const vector<int64_t>& edges, W& samples)
 {
-	samples.clear();
-
-	size_t ndata = 0;
-	size_t len = clock->m_offsets.size();
-	size_t dlen = data->m_samples.size();
-	for(size_t i=1; i<len; i++)
+	size_t dlen = data->size();
+	size_t nedges = edges.size();
+	if( (dlen == 0) || (nedges == 0) )
 	{
-		//Throw away clock samples until we find a falling edge
-		if(!(!clock->m_samples[i] && clock->m_samples[i-1]))
-			continue;
+		samples.clear();
+		return;
+	}
+	samples.Resize(nedges);
 
-		//Throw away data samples until the data is synced with us
-		int64_t clkstart = clock->m_offsets[i] * clock->m_timescale + clock->m_triggerPhase;
-		while( (ndata+1 < dlen) && ((data->m_offsets[ndata+1] * data->m_timescale + data->m_triggerPhase) < clkstart) )
-			ndata ++;
-		if(ndata >= dlen)
-			break;
+	const size_t chunksize = 64 * 1024;
+	size_t nchunks = (nedges + chunksize - 1) / chunksize;
 
-		//Extend the previous sample's duration (if any) to our start
-		size_t ssize = samples.m_samples.size();
-		if(ssize)
+	#pragma omp parallel for schedule(dynamic) if(nchunks > 1)
+	for(size_t ichunk=0; ichunk<nchunks; ichunk++)
+	{
+		size_t start = ichunk * chunksize;
+		size_t end = min(start + chunksize, nedges);
+
+		size_t ndata = 0;
+		for(size_t i=start; i<end; i++)
 		{
-			size_t last = ssize - 1;
-			samples.m_durations[last] = clkstart - samples.m_offsets[last];
+			ndata = AdvanceToEdge(data, ndata, dlen, edges[i]);
+			samples.m_offsets[i] = edges[i];
+			samples.m_samples[i] = GetDigitalSample(data, ndata);
 		}
-
-		//Add the new sample
-		samples.m_offsets.push_back(clkstart);
-		samples.m_durations.push_back(1);
-		samples.m_samples.push_back(data->m_samples[ndata]);
 	}
+
+	//Each sample lasts until the next edge
+	for(size_t i=0; i+1<nedges; i++)
+		samples.m_durations[i] = edges[i+1] - edges[i];
+	samples.m_durations[nedges-1] = 1;
 }
 
 /**
-	@brief Samples a digital waveform on all edges of a clock
+	@brief Finds the timestamps of edges of a clock, for use with SampleOnEdges()
+
+	Unlike FindZeroCrossings() and friends, edges are reported at the start of the first sample after the transition,
+	and the transition between the first two samples counts.
+
+	@param clock	The clock signal
+	@param rising	Find rising edges
+	@param falling	Find falling edges
+	@param edges	Timestamps of the edges, in femtoseconds
+ */
+static void FindSamplingEdges(DigitalWaveform* clock, bool rising, bool falling, vector<int64_t>& edges)
+{
+	size_t len = clock->m_samples.size();
+	for(size_t i=1; i<len; i++)
+	{
+		bool cur = clock->m_samples[i];
+		if( (cur != clock->m_samples[i-1]) && (cur ? rising : falling) )
+			edges.push_back(clock->GetOffsetScaled(i));
+	}
+}
+
+/**
+	@brief Gets a mask of the edges in one word of a bit-packed waveform
+
+	Bit j of the result is set if sample (iword*64 + j) is an edge of the requested polarity, i.e. differs from
+	the sample before it. Edges before sample index "first" and past the end of the waveform are masked off.
+
+	@param data		The waveform to search
+	@param iword	Index of the word to process
+	@param first	Index of the first sample which may be reported as an edge
+	@param rising	Report rising edges
+	@param falling	Report falling edges
+ */
+static inline uint64_t GetPackedEdgeMask(PackedDigitalWaveform* data, size_t iword, size_t first, bool rising, bool falling)
+{
+	uint64_t cur = data->m_words[iword];
+	uint64_t carry = 0;
+	if(iword > 0)
+		carry = data->m_words[iword-1] >> 63;
+
+	//Compare every sample to its predecessor at once
+	uint64_t edges = cur ^ ((cur << 1) | carry);
+	uint64_t polarity = 0;
+	if(rising)
+		polarity |= cur;
+	if(falling)
+		polarity |= ~cur;
+	edges &= polarity;
+
+	//Discard edges before the start
+	size_t base = iword * 64;
+	if(first > base)
+	{
+		size_t skip = first - base;
+		if(skip >= 64)
+			return 0;
+		edges &= ~((1ULL << skip) - 1);
+	}
+
+	//The last valid sample shifts into the padding, so mask that off too
+	size_t end = data->size() - base;
+	if(end < 64)
+		edges &= (1ULL << end) - 1;
+
+	return edges;
+}
+
+/**
+	@brief Counts the edges of a bit-packed waveform without extracting them
+ */
+static size_t CountPackedEdges(PackedDigitalWaveform* data, size_t first, bool rising, bool falling)
+{
+	size_t count = 0;
+	size_t nwords = data->m_words.size();
+	for(size_t i=0; i<nwords; i++)
+		count += __builtin_popcountll(GetPackedEdgeMask(data, i, first, rising, falling));
+	return count;
+}
+
+/**
+	@brief Finds the timestamps of edges of a bit-packed clock a word at a time, for use with SampleOnEdges()
+
+	Long runs without an edge cost one compare per 64 samples.
+ */
+static void FindSamplingEdges(PackedDigitalWaveform* clock, bool rising, bool falling, vector<int64_t>& edges)
+{
+	edges.reserve(edges.size() + CountPackedEdges(clock, 1, rising, falling));
+
+	size_t nwords = clock->m_words.size();
+	for(size_t w=0; w<nwords; w++)
+	{
+		uint64_t mask = GetPackedEdgeMask(clock, w, 1, rising, falling);
+		while(mask)
+		{
+			size_t i = w*64 + __builtin_ctzll(mask);
+			mask &= mask - 1;
+			edges.push_back(i * clock->m_timescale + clock->m_triggerPhase);
+		}
+	}
+}
+
+/**
+	@brief Samples a digital waveform at a precomputed list of clock edges
+
+	Decoders which sample several signals on the same clock can find the edges once and reuse them.
+
+	The sampled waveform has a time scale in femtoseconds regardless of the incoming waveform's time scale.
+
+	@param data		The data signal to sample
+	@param edges	Timestamps of the clock edges, in femtoseconds, in ascending order
+	@param samples	Output waveform
+ */
+void Filter::SampleOnEdges(DigitalWaveform* data, const vector<int64_t>& edges, DigitalWaveform& samples)
+{
+	SampleOnEdgeList(data, edges, samples);
+}
+
+/**
+	@brief Samples a bit-packed digital waveform at a precomputed list of clock edges
+ */
+void Filter::SampleOnEdges(PackedDigitalWaveform* data, const vector<int64_t>& edges, DigitalWaveform& samples)
+{
+	SampleOnEdgeList(data, edges, samples);
+}
+
+/**
+	@brief Samples a digital bus waveform at a precomputed list of clock edges
+ */
+void Filter::SampleOnEdges(DigitalBusWaveform* data, const vector<int64_t>& edges, DigitalBusWaveform& samples)
+{
+	samples.m_width = data->m_width;
+	SampleOnEdgeList(data, edges, samples);
+}
+
+/**
+	@brief Samples a digital waveform on the rising edges of a clock
 
 	The sampling rate of the data and clock signals need not be equal or uniform.
 
@@ -455,39 +1032,65 @@ void Filter::SampleOnFallingEdges(DigitalWaveform* data, DigitalWaveform* clock,
 	@param clock	The clock signal to use
 	@param samples	Output waveform
  */
-void Filter::SampleOnAnyEdges(DigitalWaveform* data, DigitalWaveform* clock, DigitalWaveform& samples)
+void Filter::SampleOnRisingEdges(DigitalWaveform* data, DigitalWaveform* clock, DigitalWaveform& samples)
 {
-	samples.clear();
+	vector<int64_t> edges;
+	FindSamplingEdges(clock, true, false, edges);
+	SampleOnEdges(data, edges, samples);
+}
 
-	size_t ndata = 0;
-	size_t len = clock->m_offsets.size();
-	size_t dlen = data->m_samples.size();
-	for(size_t i=1; i<len; i++)
-	{
-		//Throw away clock samples until we find an edge
-		if(clock->m_samples[i] == clock->m_samples[i-1])
-			continue;
+/**
+	@brief Samples a digital bus waveform on the rising edges of a clock
 
-		//Throw away data samples until the data is synced with us
-		int64_t clkstart = clock->m_offsets[i] * clock->m_timescale + clock->m_triggerPhase;
-		while( (ndata+1 < dlen) && ((data->m_offsets[ndata+1] * data->m_timescale + data->m_triggerPhase) < clkstart) )
-			ndata ++;
-		if(ndata >= dlen)
-			break;
+	The sampling rate of the data and clock signals need not be equal or uniform.
 
-		//Extend the previous sample's duration (if any) to our start
-		size_t ssize = samples.m_samples.size();
-		if(ssize)
-		{
-			size_t last = ssize - 1;
-			samples.m_durations[last] = clkstart - samples.m_offsets[last];
-		}
+	The sampled waveform has a time scale in femtoseconds regardless of the incoming waveform's time scale.
 
-		//Add the new sample
-		samples.m_offsets.push_back(clkstart);
-		samples.m_durations.push_back(1);
-		samples.m_samples.push_back(data->m_samples[ndata]);
-	}
+	@param data		The data signal to sample
+	@param clock	The clock signal to use
+	@param samples	Output waveform
+ */
+void Filter::SampleOnRisingEdges(DigitalBusWaveform* data, DigitalWaveform* clock, DigitalBusWaveform& samples)
+{
+	vector<int64_t> edges;
+	FindSamplingEdges(clock, true, false, edges);
+	SampleOnEdges(data, edges, samples);
+}
+
+/**
+	@brief Samples a digital waveform on the falling edges of a clock
+
+	The sampling rate of the data and clock signals need not be equal or uniform.
+
+	The sampled waveform has a time scale in femtoseconds regardless of the incoming waveform's time scale.
+
+	@param data		The data signal to sample
+	@param clock	The clock signal to use
+	@param samples	Output waveform
+ */
+void Filter::SampleOnFallingEdges(DigitalWaveform* data, DigitalWaveform* clock, DigitalWaveform& samples)
+{
+	vector<int64_t> edges;
+	FindSamplingEdges(clock, false, true, edges);
+	SampleOnEdges(data, edges, samples);
+}
+
+/**
+	@brief Samples a digital waveform on all edges of a clock
+
+	The sampling rate of the data and clock signals need not be equal or uniform.
+
+	The sampled waveform has a time scale in femtoseconds regardless of the incoming waveform's time scale.
+
+	@param data		The data signal to sample
+	@param clock	The clock signal to use
+	@param samples	Output waveform
+ */
+void Filter::SampleOnAnyEdges(DigitalWaveform* data, DigitalWaveform* clock, DigitalWaveform& samples)
+{
+	vector<int64_t> edges;
+	FindSamplingEdges(clock, true, true, edges);
+	SampleOnEdges(data, edges, samples);
 }
 
 /**
@@ -503,224 +1106,330 @@ void Filter::SampleOnAnyEdges(DigitalWaveform* data, DigitalWaveform* clock, Dig
  */
 void Filter::SampleOnAnyEdges(DigitalBusWaveform* data, DigitalWaveform* clock, DigitalBusWaveform& samples)
 {
-	samples.clear();
+	vector<int64_t> edges;
+	FindSamplingEdges(clock, true, true, edges);
+	SampleOnEdges(data, edges, samples);
+}
 
-	size_t ndata = 0;
-	size_t len = clock->m_offsets.size();
-	size_t dlen = data->m_samples.size();
-	for(size_t i=1; i<len; i++)
-	{
-		//Throw away clock samples until we find an edge
-		if(clock->m_samples[i] == clock->m_samples[i-1])
-			continue;
+/**
+	@brief Samples a digital waveform on all edges of a bit-packed clock
+ */
+void Filter::SampleOnAnyEdges(DigitalWaveform* data, PackedDigitalWaveform* clock, DigitalWaveform& samples)
+{
+	vector<int64_t> edges;
+	FindSamplingEdges(clock, true, true, edges);
+	SampleOnEdges(data, edges, samples);
+}
 
-		//Throw away data samples until the data is synced with us
-		int64_t clkstart = clock->m_offsets[i] * clock->m_timescale + clock->m_triggerPhase;
-		while( (ndata+1 < dlen) && ((data->m_offsets[ndata+1] * data->m_timescale + data->m_triggerPhase) < clkstart) )
-			ndata ++;
-		if(ndata >= dlen)
-			break;
+/**
+	@brief Samples a bit-packed digital waveform on all edges of a bit-packed clock
+ */
+void Filter::SampleOnAnyEdges(PackedDigitalWaveform* data, PackedDigitalWaveform* clock, DigitalWaveform& samples)
+{
+	vector<int64_t> edges;
+	FindSamplingEdges(clock, true, true, edges);
+	SampleOnEdges(data, edges, samples);
+}
 
-		//Extend the previous sample's duration (if any) to our start
-		size_t ssize = samples.m_samples.size();
-		if(ssize)
-		{
-			size_t last = ssize - 1;
-			samples.m_durations[last] = clkstart - samples.m_offsets[last];
-		}
+/**
+	@brief Samples a digital waveform on the rising edges of a bit-packed clock
+ */
+void Filter::SampleOnRisingEdges(DigitalWaveform* data, PackedDigitalWaveform* clock, DigitalWaveform& samples)
+{
+	vector<int64_t> edges;
+	FindSamplingEdges(clock, true, false, edges);
+	SampleOnEdges(data, edges, samples);
+}
 
-		//Add the new sample
-		samples.m_offsets.push_back(clkstart);
-		samples.m_durations.push_back(1);
-		samples.m_samples.push_back(data->m_samples[ndata]);
-	}
+/**
+	@brief Samples a bit-packed digital waveform on the rising edges of a bit-packed clock
+ */
+void Filter::SampleOnRisingEdges(PackedDigitalWaveform* data, PackedDigitalWaveform* clock, DigitalWaveform& samples)
+{
+	vector<int64_t> edges;
+	FindSamplingEdges(clock, true, false, edges);
+	SampleOnEdges(data, edges, samples);
 }
 
 /**
-	@brief Find rising edges in a waveform, interpolating as necessary
+	@brief Samples a digital waveform on the falling edges of a bit-packed clock
  */
-void Filter::FindRisingEdges(AnalogWaveform* data, float threshold, vector<int64_t>& edges)
+void Filter::SampleOnFallingEdges(DigitalWaveform* data, PackedDigitalWaveform* clock, DigitalWaveform& samples)
 {
-	//Find times of the zero crossings
-	bool first = true;
-	bool last = false;
-	int64_t phoff = data->m_triggerPhase;
-	size_t len = data->m_samples.size();
-	float fscale = data->m_timescale;
+	vector<int64_t> edges;
+	FindSamplingEdges(clock, false, true, edges);
+	SampleOnEdges(data, edges, samples);
+}
 
-	if(data->m_densePacked)
-	{
-		for(size_t i=1; i<len; i++)
-		{
-			bool value = data->m_samples[i] > threshold;
+/**
+	@brief Samples a bit-packed digital waveform on the falling edges of a bit-packed clock
+ */
+void Filter::SampleOnFallingEdges(PackedDigitalWaveform* data, PackedDigitalWaveform* clock, DigitalWaveform& samples)
+{
+	vector<int64_t> edges;
+	FindSamplingEdges(clock, false, true, edges);
+	SampleOnEdges(data, edges, samples);
+}
 
-			//Save the last value
-			if(first)
-			{
-				last = value;
-				first = false;
-				continue;
-			}
-			if(!value)
-				last = false;
+/**
+	@brief Finds threshold crossings in samples [start, end) of a waveform, one sample at a time
 
-			//Skip samples with no rising edge
-			if(!value || last)
-				continue;
+	There is a crossing at sample i if samples i-1 and i are on opposite sides of the threshold. It is rising if sample i
+	is above the threshold and falling otherwise. The index of the sample before each crossing (i-1) is appended to
+	hits.
 
-			//Midpoint of the sample, plus the zero crossing
-			int64_t tfrac = fscale * InterpolateTime(data, i-1, threshold);
-			int64_t t = phoff + data->m_timescale*(i-1) + tfrac;
-			edges.push_back(t);
-			last = true;
-		}
-	}
-	else
+	Since each crossing only depends on a pair of adjacent samples, any range can be scanned independently as long as
+	start >= 1.
+ */
+static void FindCrossingIndices(
+	const float* samples, size_t start, size_t end, float threshold, bool rising, bool falling, vector<size_t>& hits)
+{
+	bool last = samples[start-1] > threshold;
+	for(size_t i=start; i<end; i++)
 	{
-		for(size_t i=1; i<len; i++)
-		{
-			bool value = data->m_samples[i] > threshold;
+		bool value = samples[i] > threshold;
+		if( (value != last) && (value ? rising : falling) )
+			hits.push_back(i-1);
+		last = value;
+	}
+}
 
-			//Save the last value
-			if(first)
-			{
-				last = value;
-				first = false;
-				continue;
-			}
+/**
+	@brief Converts a bitmask of sample-above-threshold flags to a bitmask of crossings
 
-			if(!value)
-				last = false;
+	@param above		Bit k is set if sample k of the block is above the threshold
+	@param carry		True if the sample just before the block was above the threshold
+	@param nbits		Number of samples in the block
+	@param rising		Report rising crossings
+	@param falling		Report falling crossings
+ */
+static inline uint64_t GetCrossingMask(uint64_t above, bool carry, size_t nbits, bool rising, bool falling)
+{
+	uint64_t prev = (above << 1) | (carry ? 1 : 0);
+	if(nbits < 64)
+		prev &= (1ULL << nbits) - 1;
+	uint64_t crossings = above ^ prev;
+	if(!rising)
+		crossings &= ~above;
+	if(!falling)
+		crossings &= above;
+	return crossings;
+}
 
-			//Skip samples with no rising edge
-			if(!value || last)
-				continue;
+/**
+	@brief Appends the index of the sample before each crossing in a block, given a mask from GetCrossingMask()
+ */
+static inline void AppendCrossingIndices(uint64_t crossings, size_t base, vector<size_t>& hits)
+{
+	//Jump straight from one crossing to the next, no need to look at the samples in between
+	while(crossings)
+	{
+		hits.push_back(base + __builtin_ctzll(crossings) - 1);
+		crossings &= crossings - 1;
+	}
+}
 
-			//Midpoint of the sample, plus the zero crossing
-			int64_t tfrac = fscale * InterpolateTime(data, i-1, threshold);
-			int64_t t = phoff + data->m_timescale * data->m_offsets[i-1] + tfrac;
-			edges.push_back(t);
-			last = true;
-		}
+/**
+	@brief AVX2 version of FindCrossingIndices(), testing 32 samples per iteration
+ */
+__attribute__((target("avx2")))
+static void FindCrossingIndicesAVX2(
+	const float* samples, size_t start, size_t end, float threshold, bool rising, bool falling, vector<size_t>& hits)
+{
+	__m256 vthresh = _mm256_set1_ps(threshold);
+	bool carry = samples[start-1] > threshold;
+
+	size_t i = start;
+	for(; i+32 <= end; i += 32)
+	{
+		uint64_t a = (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(samples + i), vthresh, _CMP_GT_OQ));
+		uint64_t b = (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(samples + i + 8), vthresh, _CMP_GT_OQ));
+		uint64_t c = (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(samples + i + 16), vthresh, _CMP_GT_OQ));
+		uint64_t d = (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(samples + i + 24), vthresh, _CMP_GT_OQ));
+		uint64_t above = a | (b << 8) | (c << 16) | (d << 24);
+
+		AppendCrossingIndices(GetCrossingMask(above, carry, 32, rising, falling), i, hits);
+		carry = (above >> 31) & 1;
 	}
+
+	//Get any extras
+	if(i < end)
+		FindCrossingIndices(samples, i, end, threshold, rising, falling, hits);
 }
 
 /**
-	@brief Find zero crossings in a waveform, interpolating as necessary
+	@brief AVX-512 version of FindCrossingIndices(), testing 64 samples per iteration
  */
-void Filter::FindZeroCrossings(AnalogWaveform* data, float threshold, vector<int64_t>& edges)
+__attribute__((target("avx512f")))
+static void FindCrossingIndicesAVX512F(
+	const float* samples, size_t start, size_t end, float threshold, bool rising, bool falling, vector<size_t>& hits)
 {
-	pair<WaveformBase*, float> cachekey(data, threshold);
+	__m512 vthresh = _mm512_set1_ps(threshold);
+	bool carry = samples[start-1] > threshold;
 
-	//Check cache
+	size_t i = start;
+	for(; i+64 <= end; i += 64)
 	{
-		lock_guard<mutex> lock(m_cacheMutex);
-		auto it = m_zeroCrossingCache.find(cachekey);
-		if(it != m_zeroCrossingCache.end())
-		{
-			edges = it->second;
-			return;
-		}
+		uint64_t a = _mm512_cmp_ps_mask(_mm512_loadu_ps(samples + i), vthresh, _CMP_GT_OQ);
+		uint64_t b = _mm512_cmp_ps_mask(_mm512_loadu_ps(samples + i + 16), vthresh, _CMP_GT_OQ);
+		uint64_t c = _mm512_cmp_ps_mask(_mm512_loadu_ps(samples + i + 32), vthresh, _CMP_GT_OQ);
+		uint64_t d = _mm512_cmp_ps_mask(_mm512_loadu_ps(samples + i + 48), vthresh, _CMP_GT_OQ);
+		uint64_t above = a | (b << 16) | (c << 32) | (d << 48);
+
+		AppendCrossingIndices(GetCrossingMask(above, carry, 64, rising, falling), i, hits);
+		carry = (above >> 63) & 1;
 	}
 
-	//Find times of the zero crossings
-	bool first = true;
-	bool last = false;
+	//Get any extras
+	if(i < end)
+		FindCrossingIndices(samples, i, end, threshold, rising, falling, hits);
+}
+
+/**
+	@brief Converts the crossing indices found by FindCrossingIndices() to interpolated timestamps
+ */
+template<class T>
+static void InterpolateCrossings(T* data, float threshold, const vector<size_t>& hits, vector<int64_t>& edges)
+{
+	const float* samples = reinterpret_cast<const float*>(&data->m_samples[0]);
 	int64_t phoff = data->m_triggerPhase;
-	size_t len = data->m_samples.size();
+	int64_t timescale = data->m_timescale;
 	float fscale = data->m_timescale;
 
+	size_t nhits = hits.size();
+	edges.resize(nhits);
+
+	//Linear interpolation between the two samples either side of the crossing.
+	//Sample spacing is normalized to 1 timebase unit, same as InterpolateTime().
 	if(data->m_densePacked)
 	{
-		for(size_t i=1; i<len; i++)
+		for(size_t k=0; k<nhits; k++)
 		{
-			bool value = data->m_samples[i] > threshold;
-
-			//Save the last value
-			if(first)
-			{
-				last = value;
-				first = false;
-				continue;
-			}
-
-			//Skip samples with no transition
-			if(last == value)
-				continue;
-
-			//Midpoint of the sample, plus the zero crossing
-			int64_t tfrac = fscale * InterpolateTime(data, i-1, threshold);
-			int64_t t = phoff + data->m_timescale*(i-1) + tfrac;
-			edges.push_back(t);
-			last = value;
+			size_t i = hits[k];
+			float fa = samples[i];
+			float fb = samples[i+1];
+			int64_t tfrac = fscale * ((threshold - fa) / (fb - fa));
+			edges[k] = phoff + timescale*i + tfrac;
 		}
 	}
 	else
 	{
-		for(size_t i=1; i<len; i++)
+		for(size_t k=0; k<nhits; k++)
 		{
-			bool value = data->m_samples[i] > threshold;
+			size_t i = hits[k];
+			float fa = samples[i];
+			float fb = samples[i+1];
+			int64_t tfrac = fscale * ((threshold - fa) / (fb - fa));
+			edges[k] = phoff + timescale*data->GetOffset(i) + tfrac;
+		}
+	}
+}
 
-			//Save the last value
-			if(first)
-			{
-				last = value;
-				first = false;
-				continue;
-			}
+/**
+	@brief Finds threshold crossings in an analog waveform, interpolating as necessary, and appends them to edges
 
-			//Skip samples with no transition
-			if(last == value)
-				continue;
+	Shared implementation for sparse and uniform analog waveforms, and for rising, falling, and all edges.
 
-			//Midpoint of the sample, plus the zero crossing
-			int64_t tfrac = fscale * InterpolateTime(data, i-1, threshold);
-			int64_t t = phoff + data->m_timescale * data->m_offsets[i-1] + tfrac;
-			edges.push_back(t);
-			last = value;
-		}
+	For compatibility with the original scalar implementation, the first sample only establishes the starting state:
+	the earliest crossing that can be reported is between samples 1 and 2.
+
+	Long waveforms are split into chunks which are scanned in parallel. Each chunk looks back one sample before its
+	start, so crossings on chunk boundaries are found exactly once.
+ */
+template<class T>
+static void FindThresholdCrossings(T* data, float threshold, bool rising, bool falling, vector<int64_t>& edges)
+{
+	size_t len = data->m_samples.size();
+	if(len < 3)
+		return;
+	const float* samples = reinterpret_cast<const float*>(&data->m_samples[0]);
+
+	const size_t chunksize = 1024 * 1024;
+	size_t start = 2;
+	size_t nchunks = (len - start + chunksize - 1) / chunksize;
+	vector< vector<int64_t> > chunkEdges(nchunks);
+
+	#pragma omp parallel for schedule(dynamic) if(nchunks > 1)
+	for(size_t ichunk=0; ichunk<nchunks; ichunk++)
+	{
+		size_t cstart = start + ichunk*chunksize;
+		size_t cend = min(cstart + chunksize, len);
+
+		vector<size_t> hits;
+		if(g_hasAvx512F)
+			FindCrossingIndicesAVX512F(samples, cstart, cend, threshold, rising, falling, hits);
+		else if(g_hasAvx2)
+			FindCrossingIndicesAVX2(samples, cstart, cend, threshold, rising, falling, hits);
+		else
+			FindCrossingIndices(samples, cstart, cend, threshold, rising, falling, hits);
+
+		InterpolateCrossings(data, threshold, hits, chunkEdges[ichunk]);
 	}
 
-	//Add to cache
-	lock_guard<mutex> lock(m_cacheMutex);
-	m_zeroCrossingCache[cachekey] = edges;
+	//Merge the chunks back together, in order
+	size_t total = edges.size();
+	for(auto& v : chunkEdges)
+		total += v.size();
+	edges.reserve(total);
+	for(auto& v : chunkEdges)
+		edges.insert(edges.end(), v.begin(), v.end());
 }
 
 /**
-	@brief Find edges in a waveform, discarding repeated samples
+	@brief Find threshold crossings in a waveform of raw ADC codes, interpolating as necessary
+
+	The threshold is converted to a code once and all comparisons and interpolation are done on the codes, so the
+	waveform is never converted to volts. Since the mapping from codes to volts is linear, the interpolated crossing
+	times are the same as they would be in volts.
  */
-void Filter::FindZeroCrossings(DigitalWaveform* data, vector<int64_t>& edges)
+template<class T>
+static void FindCrossingsADC(ADCCodeWaveform<T>* data, float threshold, bool rising, bool falling, vector<int64_t>& edges)
 {
-	//Find times of the zero crossings
-	bool first = true;
-	bool last = data->m_samples[0];
-	int64_t phoff = data->m_timescale/2 + data->m_triggerPhase;
+	//If the gain is negative, higher codes are lower voltages so flip the comparison
+	float code = data->VoltageToCode(threshold);
+	float sign = (data->m_gain < 0) ? -1 : 1;
+	float scode = sign * code;
+
+	int64_t phoff = data->m_triggerPhase;
 	size_t len = data->m_samples.size();
-	for(size_t i=1; i<len; i++)
-	{
-		bool value = data->m_samples[i];
+	float fscale = data->m_timescale;
+	if(len < 2)
+		return;
 
-		//Save the last value
-		if(first)
-		{
-			last = value;
-			first = false;
-			continue;
-		}
+	//Like the float version, the first sample only establishes the starting state
+	bool last = (sign * data->m_samples[1]) > scode;
+	for(size_t i=2; i<len; i++)
+	{
+		bool value = (sign * data->m_samples[i]) > scode;
 
 		//Skip samples with no transition
 		if(last == value)
 			continue;
-
-		edges.push_back(phoff + data->m_timescale * data->m_offsets[i]);
 		last = value;
+
+		//Skip transitions in the direction we don't care about
+		if(value ? !rising : !falling)
+			continue;
+
+		//Midpoint of the sample, plus the zero crossing
+		float fa = data->m_samples[i-1];
+		float fb = data->m_samples[i];
+		int64_t tfrac = fscale * ( (code - fa) / (fb - fa) );
+		int64_t t = phoff + data->m_timescale*(i-1) + tfrac;
+		edges.push_back(t);
 	}
 }
 
 /**
-	@brief Find rising edges in a waveform
+	@brief Find edges in a digital waveform, discarding repeated samples
+
+	@param data		The waveform to search
+	@param rising	Save rising edges
+	@param falling	Save falling edges
+	@param edges	Timestamps of the edges
  */
-void Filter::FindRisingEdges(DigitalWaveform* data, vector<int64_t>& edges)
+template<class T>
+static void FindDigitalEdgesInner(T* data, bool rising, bool falling, vector<int64_t>& edges)
 {
 	//Find times of the zero crossings
 	bool first = true;
@@ -740,11 +1449,207 @@ void Filter::FindRisingEdges(DigitalWaveform* data, vector<int64_t>& edges)
 		}
 
 		//Save samples with an edge
-		if(value && !last)
-			edges.push_back(phoff + data->m_timescale * data->m_offsets[i]);
+		if( (rising && value && !last) || (falling && !value && last) )
+			edges.push_back(phoff + data->m_timescale * data->GetOffset(i));
+
+		last = value;
+	}
+}
+
+/**
+	@brief Find edges in a bit-packed waveform a word at a time
+
+	Like the unpacked implementation, the transition between the first two samples is not reported.
+ */
+static void FindPackedEdges(PackedDigitalWaveform* data, bool rising, bool falling, vector<int64_t>& edges)
+{
+	edges.reserve(edges.size() + CountPackedEdges(data, 2, rising, falling));
+
+	int64_t phoff = data->m_timescale/2 + data->m_triggerPhase;
+	size_t nwords = data->m_words.size();
+	for(size_t w=0; w<nwords; w++)
+	{
+		uint64_t mask = GetPackedEdgeMask(data, w, 2, rising, falling);
+		while(mask)
+		{
+			int64_t i = w*64 + __builtin_ctzll(mask);
+			mask &= mask - 1;
+			edges.push_back(phoff + data->m_timescale * i);
+		}
+	}
+}
+
+/**
+	@brief Finds edges in any supported type of waveform, without going through the cache
+
+	@return False if edge finding is not supported for this type of waveform
+ */
+static bool FindEdgesUncached(WaveformBase* data, float threshold, EdgeCache::EdgeType type, vector<int64_t>& edges)
+{
+	bool rising = (type != EdgeCache::EDGE_FALLING);
+	bool falling = (type != EdgeCache::EDGE_RISING);
+
+	//Analog
+	auto sanalog = dynamic_cast<AnalogWaveform*>(data);
+	auto uanalog = dynamic_cast<UniformAnalogWaveform*>(data);
+	auto adc8 = dynamic_cast<ADC8Waveform*>(data);
+	auto adc16 = dynamic_cast<ADC16Waveform*>(data);
+	if(sanalog)
+		FindThresholdCrossings(sanalog, threshold, rising, falling, edges);
+	else if(uanalog)
+		FindThresholdCrossings(uanalog, threshold, rising, falling, edges);
+	else if(adc8)
+		FindCrossingsADC(adc8, threshold, rising, falling, edges);
+	else if(adc16)
+		FindCrossingsADC(adc16, threshold, rising, falling, edges);
+
+	//Digital
+	else
+	{
+		auto sdigital = dynamic_cast<DigitalWaveform*>(data);
+		auto udigital = dynamic_cast<UniformDigitalWaveform*>(data);
+		auto packed = dynamic_cast<PackedDigitalWaveform*>(data);
+		if(sdigital)
+			FindDigitalEdgesInner(sdigital, rising, falling, edges);
+		else if(udigital)
+			FindDigitalEdgesInner(udigital, rising, falling, edges);
+		else if(packed)
+			FindPackedEdges(packed, rising, falling, edges);
+		else
+			return false;
+	}
+
+	return true;
+}
+
+/**
+	@brief Gets the edges in a waveform, from the EdgeCache if possible
+
+	The returned list is shared with every other caller asking for the same edges in the same revision of the waveform,
+	so this is much cheaper than the FindZeroCrossings() / FindRisingEdges() / FindFallingEdges() family (which copy
+	the list into the caller's vector) when the edges are only being read.
+
+	Analog and ADC code waveforms are interpolated to find the time each threshold crossing happened. For digital
+	waveforms, the threshold is ignored and the edges are at the midpoint of the first sample after each transition.
+
+	@param data			The waveform to search
+	@param threshold	Threshold voltage (analog only)
+	@param type			Type of edges to find
+
+	@return The edges, or NULL if data is NULL or not a type of waveform edges can be found in
+ */
+EdgeCache::EdgeList Filter::GetEdges(WaveformBase* data, float threshold, EdgeCache::EdgeType type)
+{
+	if(data == NULL)
+		return NULL;
+
+	//Threshold doesn't matter for digital waveforms, don't make separate entries for each one people ask for
+	if( (dynamic_cast<DigitalWaveform*>(data) != NULL) ||
+		(dynamic_cast<UniformDigitalWaveform*>(data) != NULL) ||
+		(dynamic_cast<PackedDigitalWaveform*>(data) != NULL) )
+	{
+		threshold = 0;
+	}
+
+	auto cached = EdgeCache::Find(data, threshold, type);
+	if(cached)
+		return cached;
+
+	auto edges = make_shared< vector<int64_t> >();
+	if(!FindEdgesUncached(data, threshold, type, *edges))
+		return NULL;
+
+	EdgeCache::Insert(data, threshold, type, edges);
+	return edges;
+}
+
+/**
+	@brief Appends a cached edge list to a caller's vector
+ */
+static void AppendEdges(const EdgeCache::EdgeList& list, vector<int64_t>& edges)
+{
+	if(list)
+		edges.insert(edges.end(), list->begin(), list->end());
+}
+
+/**
+	@brief Find rising edges in a waveform, interpolating as necessary
+ */
+void Filter::FindRisingEdges(AnalogWaveform* data, float threshold, vector<int64_t>& edges)
+{
+	AppendEdges(GetEdges(data, threshold, EdgeCache::EDGE_RISING), edges);
+}
+
+/**
+	@brief Find rising edges in a uniformly sampled waveform, interpolating as necessary
+ */
+void Filter::FindRisingEdges(UniformAnalogWaveform* data, float threshold, vector<int64_t>& edges)
+{
+	AppendEdges(GetEdges(data, threshold, EdgeCache::EDGE_RISING), edges);
+}
+
+/**
+	@brief Find zero crossings in a waveform, interpolating as necessary
+ */
+void Filter::FindZeroCrossings(AnalogWaveform* data, float threshold, vector<int64_t>& edges)
+{
+	AppendEdges(GetEdges(data, threshold, EdgeCache::EDGE_ANY), edges);
+}
+
+/**
+	@brief Find zero crossings in a uniformly sampled waveform, interpolating as necessary
+ */
+void Filter::FindZeroCrossings(UniformAnalogWaveform* data, float threshold, vector<int64_t>& edges)
+{
+	AppendEdges(GetEdges(data, threshold, EdgeCache::EDGE_ANY), edges);
+}
+
+/**
+	@brief Find zero crossings in a waveform of 8-bit ADC codes, interpolating as necessary
+ */
+void Filter::FindZeroCrossings(ADC8Waveform* data, float threshold, vector<int64_t>& edges)
+{
+	AppendEdges(GetEdges(data, threshold, EdgeCache::EDGE_ANY), edges);
+}
+
+/**
+	@brief Find zero crossings in a waveform of 16-bit ADC codes, interpolating as necessary
+ */
+void Filter::FindZeroCrossings(ADC16Waveform* data, float threshold, vector<int64_t>& edges)
+{
+	AppendEdges(GetEdges(data, threshold, EdgeCache::EDGE_ANY), edges);
+}
+
+/**
+	@brief Find edges in a waveform, discarding repeated samples
+ */
+void Filter::FindZeroCrossings(DigitalWaveform* data, vector<int64_t>& edges)
+{
+	AppendEdges(GetEdges(data, 0, EdgeCache::EDGE_ANY), edges);
+}
+
+/**
+	@brief Find edges in a uniformly sampled waveform, discarding repeated samples
+ */
+void Filter::FindZeroCrossings(UniformDigitalWaveform* data, vector<int64_t>& edges)
+{
+	AppendEdges(GetEdges(data, 0, EdgeCache::EDGE_ANY), edges);
+}
+
+/**
+	@brief Find rising edges in a waveform
+ */
+void Filter::FindRisingEdges(DigitalWaveform* data, vector<int64_t>& edges)
+{
+	AppendEdges(GetEdges(data, 0, EdgeCache::EDGE_RISING), edges);
+}
 
-		last = value;
-	}
+/**
+	@brief Find rising edges in a uniformly sampled waveform
+ */
+void Filter::FindRisingEdges(UniformDigitalWaveform* data, vector<int64_t>& edges)
+{
+	AppendEdges(GetEdges(data, 0, EdgeCache::EDGE_RISING), edges);
 }
 
 /**
@@ -752,29 +1657,39 @@ void Filter::FindRisingEdges(DigitalWaveform* data, vector<int64_t>& edges)
  */
 void Filter::FindFallingEdges(DigitalWaveform* data, vector<int64_t>& edges)
 {
-	//Find times of the zero crossings
-	bool first = true;
-	bool last = data->m_samples[0];
-	int64_t phoff = data->m_timescale/2 + data->m_triggerPhase;
-	size_t len = data->m_samples.size();
-	for(size_t i=1; i<len; i++)
-	{
-		bool value = data->m_samples[i];
+	AppendEdges(GetEdges(data, 0, EdgeCache::EDGE_FALLING), edges);
+}
 
-		//Save the last value
-		if(first)
-		{
-			last = value;
-			first = false;
-			continue;
-		}
+/**
+	@brief Find falling edges in a uniformly sampled waveform
+ */
+void Filter::FindFallingEdges(UniformDigitalWaveform* data, vector<int64_t>& edges)
+{
+	AppendEdges(GetEdges(data, 0, EdgeCache::EDGE_FALLING), edges);
+}
 
-		//Save samples with an edge
-		if(!value && last)
-			edges.push_back(phoff + data->m_timescale * data->m_offsets[i]);
+/**
+	@brief Find edges in a bit-packed waveform, discarding repeated samples
+ */
+void Filter::FindZeroCrossings(PackedDigitalWaveform* data, vector<int64_t>& edges)
+{
+	AppendEdges(GetEdges(data, 0, EdgeCache::EDGE_ANY), edges);
+}
 
-		last = value;
-	}
+/**
+	@brief Find rising edges in a bit-packed waveform
+ */
+void Filter::FindRisingEdges(PackedDigitalWaveform* data, vector<int64_t>& edges)
+{
+	AppendEdges(GetEdges(data, 0, EdgeCache::EDGE_RISING), edges);
+}
+
+/**
+	@brief Find falling edges in a bit-packed waveform
+ */
+void Filter::FindFallingEdges(PackedDigitalWaveform* data, vector<int64_t>& edges)
+{
+	AppendEdges(GetEdges(data, 0, EdgeCache::EDGE_FALLING), edges);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -899,7 +1814,8 @@ string Filter::GetTextForAsciiChannel(int i, size_t stream)
 
 	@return Interpolated crossing time. 0=a, 1=a+1, fractional values are in between.
  */
-float Filter::InterpolateTime(AnalogWaveform* cap, size_t a, float voltage)
+template<class T>
+static float InterpolateTimeInner(T* cap, size_t a, float voltage)
 {
 	//If the voltage isn't between the two points, abort
 	float fa = cap->m_samples[a];
@@ -915,6 +1831,16 @@ float Filter::InterpolateTime(AnalogWaveform* cap, size_t a, float voltage)
 	return delta / slope;
 }
 
+float Filter::InterpolateTime(AnalogWaveform* cap, size_t a, float voltage)
+{
+	return InterpolateTimeInner(cap, a, voltage);
+}
+
+float Filter::InterpolateTime(UniformAnalogWaveform* cap, size_t a, float voltage)
+{
+	return InterpolateTimeInner(cap, a, voltage);
+}
+
 /**
 	@brief Interpolates the actual time of a differential threshold crossing between two samples
 
@@ -955,62 +1881,28 @@ float Filter::InterpolateValue(AnalogWaveform* cap, size_t index, float frac_tic
 	return v1 + (v2-v1)*frac;
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Measurement helpers
-
-/**
-	@brief Gets the lowest voltage of a waveform
- */
-float Filter::GetMinVoltage(AnalogWaveform* cap)
-{
-	//Loop over samples and find the minimum
-	float tmp = FLT_MAX;
-	for(float f : cap->m_samples)
-	{
-		if(f < tmp)
-			tmp = f;
-	}
-	return tmp;
-}
-
 /**
-	@brief Gets the highest voltage of a waveform
- */
-float Filter::GetMaxVoltage(AnalogWaveform* cap)
-{
-	//Loop over samples and find the maximum
-	float tmp = -FLT_MAX;
-	for(float f : cap->m_samples)
-	{
-		if(f > tmp)
-			tmp = f;
-	}
-	return tmp;
-}
+	@brief Interpolates the actual value of a point between two samples of a uniformly sampled waveform
 
-/**
-	@brief Gets the average voltage of a waveform
+	@param cap			Waveform to work with
+	@param index		Starting position
+	@param frac_ticks	Fractional position of the sample, in timebase ticks
  */
-float Filter::GetAvgVoltage(AnalogWaveform* cap)
+float Filter::InterpolateValue(UniformAnalogWaveform* cap, size_t index, float frac_ticks)
 {
-	//Loop over samples and find the average
-	//TODO: more numerically stable summation algorithm for deep captures
-	double sum = 0;
-	for(float f : cap->m_samples)
-		sum += f;
-	return sum / cap->m_samples.size();
+	float v1 = cap->m_samples[index];
+	float v2 = cap->m_samples[index+1];
+	return v1 + (v2-v1)*frac_ticks;
 }
 
-/**
-	@brief Makes a histogram from a waveform with the specified number of bins.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Measurement helpers
 
-	Any values outside the range are clamped (put in bin 0 or bins-1 as appropriate).
+//Shared implementations for sparse and uniform analog waveforms.
+//Only the sample values are used, so the timebase representation doesn't matter.
 
-	@param low	Low endpoint of the histogram (volts)
-	@param high High endpoint of the histogram (volts)
-	@param bins	Number of histogram bins
- */
-vector<size_t> Filter::MakeHistogram(AnalogWaveform* cap, float low, float high, size_t bins)
+template<class T>
+static vector<size_t> MakeHistogramInner(T* cap, float low, float high, size_t bins)
 {
 	vector<size_t> ret;
 	for(size_t i=0; i<bins; i++)
@@ -1036,16 +1928,8 @@ vector<size_t> Filter::MakeHistogram(AnalogWaveform* cap, float low, float high,
 	return ret;
 }
 
-/**
-	@brief Makes a histogram from a waveform with the specified number of bins.
-
-	Any values outside the range are discarded.
-
-	@param low	Low endpoint of the histogram (volts)
-	@param high High endpoint of the histogram (volts)
-	@param bins	Number of histogram bins
- */
-vector<size_t> Filter::MakeHistogramClipped(AnalogWaveform* cap, float low, float high, size_t bins)
+template<class T>
+static vector<size_t> MakeHistogramClippedInner(T* cap, float low, float high, size_t bins)
 {
 	vector<size_t> ret;
 	for(size_t i=0; i<bins; i++)
@@ -1069,31 +1953,95 @@ vector<size_t> Filter::MakeHistogramClipped(AnalogWaveform* cap, float low, floa
 	return ret;
 }
 
+/**
+	@brief Gets the lowest voltage of a waveform
+ */
+float Filter::GetMinVoltage(AnalogWaveform* cap)
+{
+	return WaveformSummary::Get(cap)->m_min;
+}
+
+float Filter::GetMinVoltage(UniformAnalogWaveform* cap)
+{
+	return WaveformSummary::Get(cap)->m_min;
+}
+
+/**
+	@brief Gets the highest voltage of a waveform
+ */
+float Filter::GetMaxVoltage(AnalogWaveform* cap)
+{
+	return WaveformSummary::Get(cap)->m_max;
+}
+
+float Filter::GetMaxVoltage(UniformAnalogWaveform* cap)
+{
+	return WaveformSummary::Get(cap)->m_max;
+}
+
+/**
+	@brief Gets the average voltage of a waveform
+ */
+float Filter::GetAvgVoltage(AnalogWaveform* cap)
+{
+	return WaveformSummary::Get(cap)->GetMean();
+}
+
+float Filter::GetAvgVoltage(UniformAnalogWaveform* cap)
+{
+	return WaveformSummary::Get(cap)->GetMean();
+}
+
+/**
+	@brief Makes a histogram from a waveform with the specified number of bins.
+
+	Any values outside the range are clamped (put in bin 0 or bins-1 as appropriate).
+
+	@param low	Low endpoint of the histogram (volts)
+	@param high High endpoint of the histogram (volts)
+	@param bins	Number of histogram bins
+ */
+vector<size_t> Filter::MakeHistogram(AnalogWaveform* cap, float low, float high, size_t bins)
+{
+	return MakeHistogramInner(cap, low, high, bins);
+}
+
+vector<size_t> Filter::MakeHistogram(UniformAnalogWaveform* cap, float low, float high, size_t bins)
+{
+	return MakeHistogramInner(cap, low, high, bins);
+}
+
+/**
+	@brief Makes a histogram from a waveform with the specified number of bins.
+
+	Any values outside the range are discarded.
+
+	@param low	Low endpoint of the histogram (volts)
+	@param high High endpoint of the histogram (volts)
+	@param bins	Number of histogram bins
+ */
+vector<size_t> Filter::MakeHistogramClipped(AnalogWaveform* cap, float low, float high, size_t bins)
+{
+	return MakeHistogramClippedInner(cap, low, high, bins);
+}
+
+vector<size_t> Filter::MakeHistogramClipped(UniformAnalogWaveform* cap, float low, float high, size_t bins)
+{
+	return MakeHistogramClippedInner(cap, low, high, bins);
+}
+
 /**
 	@brief Gets the most probable "0" level for a digital waveform
  */
 float Filter::GetBaseVoltage(AnalogWaveform* cap)
 {
-	float vmin = GetMinVoltage(cap);
-	float vmax = GetMaxVoltage(cap);
-	float delta = vmax - vmin;
-	const int nbins = 100;
-	auto hist = MakeHistogram(cap, vmin, vmax, nbins);
-
-	//Find the highest peak in the first quarter of the histogram
-	size_t binval = 0;
-	int idx = 0;
-	for(int i=0; i<(nbins/4); i++)
-	{
-		if(hist[i] > binval)
-		{
-			binval = hist[i];
-			idx = i;
-		}
-	}
+	//Highest peak in the first quarter of the histogram
+	return WaveformSummary::Get(cap)->GetHistogramPeak(0, WaveformSummary::HISTOGRAM_BINS/4);
+}
 
-	float fbin = (idx + 0.5f)/nbins;
-	return fbin*delta + vmin;
+float Filter::GetBaseVoltage(UniformAnalogWaveform* cap)
+{
+	return WaveformSummary::Get(cap)->GetHistogramPeak(0, WaveformSummary::HISTOGRAM_BINS/4);
 }
 
 /**
@@ -1101,32 +2049,21 @@ float Filter::GetBaseVoltage(AnalogWaveform* cap)
  */
 float Filter::GetTopVoltage(AnalogWaveform* cap)
 {
-	float vmin = GetMinVoltage(cap);
-	float vmax = GetMaxVoltage(cap);
-	float delta = vmax - vmin;
-	const int nbins = 100;
-	auto hist = MakeHistogram(cap, vmin, vmax, nbins);
-
-	//Find the highest peak in the third quarter of the histogram
-	size_t binval = 0;
-	int idx = 0;
-	for(int i=(nbins*3)/4; i<nbins; i++)
-	{
-		if(hist[i] > binval)
-		{
-			binval = hist[i];
-			idx = i;
-		}
-	}
+	//Highest peak in the last quarter of the histogram
+	const size_t nbins = WaveformSummary::HISTOGRAM_BINS;
+	return WaveformSummary::Get(cap)->GetHistogramPeak((nbins*3)/4, nbins);
+}
 
-	float fbin = (idx + 0.5f)/nbins;
-	return fbin*delta + vmin;
+float Filter::GetTopVoltage(UniformAnalogWaveform* cap)
+{
+	const size_t nbins = WaveformSummary::HISTOGRAM_BINS;
+	return WaveformSummary::Get(cap)->GetHistogramPeak((nbins*3)/4, nbins);
 }
 
 void Filter::ClearAnalysisCache()
 {
-	lock_guard<mutex> lock(m_cacheMutex);
-	m_zeroCrossingCache.clear();
+	EdgeCache::Clear();
+	WaveformSummary::Clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1149,7 +2086,7 @@ AnalogWaveform* Filter::SetupEmptyOutputWaveform(WaveformBase* din, size_t strea
 	AnalogWaveform* cap = dynamic_cast<AnalogWaveform*>(GetData(stream));
 	if(cap == NULL)
 	{
-		cap = new AnalogWaveform;
+		cap = WaveformPool::Get<AnalogWaveform>();
 		SetData(cap, stream);
 	}
 
@@ -1184,7 +2121,7 @@ DigitalWaveform* Filter::SetupEmptyDigitalOutputWaveform(WaveformBase* din, size
 	DigitalWaveform* cap = dynamic_cast<DigitalWaveform*>(GetData(stream));
 	if(cap == NULL)
 	{
-		cap = new DigitalWaveform;
+		cap = WaveformPool::Get<DigitalWaveform>();
 		SetData(cap, stream);
 	}
 
@@ -1222,43 +2159,9 @@ AnalogWaveform* Filter::SetupOutputWaveform(WaveformBase* din, size_t stream, si
 	cap->m_startFemtoseconds	= din->m_startFemtoseconds;
 	cap->m_triggerPhase			= din->m_triggerPhase;
 
-	size_t len = din->m_offsets.size() - (skipstart + skipend);
-	size_t curlen = cap->m_offsets.size();
-
-	cap->Resize(len);
-
-	//If the input waveform is NOT dense packed, no optimizations possible.
-	if(!din->m_densePacked)
-	{
-		memcpy(&cap->m_offsets[0], &din->m_offsets[skipstart], len*sizeof(int64_t));
-		memcpy(&cap->m_durations[0], &din->m_durations[skipstart], len*sizeof(int64_t));
-		cap->m_densePacked = false;
-	}
-
-	//Input waveform is dense packed, but output is not.
-	//Need to clear some old stuff but we can produce a dense packed output.
-	//Note that we copy from zero regardless of skipstart to produce a dense packed output.
-	//TODO: AVX2 optimizations here so we don't need to read data we already know the value of
-	else if(!cap->m_densePacked)
-	{
-		memcpy(&cap->m_offsets[0], &din->m_offsets[0], len*sizeof(int64_t));
-		memcpy(&cap->m_durations[0], &din->m_durations[0], len*sizeof(int64_t));
-		cap->m_densePacked = true;
-	}
-
-	//Both waveforms are dense packed, but new size is bigger. Need to copy the additional data.
-	else if(len > curlen)
-	{
-		size_t increase = len - curlen;
-		memcpy(&cap->m_offsets[curlen], &din->m_offsets[curlen], increase*sizeof(int64_t));
-		memcpy(&cap->m_durations[curlen], &din->m_durations[curlen], increase*sizeof(int64_t));
-	}
+	size_t len = din->size() - (skipstart + skipend);
 
-	//Both waveforms are dense packed, new size is smaller or the same.
-	//This is what we want: no work needed at all!
-	else
-	{
-	}
+	CopyTimestampsForOutput(din, cap, skipstart, len, m_incrementalRefresh);
 
 	return cap;
 }
@@ -1282,7 +2185,7 @@ DigitalWaveform* Filter::SetupDigitalOutputWaveform(WaveformBase* din, size_t st
 	DigitalWaveform* cap = dynamic_cast<DigitalWaveform*>(GetData(stream));
 	if(cap == NULL)
 	{
-		cap = new DigitalWaveform;
+		cap = WaveformPool::Get<DigitalWaveform>();
 		SetData(cap, stream);
 	}
 
@@ -1292,43 +2195,95 @@ DigitalWaveform* Filter::SetupDigitalOutputWaveform(WaveformBase* din, size_t st
 	cap->m_startFemtoseconds	= din->m_startFemtoseconds;
 	cap->m_triggerPhase			= din->m_triggerPhase;
 
-	size_t len = din->m_offsets.size() - (skipstart + skipend);
-	size_t curlen = cap->m_offsets.size();
+	size_t len = din->size() - (skipstart + skipend);
+
+	CopyTimestampsForOutput(din, cap, skipstart, len, m_incrementalRefresh);
+
+	return cap;
+}
+
+/**
+	@brief Resizes a sparse output waveform and fills its timestamps from an input waveform.
+
+	If the input is dense packed (this includes all uniform waveforms), the output is dense packed too and timestamps
+	are computed rather than copied. Note that we start from zero regardless of skipstart in this case.
+
+	@param din			Input waveform
+	@param cap			Output waveform
+	@param skipstart	Number of input samples to discard from the beginning of the waveform
+	@param len			Number of samples in the output
+	@param appendOnly	True if the input has only had samples appended since cap was last filled from it
+ */
+void Filter::CopyTimestampsForOutput(WaveformBase* din, SparseWaveformBase* cap, size_t skipstart, size_t len, bool appendOnly)
+{
+	size_t curlen = cap->size();
 
 	cap->Resize(len);
 
 	//If the input waveform is NOT dense packed, no optimizations possible.
+	//(except during an incremental refresh, where the existing timestamps are already right: only copy the new ones,
+	//plus the last old one since its duration may have grown)
 	if(!din->m_densePacked)
 	{
-		memcpy(&cap->m_offsets[0], &din->m_offsets[skipstart], len*sizeof(int64_t));
-		memcpy(&cap->m_durations[0], &din->m_durations[skipstart], len*sizeof(int64_t));
+		size_t first = 0;
+		if(appendOnly && !cap->m_densePacked && (curlen > 0) && (curlen <= len) )
+			first = curlen - 1;
+
+		auto sdin = static_cast<SparseWaveformBase*>(din);
+		memcpy(&cap->m_offsets[first], &sdin->m_offsets[skipstart + first], (len - first)*sizeof(int64_t));
+		memcpy(&cap->m_durations[first], &sdin->m_durations[skipstart + first], (len - first)*sizeof(int64_t));
 		cap->m_densePacked = false;
 	}
 
 	//Input waveform is dense packed, but output is not.
 	//Need to clear some old stuff but we can produce a dense packed output.
-	//Note that we copy from zero regardless of skipstart to produce a dense packed output.
-	//TODO: AVX2 optimizations here so we don't need to read data we already know the value of
 	else if(!cap->m_densePacked)
 	{
-		memcpy(&cap->m_offsets[0], &din->m_offsets[0], len*sizeof(int64_t));
-		memcpy(&cap->m_durations[0], &din->m_durations[0], len*sizeof(int64_t));
+		cap->FillDenseTimestamps(0, len);
 		cap->m_densePacked = true;
 	}
 
-	//Both waveforms are dense packed, but new size is bigger. Need to copy the additional data.
+	//Both waveforms are dense packed, but new size is bigger. Need to fill the additional samples.
 	else if(len > curlen)
-	{
-		size_t increase = len - curlen;
-		memcpy(&cap->m_offsets[curlen], &din->m_offsets[curlen], increase*sizeof(int64_t));
-		memcpy(&cap->m_durations[curlen], &din->m_durations[curlen], increase*sizeof(int64_t));
-	}
+		cap->FillDenseTimestamps(curlen, len);
 
 	//Both waveforms are dense packed, new size is smaller or the same.
 	//This is what we want: no work needed at all!
 	else
 	{
 	}
+}
+
+/**
+	@brief Sets up a uniformly sampled analog output waveform and copies basic metadata from the input.
+
+	A new output waveform is created if necessary, but when possible the existing one is reused.
+
+	@param din			Input waveform
+	@param stream		Stream index
+	@param clear		True to clear an existing waveform, false to leave it as-is
+
+	@return	The ready-to-use output waveform
+ */
+UniformAnalogWaveform* Filter::SetupEmptyUniformAnalogOutputWaveform(WaveformBase* din, size_t stream, bool clear)
+{
+	//Create the waveform, but only if necessary
+	auto cap = dynamic_cast<UniformAnalogWaveform*>(GetData(stream));
+	if(cap == NULL)
+	{
+		cap = WaveformPool::Get<UniformAnalogWaveform>();
+		SetData(cap, stream);
+	}
+
+	//Copy configuration
+	cap->m_timescale 			= din->m_timescale;
+	cap->m_startTimestamp 		= din->m_startTimestamp;
+	cap->m_startFemtoseconds	= din->m_startFemtoseconds;
+	cap->m_triggerPhase			= din->m_triggerPhase;
+
+	//Clear output
+	if(clear)
+		cap->clear();
 
 	return cap;
 }
@@ -1370,7 +2325,7 @@ uint32_t Filter::CRC32(vector<uint8_t>& bytes, size_t start, size_t end)
 int64_t Filter::GetNextEventTimestamp(WaveformBase* wfm, size_t i, size_t len, int64_t timestamp)
 {
 	if(i+1 < len)
-		return wfm->m_offsets[i+1];
+		return wfm->GetOffset(i+1);
 	else
 		return timestamp;
 }
@@ -1382,7 +2337,16 @@ int64_t Filter::GetNextEventTimestamp(WaveformBase* wfm, size_t i, size_t len, i
  */
 void Filter::AdvanceToTimestamp(WaveformBase* wfm, size_t& i, size_t len, int64_t timestamp)
 {
-	while( ((i+1) < len) && (wfm->m_offsets[i+1] <= timestamp) )
+	//Dense packed: sample k starts at k, so we can jump straight there
+	if(wfm->m_densePacked)
+	{
+		if( (len > 0) && (timestamp > (int64_t)i) )
+			i = max(i, min(static_cast<size_t>(timestamp), len-1));
+		return;
+	}
+
+	auto swfm = static_cast<SparseWaveformBase*>(wfm);
+	while( ((i+1) < len) && (swfm->m_offsets[i+1] <= timestamp) )
 		i ++;
 }
 
@@ -1394,7 +2358,7 @@ void Filter::AdvanceToTimestamp(WaveformBase* wfm, size_t& i, size_t len, int64_
 int64_t Filter::GetNextEventTimestampScaled(WaveformBase* wfm, size_t i, size_t len, int64_t timestamp)
 {
 	if(i+1 < len)
-		return (wfm->m_offsets[i+1] * wfm->m_timescale) + wfm->m_triggerPhase;
+		return wfm->GetOffsetScaled(i+1);
 	else
 		return timestamp;
 }
@@ -1408,7 +2372,20 @@ void Filter::AdvanceToTimestampScaled(WaveformBase* wfm, size_t& i, size_t len,
 {
 	timestamp -= wfm->m_triggerPhase;
 
-	while( ((i+1) < len) && ( (wfm->m_offsets[i+1] * wfm->m_timescale) <= timestamp) )
+	//Dense packed: convert the timestamp to a sample index directly
+	if(wfm->m_densePacked)
+	{
+		if(timestamp < 0)
+			return;
+		if(wfm->m_timescale > 0)
+			AdvanceToTimestamp(wfm, i, len, timestamp / wfm->m_timescale);
+		else if(len > 0)
+			i = max(i, len-1);
+		return;
+	}
+
+	auto swfm = static_cast<SparseWaveformBase*>(wfm);
+	while( ((i+1) < len) && ( (swfm->m_offsets[i+1] * wfm->m_timescale) <= timestamp) )
 		i ++;
 }
 
@@ -1571,20 +2548,25 @@ void Filter::AddStream(Unit yunit, const string& name)
 void Filter::AutoscaleVertical(size_t stream)
 {
 	//Autoscaling anything but an analog waveform makes no sense
-	auto waveform = dynamic_cast<AnalogWaveform*>(GetData(stream));
-	if(!waveform)
-		return;
+	auto data = GetData(stream);
+	auto waveform = dynamic_cast<AnalogWaveform*>(data);
+	auto uwaveform = dynamic_cast<UniformAnalogWaveform*>(data);
 
 	//Find extrema of the waveform
-	//TODO: vectorize?
-	float vmin = FLT_MAX;
-	float vmax = -FLT_MAX;
-	for(auto s : waveform->m_samples)
+	float vmin;
+	float vmax;
+	if(waveform)
 	{
-		float v = s;
-		vmin = min(v, vmin);
-		vmax = max(v, vmax);
+		vmin = GetMinVoltage(waveform);
+		vmax = GetMaxVoltage(waveform);
 	}
+	else if(uwaveform)
+	{
+		vmin = GetMinVoltage(uwaveform);
+		vmax = GetMaxVoltage(uwaveform);
+	}
+	else
+		return;
 
 	float range = vmax - vmin;
 	if(IsScalarOutput())
@@ -134,6 +134,9 @@ public:
 			f->SetDirty();
 	}
 
+	static std::set<Filter*> GetDownstreamFilters(const std::set<StreamDescriptor>& streams);
+	static std::set<Filter*> SetDirtyDownstreamOf(const std::set<StreamDescriptor>& streams);
+
 	/**
 		@brief Clears any integrated data from past triggers (e.g. eye patterns).
 
@@ -147,6 +150,137 @@ public:
 	void SetDirty()
 	{ m_dirty = true; }
 
+	bool IsDirty()
+	{ return m_dirty; }
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Result caching and incremental refresh
+
+	virtual bool IsResultCacheable();
+	virtual bool SupportsIncrementalRefresh();
+
+	///@brief Returns the number of times RefreshIfDirty() skipped Refresh() because nothing had changed
+	uint64_t GetCacheHits()
+	{ return m_cacheHits; }
+
+	///@brief Returns the number of times RefreshIfDirty() had to call Refresh()
+	uint64_t GetCacheMisses()
+	{ return m_cacheMisses; }
+
+	///@brief Returns the number of skipped refreshes across all filters
+	static uint64_t GetTotalCacheHits()
+	{ return m_totalCacheHits; }
+
+	///@brief Returns the number of actual refreshes across all filters
+	static uint64_t GetTotalCacheMisses()
+	{ return m_totalCacheMisses; }
+
+	void ResetCacheStatistics();
+	static void ResetAllCacheStatistics();
+
+protected:
+
+	/**
+		@brief Returns true if the current call to Refresh() only needs to process newly appended input samples.
+
+		This is only ever true for filters which return true from SupportsIncrementalRefresh(). When it is, every
+		input is the same waveform as last time, in the same append-only session, with the same or more samples, no
+		parameter has changed since the last refresh, and all outputs are still present. The filter is expected to
+		extend its existing outputs in place, picking up any decoder state it saved at the end of the previous call.
+	 */
+	bool IsIncrementalRefresh()
+	{ return m_incrementalRefresh; }
+
+	/**
+		@brief Returns the index of the first sample of input i that has not been seen by a previous Refresh() call.
+
+		Zero unless IsIncrementalRefresh() is true.
+	 */
+	size_t GetFirstNewSample(size_t i)
+	{
+		if(!m_incrementalRefresh)
+			return 0;
+		return m_lastInputs[i].m_size;
+	}
+
+	bool IsLastRefreshCurrent();
+	void BeginIncrementalRefresh();
+	void SaveRefreshState();
+	uint64_t GetConfigurationHash();
+
+	/**
+		@brief What we knew about one input or output waveform at the end of the last refresh
+	 */
+	class WaveformState
+	{
+	public:
+		WaveformBase* m_waveform;
+		uint64_t m_revision;
+		uint64_t m_session;
+		size_t m_size;
+
+		void Save(WaveformBase* wfm)
+		{
+			m_waveform = wfm;
+			m_revision = wfm ? wfm->m_revision : 0;
+			m_session = wfm ? wfm->m_appendSession : 0;
+			m_size = wfm ? wfm->size() : 0;
+		}
+
+		///@brief Returns true if wfm is the same waveform we saw, with the same contents
+		bool IsCurrent(WaveformBase* wfm) const
+		{
+			if(wfm != m_waveform)
+				return false;
+			return !wfm || (wfm->m_revision == m_revision);
+		}
+	};
+
+	///@brief True if m_lastInputs, m_lastOutputs and m_lastConfigurationHash describe a previous refresh
+	bool m_hasRefreshState;
+
+	///@brief State of each input as of the end of the last refresh
+	std::vector<WaveformState> m_lastInputs;
+
+	///@brief State of each output as of the end of the last refresh
+	std::vector<WaveformState> m_lastOutputs;
+
+	///@brief Hash of our parameter values and input vertical scales as of the end of the last refresh
+	uint64_t m_lastConfigurationHash;
+
+	///@brief True while running an incremental Refresh()
+	bool m_incrementalRefresh;
+
+	///@brief Number of refreshes skipped because nothing changed
+	std::atomic<uint64_t> m_cacheHits;
+
+	///@brief Number of refreshes actually performed
+	std::atomic<uint64_t> m_cacheMisses;
+
+	static std::atomic<uint64_t> m_totalCacheHits;
+	static std::atomic<uint64_t> m_totalCacheMisses;
+
+public:
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Profiling
+
+	FilterProfileStatistics GetProfileStatistics(FilterProfiler::Metric metric);
+	std::vector<FilterRefreshProfile> GetProfileHistory();
+	void ResetProfile();
+	static void ResetAllProfiles();
+
+protected:
+	void ProfiledRefresh();
+
+	///@brief Mutex protecting m_profileHistory
+	std::mutex m_profileMutex;
+
+	///@brief Most recent refreshes of this filter, oldest first
+	std::deque<FilterRefreshProfile> m_profileHistory;
+
+public:
+
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// Vertical scaling
 
@@ -222,6 +356,10 @@ protected:
 	DigitalWaveform* SetupEmptyDigitalOutputWaveform(WaveformBase* din, size_t stream);
 	AnalogWaveform* SetupOutputWaveform(WaveformBase* din, size_t stream, size_t skipstart, size_t skipend);
 	DigitalWaveform* SetupDigitalOutputWaveform(WaveformBase* din, size_t stream, size_t skipstart, size_t skipend);
+	UniformAnalogWaveform* SetupEmptyUniformAnalogOutputWaveform(WaveformBase* din, size_t stream, bool clear=true);
+
+	static void CopyTimestampsForOutput(
+		WaveformBase* din, SparseWaveformBase* cap, size_t skipstart, size_t len, bool appendOnly = false);
 
 public:
 	//Text formatting for CHANNEL_TYPE_COMPLEX decodes
@@ -230,18 +368,26 @@ public:
 
 	//Helpers for sub-sample interoplation
 	static float InterpolateTime(AnalogWaveform* cap, size_t a, float voltage);
+	static float InterpolateTime(UniformAnalogWaveform* cap, size_t a, float voltage);
 	static float InterpolateTime(AnalogWaveform* p, AnalogWaveform* n, size_t a, float voltage);
 	static float InterpolateValue(AnalogWaveform* cap, size_t index, float frac_ticks);
+	static float InterpolateValue(UniformAnalogWaveform* cap, size_t index, float frac_ticks);
 
 	//Helpers for more complex measurements
-	//TODO: create some process for caching this so we don't waste CPU time
 	static float GetMinVoltage(AnalogWaveform* cap);
+	static float GetMinVoltage(UniformAnalogWaveform* cap);
 	static float GetMaxVoltage(AnalogWaveform* cap);
+	static float GetMaxVoltage(UniformAnalogWaveform* cap);
 	static float GetBaseVoltage(AnalogWaveform* cap);
+	static float GetBaseVoltage(UniformAnalogWaveform* cap);
 	static float GetTopVoltage(AnalogWaveform* cap);
+	static float GetTopVoltage(UniformAnalogWaveform* cap);
 	static float GetAvgVoltage(AnalogWaveform* cap);
+	static float GetAvgVoltage(UniformAnalogWaveform* cap);
 	static std::vector<size_t> MakeHistogram(AnalogWaveform* cap, float low, float high, size_t bins);
+	static std::vector<size_t> MakeHistogram(UniformAnalogWaveform* cap, float low, float high, size_t bins);
 	static std::vector<size_t> MakeHistogramClipped(AnalogWaveform* cap, float low, float high, size_t bins);
+	static std::vector<size_t> MakeHistogramClipped(UniformAnalogWaveform* cap, float low, float high, size_t bins);
 
 	//Samples a digital channel on the edges of another channel.
 	//The two channels need not be the same sample rate.
@@ -250,15 +396,37 @@ public:
 	static void SampleOnRisingEdges(DigitalWaveform* data, DigitalWaveform* clock, DigitalWaveform& samples);
 	static void SampleOnRisingEdges(DigitalBusWaveform* data, DigitalWaveform* clock, DigitalBusWaveform& samples);
 	static void SampleOnFallingEdges(DigitalWaveform* data, DigitalWaveform* clock, DigitalWaveform& samples);
+	static void SampleOnAnyEdges(DigitalWaveform* data, PackedDigitalWaveform* clock, DigitalWaveform& samples);
+	static void SampleOnAnyEdges(PackedDigitalWaveform* data, PackedDigitalWaveform* clock, DigitalWaveform& samples);
+	static void SampleOnRisingEdges(DigitalWaveform* data, PackedDigitalWaveform* clock, DigitalWaveform& samples);
+	static void SampleOnRisingEdges(PackedDigitalWaveform* data, PackedDigitalWaveform* clock, DigitalWaveform& samples);
+	static void SampleOnFallingEdges(DigitalWaveform* data, PackedDigitalWaveform* clock, DigitalWaveform& samples);
+	static void SampleOnFallingEdges(PackedDigitalWaveform* data, PackedDigitalWaveform* clock, DigitalWaveform& samples);
+	static void SampleOnEdges(DigitalWaveform* data, const std::vector<int64_t>& edges, DigitalWaveform& samples);
+	static void SampleOnEdges(PackedDigitalWaveform* data, const std::vector<int64_t>& edges, DigitalWaveform& samples);
+	static void SampleOnEdges(DigitalBusWaveform* data, const std::vector<int64_t>& edges, DigitalBusWaveform& samples);
 
 	//Find interpolated zero crossings of a signal
 	static void FindRisingEdges(AnalogWaveform* data, float threshold, std::vector<int64_t>& edges);
+	static void FindRisingEdges(UniformAnalogWaveform* data, float threshold, std::vector<int64_t>& edges);
 	static void FindZeroCrossings(AnalogWaveform* data, float threshold, std::vector<int64_t>& edges);
+	static void FindZeroCrossings(UniformAnalogWaveform* data, float threshold, std::vector<int64_t>& edges);
+	static void FindZeroCrossings(ADC8Waveform* data, float threshold, std::vector<int64_t>& edges);
+	static void FindZeroCrossings(ADC16Waveform* data, float threshold, std::vector<int64_t>& edges);
 
 	//Find edges in a signal (discarding repeated samples)
 	static void FindZeroCrossings(DigitalWaveform* data, std::vector<int64_t>& edges);
+	static void FindZeroCrossings(UniformDigitalWaveform* data, std::vector<int64_t>& edges);
 	static void FindRisingEdges(DigitalWaveform* data, std::vector<int64_t>& edges);
+	static void FindRisingEdges(UniformDigitalWaveform* data, std::vector<int64_t>& edges);
 	static void FindFallingEdges(DigitalWaveform* data, std::vector<int64_t>& edges);
+	static void FindFallingEdges(UniformDigitalWaveform* data, std::vector<int64_t>& edges);
+	static void FindZeroCrossings(PackedDigitalWaveform* data, std::vector<int64_t>& edges);
+	static void FindRisingEdges(PackedDigitalWaveform* data, std::vector<int64_t>& edges);
+	static void FindFallingEdges(PackedDigitalWaveform* data, std::vector<int64_t>& edges);
+
+	//Shared, cached edge lists (no copy)
+	static EdgeCache::EdgeList GetEdges(WaveformBase* data, float threshold, EdgeCache::EdgeType type);
 
 	static void ClearAnalysisCache();
 
@@ -309,10 +477,6 @@ protected:
 
 	//Instance naming
 	static std::map<std::string, unsigned int> m_instanceCount;
-
-	//Caching
-	static std::mutex m_cacheMutex;
-	static std::map<std::pair<WaveformBase*, float>, std::vector<int64_t> > m_zeroCrossingCache;
 };
 
 #define PROTOCOL_DECODER_INITPROC(T) \
@@ -0,0 +1,381 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* libscopehal v0.1                                                                                                     *
+*                                                                                                                      *
+* Copyright (c) 2012-2022 Andrew D. Zonenberg and contributors                                                         *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of FilterGraphExecutor
+ */
+
+#include "scopehal.h"
+#include "FilterGraphExecutor.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+/**
+	@brief Creates an executor
+
+	@param numThreads	Number of worker threads, or 0 to use one per hardware thread
+ */
+FilterGraphExecutor::FilterGraphExecutor(size_t numThreads)
+	: m_numThreads(0)
+	, m_terminating(false)
+	, m_remaining(0)
+{
+	SetThreadCount(numThreads);
+}
+
+FilterGraphExecutor::~FilterGraphExecutor()
+{
+	StopThreads();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Thread pool management
+
+/**
+	@brief Changes the number of threads filters are refreshed on
+
+	@param numThreads	Number of worker threads, 0 to use one per hardware thread, or 1 for deterministic single
+						threaded operation
+ */
+void FilterGraphExecutor::SetThreadCount(size_t numThreads)
+{
+	lock_guard<mutex> lock(m_runMutex);
+
+	if(numThreads == 0)
+		numThreads = max(1U, thread::hardware_concurrency());
+	if(numThreads == m_numThreads)
+		return;
+
+	StopThreads();
+	m_numThreads = numThreads;
+	StartThreads();
+}
+
+void FilterGraphExecutor::StartThreads()
+{
+	//Single threaded mode runs everything on the caller's thread
+	if(m_numThreads <= 1)
+		return;
+
+	m_terminating = false;
+	m_queues.resize(m_numThreads);
+	for(size_t i=0; i<m_numThreads; i++)
+		m_threads.push_back(thread(&FilterGraphExecutor::WorkerThread, this, i));
+}
+
+void FilterGraphExecutor::StopThreads()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_terminating = true;
+	}
+	m_workCondition.notify_all();
+
+	for(auto& t : m_threads)
+		t.join();
+	m_threads.clear();
+	m_queues.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Graph analysis
+
+/**
+	@brief Builds the dependency graph of the dirty filters in a set, plus any dirty filters upstream of them
+
+	@param filters		Filters to refresh
+	@param nodes		Dirty filters, sorted by display name so the graph is the same from run to run
+	@param consumers	For each node, indexes of the nodes which use its output
+	@param numInputs	For each node, number of other nodes it depends on
+ */
+void FilterGraphExecutor::BuildGraph(
+	const set<Filter*>& filters,
+	vector<Filter*>& nodes,
+	vector< vector<size_t> >& consumers,
+	vector<size_t>& numInputs)
+{
+	//Find all of the dirty filters, including inputs of the requested ones that weren't in the set
+	set<Filter*> dirty;
+	vector<Filter*> pending;
+	for(auto f : filters)
+	{
+		if(f->IsDirty())
+			pending.push_back(f);
+	}
+	while(!pending.empty())
+	{
+		auto f = pending.back();
+		pending.pop_back();
+		if(dirty.find(f) != dirty.end())
+			continue;
+		dirty.emplace(f);
+
+		for(size_t i=0; i<f->GetInputCount(); i++)
+		{
+			auto in = dynamic_cast<Filter*>(f->GetInput(i).m_channel);
+			if(in && in->IsDirty())
+				pending.push_back(in);
+		}
+	}
+
+	nodes.assign(dirty.begin(), dirty.end());
+	sort(nodes.begin(), nodes.end(),
+		[](Filter* a, Filter* b)
+		{
+			auto na = a->GetDisplayName();
+			auto nb = b->GetDisplayName();
+			if(na != nb)
+				return na < nb;
+			return a < b;
+		});
+
+	map<Filter*, size_t> indexes;
+	for(size_t i=0; i<nodes.size(); i++)
+		indexes[nodes[i]] = i;
+
+	//Connect each filter to the dirty filters it reads from (once, even if it uses several streams of one filter)
+	consumers.clear();
+	consumers.resize(nodes.size());
+	numInputs.clear();
+	numInputs.resize(nodes.size());
+	for(size_t i=0; i<nodes.size(); i++)
+	{
+		set<size_t> producers;
+		auto f = nodes[i];
+		for(size_t j=0; j<f->GetInputCount(); j++)
+		{
+			auto it = indexes.find(dynamic_cast<Filter*>(f->GetInput(j).m_channel));
+			if(it != indexes.end())
+				producers.emplace(it->second);
+		}
+
+		for(auto p : producers)
+			consumers[p].push_back(i);
+		numInputs[i] = producers.size();
+	}
+}
+
+/**
+	@brief Gets the order filters are refreshed in when running single threaded
+
+	This is a topological sort of the dirty filters in the set (and any dirty filters upstream of them). Filters with no
+	ordering constraint between them are sorted by display name.
+ */
+vector<Filter*> FilterGraphExecutor::GetRefreshOrder(const set<Filter*>& filters)
+{
+	vector<Filter*> nodes;
+	vector< vector<size_t> > consumers;
+	vector<size_t> numInputs;
+	BuildGraph(filters, nodes, consumers, numInputs);
+
+	vector<Filter*> order;
+	for(auto i : TopologicalSort(consumers, numInputs))
+		order.push_back(nodes[i]);
+	return order;
+}
+
+/**
+	@brief Sorts a dependency graph so every node comes after all of its inputs
+
+	Uses Kahn's algorithm, always taking the lowest numbered ready node so the order is deterministic. Nodes which are
+	part of (or downstream of) a cycle can never become ready and are left out.
+
+	@param consumers	For each node, indexes of the nodes which use its output
+	@param numInputs	For each node, number of other nodes it depends on
+
+	@return Node indexes in refresh order
+ */
+vector<size_t> FilterGraphExecutor::TopologicalSort(
+	const vector< vector<size_t> >& consumers,
+	vector<size_t> numInputs)
+{
+	set<size_t> ready;
+	for(size_t i=0; i<numInputs.size(); i++)
+	{
+		if(numInputs[i] == 0)
+			ready.emplace(i);
+	}
+
+	vector<size_t> order;
+	while(!ready.empty())
+	{
+		size_t n = *ready.begin();
+		ready.erase(ready.begin());
+		order.push_back(n);
+
+		for(auto c : consumers[n])
+		{
+			if(--numInputs[c] == 0)
+				ready.emplace(c);
+		}
+	}
+
+	if(order.size() != numInputs.size())
+	{
+		LogError("FilterGraphExecutor: filter graph contains a cycle, %zu filters not refreshed\n",
+			numInputs.size() - order.size());
+	}
+
+	return order;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Execution
+
+/**
+	@brief Refreshes all dirty filters in the set (and anything dirty upstream of them), returning once all are done
+ */
+void FilterGraphExecutor::RunBlocking(const set<Filter*>& filters)
+{
+	lock_guard<mutex> runlock(m_runMutex);
+
+	//Single threaded: just walk the sorted list
+	if(m_numThreads <= 1)
+	{
+		for(auto f : GetRefreshOrder(filters))
+			f->RefreshIfDirty();
+		return;
+	}
+
+	unique_lock<mutex> lock(m_mutex);
+
+	vector<size_t> numInputs;
+	BuildGraph(filters, m_nodes, m_consumers, numInputs);
+	m_pendingInputs = numInputs;
+
+	//Filters caught in a cycle never become ready, so only wait for the ones that can actually run
+	m_remaining = TopologicalSort(m_consumers, numInputs).size();
+
+	//Deal the filters that are ready right away out to the workers
+	size_t nready = 0;
+	for(size_t i=0; i<m_nodes.size(); i++)
+	{
+		if(m_pendingInputs[i] == 0)
+		{
+			m_queues[nready % m_numThreads].push_back(i);
+			nready ++;
+		}
+	}
+
+	if(m_remaining != 0)
+	{
+		m_workCondition.notify_all();
+		m_doneCondition.wait(lock, [&]{ return m_remaining == 0; });
+	}
+
+	m_nodes.clear();
+	m_consumers.clear();
+	m_pendingInputs.clear();
+}
+
+/**
+	@brief Checks if any worker has a task queued. Must be called with m_mutex held.
+ */
+bool FilterGraphExecutor::HasTasks()
+{
+	for(auto& q : m_queues)
+	{
+		if(!q.empty())
+			return true;
+	}
+	return false;
+}
+
+/**
+	@brief Gets the next task for a worker. Must be called with m_mutex held.
+
+	Workers take the most recently queued task from their own queue, or steal the oldest task from someone else's.
+ */
+bool FilterGraphExecutor::PopTask(size_t id, size_t& node)
+{
+	auto& own = m_queues[id];
+	if(!own.empty())
+	{
+		node = own.back();
+		own.pop_back();
+		return true;
+	}
+
+	for(size_t i=1; i<m_numThreads; i++)
+	{
+		auto& victim = m_queues[(id + i) % m_numThreads];
+		if(!victim.empty())
+		{
+			node = victim.front();
+			victim.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void FilterGraphExecutor::WorkerThread(size_t id)
+{
+	unique_lock<mutex> lock(m_mutex);
+	while(true)
+	{
+		m_workCondition.wait(lock, [&]{ return m_terminating || HasTasks(); });
+		if(m_terminating)
+			return;
+
+		size_t node;
+		if(!PopTask(id, node))
+			continue;
+
+		//All of this filter's inputs are up to date, so refreshing it won't recurse
+		auto f = m_nodes[node];
+		lock.unlock();
+		f->RefreshIfDirty();
+		lock.lock();
+
+		//Queue any consumers that are now ready on our own queue
+		size_t nready = 0;
+		for(auto c : m_consumers[node])
+		{
+			if(--m_pendingInputs[c] == 0)
+			{
+				m_queues[id].push_back(c);
+				nready ++;
+			}
+		}
+		//We'll pick one up ourselves, wake others for the rest
+		if(nready > 1)
+			m_workCondition.notify_all();
+
+		m_remaining --;
+		if(m_remaining == 0)
+			m_doneCondition.notify_all();
+	}
+}
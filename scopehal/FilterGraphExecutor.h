@@ -0,0 +1,137 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* libscopehal v0.1                                                                                                     *
+*                                                                                                                      *
+* Copyright (c) 2012-2022 Andrew D. Zonenberg and contributors                                                         *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of FilterGraphExecutor
+ */
+
+#ifndef FilterGraphExecutor_h
+#define FilterGraphExecutor_h
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <thread>
+
+/**
+	@brief Refreshes a set of filters in dependency order, running independent filters in parallel.
+
+	Filter::RefreshIfDirty() walks the graph recursively on the calling thread, so independent branches (for example
+	several eye patterns each fed by their own clock recovery) are evaluated one after another. The executor instead
+	sorts the dirty filters topologically and hands every filter whose inputs are up to date to a pool of worker threads.
+
+	Each worker has its own queue of ready filters. When a filter finishes, consumers that became ready are pushed onto
+	the queue of the worker that ran it (so they start while its output is still in cache) and idle workers steal from
+	the other end of other workers' queues.
+
+	With a thread count of 1, filters are refreshed on the calling thread in a deterministic order (topological, ties
+	broken by display name) which is handy for debugging.
+ */
+class FilterGraphExecutor
+{
+public:
+	FilterGraphExecutor(size_t numThreads = 0);
+	virtual ~FilterGraphExecutor();
+
+	void RunBlocking(const std::set<Filter*>& filters);
+
+	/**
+		@brief Refreshes every dirty filter in existence
+	 */
+	void RunBlocking()
+	{ RunBlocking(Filter::GetAllInstances()); }
+
+	void SetThreadCount(size_t numThreads);
+
+	/**
+		@brief Gets the number of threads filters are refreshed on (1 means single threaded and deterministic)
+	 */
+	size_t GetThreadCount()
+	{ return m_numThreads; }
+
+	static std::vector<Filter*> GetRefreshOrder(const std::set<Filter*>& filters);
+
+protected:
+	void StartThreads();
+	void StopThreads();
+	void WorkerThread(size_t id);
+	bool PopTask(size_t id, size_t& node);
+	bool HasTasks();
+
+	static std::vector<size_t> TopologicalSort(
+		const std::vector< std::vector<size_t> >& consumers,
+		std::vector<size_t> numInputs);
+
+	static void BuildGraph(
+		const std::set<Filter*>& filters,
+		std::vector<Filter*>& nodes,
+		std::vector< std::vector<size_t> >& consumers,
+		std::vector<size_t>& numInputs);
+
+	///@brief Number of threads to run filters on
+	size_t m_numThreads;
+
+	///@brief Worker threads (empty in single threaded mode)
+	std::vector<std::thread> m_threads;
+
+	///@brief Serializes calls to RunBlocking()
+	std::mutex m_runMutex;
+
+	///@brief Mutex protecting all of the scheduling state below
+	std::mutex m_mutex;
+
+	///@brief Signaled when tasks are queued or the workers should exit
+	std::condition_variable m_workCondition;
+
+	///@brief Signaled when the last filter of a run completes
+	std::condition_variable m_doneCondition;
+
+	///@brief Set to make the worker threads exit
+	bool m_terminating;
+
+	///@brief Filters being refreshed in the current run
+	std::vector<Filter*> m_nodes;
+
+	///@brief Indexes of the filters fed by each node
+	std::vector< std::vector<size_t> > m_consumers;
+
+	///@brief Number of inputs of each node which have not been refreshed yet
+	std::vector<size_t> m_pendingInputs;
+
+	///@brief Ready-to-run nodes, one queue per worker
+	std::vector< std::deque<size_t> > m_queues;
+
+	///@brief Number of nodes in the current run which have not completed
+	size_t m_remaining;
+};
+
+#endif
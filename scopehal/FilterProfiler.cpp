@@ -0,0 +1,223 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* libscopehal v0.1                                                                                                     *
+*                                                                                                                      *
+* Copyright (c) 2012-2022 Andrew D. Zonenberg and contributors                                                         *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of FilterProfiler
+ */
+
+#include "scopehal.h"
+#include "FilterProfiler.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+using namespace std;
+
+bool FilterProfiler::m_enabled = false;
+chrono::steady_clock::time_point FilterProfiler::m_epoch = chrono::steady_clock::now();
+mutex FilterProfiler::m_mutex;
+deque<FilterProfiler::TraceEvent> FilterProfiler::m_traceEvents;
+size_t FilterProfiler::m_maxTraceEvents = 100000;
+size_t FilterProfiler::m_numThreads = 0;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Clocks
+
+/**
+	@brief Gets the current time in microseconds since the profiler was initialized
+ */
+double FilterProfiler::GetTimestamp()
+{
+	return chrono::duration<double, micro>(chrono::steady_clock::now() - m_epoch).count();
+}
+
+/**
+	@brief Gets the CPU time used by the calling thread so far, in microseconds
+ */
+double FilterProfiler::GetThreadCPUTime()
+{
+#ifdef _WIN32
+	FILETIME creation;
+	FILETIME exit;
+	FILETIME kernel;
+	FILETIME user;
+	if(!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+		return 0;
+
+	//FILETIME is in 100ns units
+	uint64_t k = (static_cast<uint64_t>(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+	uint64_t u = (static_cast<uint64_t>(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+	return (k + u) * 0.1;
+#else
+	timespec t;
+	if(0 != clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t))
+		return 0;
+	return t.tv_sec * 1e6 + t.tv_nsec * 1e-3;
+#endif
+}
+
+/**
+	@brief Gets a small integer uniquely identifying the calling thread, for use as a trace viewer track ID
+ */
+size_t FilterProfiler::GetThreadIndex()
+{
+	static thread_local size_t index = SIZE_MAX;
+	if(index == SIZE_MAX)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		index = m_numThreads ++;
+	}
+	return index;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Trace log
+
+/**
+	@brief Records a refresh in the trace log, discarding the oldest event if the log is full
+ */
+void FilterProfiler::AddTraceEvent(Filter* f, const FilterRefreshProfile& profile)
+{
+	TraceEvent e;
+	e.m_name = f->GetDisplayName();
+	e.m_protocol = f->GetProtocolDisplayName();
+	e.m_profile = profile;
+
+	lock_guard<mutex> lock(m_mutex);
+	if(m_maxTraceEvents == 0)
+		return;
+	while(m_traceEvents.size() >= m_maxTraceEvents)
+		m_traceEvents.pop_front();
+	m_traceEvents.push_back(e);
+}
+
+/**
+	@brief Discards all events in the trace log
+ */
+void FilterProfiler::ClearTrace()
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_traceEvents.clear();
+}
+
+/**
+	@brief Sets the maximum number of events kept in the trace log (0 to disable tracing)
+ */
+void FilterProfiler::SetMaxTraceEvents(size_t n)
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_maxTraceEvents = n;
+	while(m_traceEvents.size() > m_maxTraceEvents)
+		m_traceEvents.pop_front();
+}
+
+/**
+	@brief Escapes a string for use in a JSON string literal
+ */
+static string JSONEscape(const string& str)
+{
+	string ret;
+	for(auto c : str)
+	{
+		switch(c)
+		{
+			case '\"':
+				ret += "\\\"";
+				break;
+
+			case '\\':
+				ret += "\\\\";
+				break;
+
+			default:
+				if(static_cast<unsigned char>(c) < 0x20)
+				{
+					char tmp[8];
+					snprintf(tmp, sizeof(tmp), "\\u%04x", c);
+					ret += tmp;
+				}
+				else
+					ret += c;
+				break;
+		}
+	}
+	return ret;
+}
+
+/**
+	@brief Writes the trace log to a file in Chrome trace event format (loadable in chrome://tracing or Perfetto)
+
+	@return True on success, false if the file couldn't be written
+ */
+bool FilterProfiler::WriteChromeTrace(const string& path)
+{
+	FILE* fp = fopen(path.c_str(), "w");
+	if(!fp)
+	{
+		LogError("Failed to open trace file \"%s\"\n", path.c_str());
+		return false;
+	}
+
+	lock_guard<mutex> lock(m_mutex);
+
+	fprintf(fp, "{\"traceEvents\":[\n");
+	bool first = true;
+	for(auto& e : m_traceEvents)
+	{
+		auto& p = e.m_profile;
+		if(!first)
+			fprintf(fp, ",\n");
+		first = false;
+
+		fprintf(fp,
+			"{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%zu,"
+			"\"args\":{\"cpu_us\":%.3f,\"input_samples\":%zu,\"output_samples\":%zu,\"output_bytes\":%zu,"
+			"\"allocated_bytes\":%zu}}",
+			JSONEscape(e.m_name).c_str(),
+			JSONEscape(e.m_protocol).c_str(),
+			p.m_start,
+			p.m_wallTime,
+			p.m_thread,
+			p.m_cpuTime,
+			p.m_inputSamples,
+			p.m_outputSamples,
+			p.m_outputBytes,
+			p.m_allocatedBytes);
+	}
+	fprintf(fp, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	bool ok = !ferror(fp);
+	fclose(fp);
+	return ok;
+}
@@ -0,0 +1,191 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* libscopehal v0.1                                                                                                     *
+*                                                                                                                      *
+* Copyright (c) 2012-2022 Andrew D. Zonenberg and contributors                                                         *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of FilterProfiler and related classes
+ */
+
+#ifndef FilterProfiler_h
+#define FilterProfiler_h
+
+#include <chrono>
+#include <deque>
+#include <mutex>
+
+class Filter;
+
+/**
+	@brief Measurements from a single call to Filter::Refresh()
+ */
+class FilterRefreshProfile
+{
+public:
+
+	///@brief Start time, in microseconds since FilterProfiler was initialized
+	double m_start;
+
+	///@brief Elapsed wall clock time, in microseconds
+	double m_wallTime;
+
+	/**
+		@brief CPU time used by the refreshing thread, in microseconds.
+
+		Time spent in OpenMP worker threads spawned by the filter is not included.
+	 */
+	double m_cpuTime;
+
+	///@brief Total number of samples in all input waveforms
+	size_t m_inputSamples;
+
+	///@brief Total number of samples in all output waveforms
+	size_t m_outputSamples;
+
+	/**
+		@brief Bytes of sample and timestamp storage held by all output waveforms after the refresh.
+
+		This is buffer capacity, not memory newly allocated during the refresh, so recycled buffers count in full. See
+		m_allocatedBytes for the latter.
+	 */
+	size_t m_outputBytes;
+
+	/**
+		@brief Bytes of sample storage the refreshing thread allocated through WaveformPool::Get() during the refresh.
+
+		Only waveforms the pool had to create count. Recycled buffers cost nothing, and growing a waveform with Resize()
+		beyond the capacity it was checked out with isn't tracked.
+	 */
+	size_t m_allocatedBytes;
+
+	///@brief Small integer identifying the thread the filter ran on
+	size_t m_thread;
+};
+
+/**
+	@brief Summary statistics for one metric over a filter's recent refreshes
+ */
+class FilterProfileStatistics
+{
+public:
+	FilterProfileStatistics()
+	: m_count(0)
+	, m_min(0)
+	, m_mean(0)
+	, m_max(0)
+	, m_p99(0)
+	{}
+
+	///@brief Number of refreshes the statistics were computed over
+	size_t m_count;
+
+	double m_min;
+	double m_mean;
+	double m_max;
+	double m_p99;
+};
+
+/**
+	@brief Global state for filter profiling: enable flag, timebase, and the trace event log
+ */
+class FilterProfiler
+{
+public:
+
+	/**
+		@brief Metrics which can be queried with Filter::GetProfileStatistics()
+	 */
+	enum Metric
+	{
+		METRIC_WALL_TIME,
+		METRIC_CPU_TIME,
+		METRIC_INPUT_SAMPLES,
+		METRIC_OUTPUT_SAMPLES,
+		METRIC_OUTPUT_BYTES,
+		METRIC_ALLOCATED_BYTES
+	};
+
+	///@brief Turns profiling of filter refreshes on or off. Profiling is off by default.
+	static void SetEnabled(bool enabled)
+	{ m_enabled = enabled; }
+
+	static bool IsEnabled()
+	{ return m_enabled; }
+
+	static double GetTimestamp();
+	static double GetThreadCPUTime();
+	static size_t GetThreadIndex();
+
+	static void AddTraceEvent(Filter* f, const FilterRefreshProfile& profile);
+	static void ClearTrace();
+	static bool WriteChromeTrace(const std::string& path);
+
+	static void SetMaxTraceEvents(size_t n);
+
+	static size_t GetMaxTraceEvents()
+	{ return m_maxTraceEvents; }
+
+	///@brief Number of refreshes each filter keeps for its statistics
+	static const size_t HISTORY_DEPTH = 1024;
+
+protected:
+
+	/**
+		@brief One entry in the trace event log.
+
+		Names are captured when the event is recorded since the filter may be deleted before the trace is written.
+	 */
+	class TraceEvent
+	{
+	public:
+		std::string m_name;
+		std::string m_protocol;
+		FilterRefreshProfile m_profile;
+	};
+
+	///@brief True if filters should be profiled
+	static bool m_enabled;
+
+	///@brief Time base for all timestamps
+	static std::chrono::steady_clock::time_point m_epoch;
+
+	///@brief Mutex protecting the trace log and thread table
+	static std::mutex m_mutex;
+
+	///@brief Recent refreshes of all filters, oldest first
+	static std::deque<TraceEvent> m_traceEvents;
+
+	///@brief Maximum number of events kept in m_traceEvents
+	static size_t m_maxTraceEvents;
+
+	///@brief Number of threads which have been given an index so far
+	static size_t m_numThreads;
+};
+
+#endif
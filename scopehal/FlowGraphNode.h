@@ -144,12 +144,24 @@ protected:
 
 	///Gets the analog waveform attached to the specified input
 	AnalogWaveform* GetAnalogInputWaveform(size_t i)
-	{ return dynamic_cast<AnalogWaveform*>(GetInputWaveform(i)); }
+	{ return GetAnalogWaveform(GetInputWaveform(i)); }
 
 	///Gets the digital waveform attached to the specified input
 	DigitalWaveform* GetDigitalInputWaveform(size_t i)
 	{ return dynamic_cast<DigitalWaveform*>(GetInputWaveform(i)); }
 
+	///Gets the uniformly sampled analog waveform attached to the specified input (converting raw ADC codes if needed)
+	UniformAnalogWaveform* GetUniformAnalogInputWaveform(size_t i)
+	{ return GetUniformAnalogWaveform(GetInputWaveform(i)); }
+
+	///Gets the uniformly sampled digital waveform attached to the specified input
+	UniformDigitalWaveform* GetUniformDigitalInputWaveform(size_t i)
+	{ return dynamic_cast<UniformDigitalWaveform*>(GetInputWaveform(i)); }
+
+	///Gets the bit-packed digital waveform attached to the specified input
+	PackedDigitalWaveform* GetPackedDigitalInputWaveform(size_t i)
+	{ return dynamic_cast<PackedDigitalWaveform*>(GetInputWaveform(i)); }
+
 	///Gets the digital bus waveform attached to the specified input
 	DigitalBusWaveform* GetDigitalBusInputWaveform(size_t i)
 	{ return dynamic_cast<DigitalBusWaveform*>(GetInputWaveform(i)); }
@@ -113,7 +113,7 @@ void ImportFilter::Refresh()
 	values accordingly, to enable dense packed optimizations and proper display of instrument timebase settings on
 	imported waveforms.
  */
-void ImportFilter::NormalizeTimebase(WaveformBase* wfm)
+void ImportFilter::NormalizeTimebase(SparseWaveformBase* wfm)
 {
 	//Find the mean sample interval
 	Unit fs(Unit::UNIT_FS);
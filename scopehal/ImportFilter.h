@@ -64,7 +64,7 @@ protected:
 	std::vector<float> m_ranges;
 	std::vector<float> m_offsets;
 
-	void NormalizeTimebase(WaveformBase* wfm);
+	void NormalizeTimebase(SparseWaveformBase* wfm);
 };
 
 #endif
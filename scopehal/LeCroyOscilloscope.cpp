@@ -44,6 +44,10 @@
 
 using namespace std;
 
+//Waveform data is converted this many bytes at a time as it downloads.
+//Small enough that the last chunk converts quickly once the download is done, big enough to keep overhead down.
+static const size_t WAVEFORM_CHUNK_SIZE = 1024 * 1024;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Construction / destruction
 
@@ -2271,6 +2275,69 @@ void LeCroyOscilloscope::BulkCheckChannelEnableState()
 	}*/
 }
 
+/**
+	@brief Fills the offset and voltage range caches for every analog channel with one pipelined burst of queries
+
+	Only settings missing from the cache are queried.
+ */
+void LeCroyOscilloscope::BulkCheckChannelSettings()
+{
+	//Need to lock the main mutex first to prevent deadlocks
+	lock_guard<recursive_mutex> lock(m_mutex);
+
+	//See what's missing
+	vector<size_t> uncachedOffsets;
+	vector<size_t> uncachedRanges;
+	{
+		lock_guard<recursive_mutex> lock2(m_cacheMutex);
+		for(size_t i=0; i<m_analogChannelCount; i++)
+		{
+			if(m_channelOffsets.find(i) == m_channelOffsets.end())
+				uncachedOffsets.push_back(i);
+			if(m_channelVoltageRanges.find(i) == m_channelVoltageRanges.end())
+				uncachedRanges.push_back(i);
+		}
+	}
+
+	//Queue up all of the queries, then send them back to back
+	vector< future<string> > offsetReplies;
+	vector< future<string> > rangeReplies;
+	for(auto i : uncachedOffsets)
+		offsetReplies.push_back(m_transport->SendCommandQueuedWithFutureReply(m_channels[i]->GetHwname() + ":OFFSET?"));
+	for(auto i : uncachedRanges)
+		rangeReplies.push_back(m_transport->SendCommandQueuedWithFutureReply(m_channels[i]->GetHwname() + ":VOLT_DIV?"));
+	m_transport->FlushCommandQueue();
+
+	//Anything without a usable reply is left out of the cache, so it gets queried again next time
+	lock_guard<recursive_mutex> lock2(m_cacheMutex);
+	for(size_t k=0; k<uncachedOffsets.size(); k++)
+	{
+		try
+		{
+			float offset;
+			if(1 == sscanf(offsetReplies[k].get().c_str(), "%f", &offset))
+				m_channelOffsets[uncachedOffsets[k]] = offset;
+		}
+		catch(const exception& e)
+		{
+			LogWarning("BulkCheckChannelSettings: %s\n", e.what());
+		}
+	}
+	for(size_t k=0; k<uncachedRanges.size(); k++)
+	{
+		try
+		{
+			double volts_per_div;
+			if(1 == sscanf(rangeReplies[k].get().c_str(), "%lf", &volts_per_div))
+				m_channelVoltageRanges[uncachedRanges[k]] = volts_per_div * 8;	//plot is 8 divisions high on all MAUI scopes
+		}
+		catch(const exception& e)
+		{
+			LogWarning("BulkCheckChannelSettings: %s\n", e.what());
+		}
+	}
+}
+
 bool LeCroyOscilloscope::ReadWavedescs(
 	vector<string>& wavedescs,
 	bool* enabled,
@@ -2399,8 +2466,12 @@ time_t LeCroyOscilloscope::ExtractTimestamp(unsigned char* wavedesc, double& bas
 	return mktime(&tstruc);
 }
 
-vector<WaveformBase*> LeCroyOscilloscope::ProcessAnalogWaveform(
-	const char* data,
+/**
+	@brief Sets up the waveforms for one channel's analog data, ready to be converted into
+
+	@param datalen	Size of the raw sample block, in bytes
+ */
+vector<WaveformBase*> LeCroyOscilloscope::AllocateAnalogWaveforms(
 	size_t datalen,
 	string& wavedesc,
 	uint32_t num_sequences,
@@ -2414,12 +2485,6 @@ vector<WaveformBase*> LeCroyOscilloscope::ProcessAnalogWaveform(
 	auto pdesc = (unsigned char*)(&wavedesc[0]);
 	//uint32_t wavedesc_len = *reinterpret_cast<uint32_t*>(pdesc + 36);
 
-	//cppcheck-suppress invalidPointerCast
-	float v_gain = *reinterpret_cast<float*>(pdesc + 156);
-
-	//cppcheck-suppress invalidPointerCast
-	float v_off = *reinterpret_cast<float*>(pdesc + 160);
-
 	//cppcheck-suppress invalidPointerCast
 	float interval = *reinterpret_cast<float*>(pdesc + 176) * FS_PER_SECOND;
 
@@ -2437,13 +2502,11 @@ vector<WaveformBase*> LeCroyOscilloscope::ProcessAnalogWaveform(
 	else
 		num_samples = datalen;
 	size_t num_per_segment = num_samples / num_sequences;
-	int16_t* wdata = (int16_t*)&data[0];
-	int8_t* bdata = (int8_t*)&data[0];
 
 	for(size_t j=0; j<num_sequences; j++)
 	{
 		//Set up the capture we're going to store our data into
-		AnalogWaveform* cap = new AnalogWaveform;
+		AnalogWaveform* cap = WaveformPool::Get<AnalogWaveform>(num_per_segment);
 		cap->m_timescale = round(interval);
 
 		cap->m_triggerPhase = h_off_frac;
@@ -2458,38 +2521,64 @@ vector<WaveformBase*> LeCroyOscilloscope::ProcessAnalogWaveform(
 
 		cap->Resize(num_per_segment);
 
-		//Convert raw ADC samples to volts
-		if(m_highDefinition)
-		{
-			Convert16BitSamples(
-				(int64_t*)&cap->m_offsets[0],
-				(int64_t*)&cap->m_durations[0],
-				(float*)&cap->m_samples[0],
-				wdata + j*num_per_segment,
-				v_gain,
-				v_off,
-				num_per_segment,
-				0);
-		}
-		else
-		{
-			Convert8BitSamples(
-				(int64_t*)&cap->m_offsets[0],
-				(int64_t*)&cap->m_durations[0],
-				(float*)&cap->m_samples[0],
-				bdata + j*num_per_segment,
-				v_gain,
-				v_off,
-				num_per_segment,
-				0);
-		}
-
 		ret.push_back(cap);
 	}
 
 	return ret;
 }
 
+/**
+	@brief Downloads one channel's analog data block, converting it to volts as it arrives
+
+	@param buf		Receive buffer for the raw samples
+	@param ret		Set to the converted waveform(s), one per segment. Empty on failure.
+
+	@return True on success
+ */
+bool LeCroyOscilloscope::DownloadAnalogWaveform(
+	SCPITransport::BlockBuffer& buf,
+	string& wavedesc,
+	uint32_t num_sequences,
+	time_t ttime,
+	double basetime,
+	double* wavetime,
+	vector<WaveformBase*>& ret)
+{
+	size_t len;
+	if(!m_transport->ReadBlockHeader(len))
+		return false;
+	buf.resize(len);
+
+	ret = AllocateAnalogWaveforms(len, wavedesc, num_sequences, ttime, basetime, wavetime);
+
+	auto pdesc = (unsigned char*)(&wavedesc[0]);
+
+	//cppcheck-suppress invalidPointerCast
+	float v_gain = *reinterpret_cast<float*>(pdesc + 156);
+
+	//cppcheck-suppress invalidPointerCast
+	float v_off = *reinterpret_cast<float*>(pdesc + 160);
+
+	//Convert raw ADC samples to volts a chunk at a time while the rest downloads
+	bool ok = m_transport->ReadRawDataStreaming(
+		len,
+		buf.data(),
+		WAVEFORM_CHUNK_SIZE,
+		[&](size_t start, size_t end)
+		{ ConvertSegmentedSamples(ret, buf.data(), start, end, m_highDefinition, v_gain, v_off); });
+
+	if(!ok)
+	{
+		for(auto w : ret)
+			WaveformPool::Return(w);
+		ret.clear();
+		return false;
+	}
+
+	m_transport->DiscardReplyRemainder();
+	return true;
+}
+
 map<int, DigitalWaveform*> LeCroyOscilloscope::ProcessDigitalWaveform(string& data, int64_t analog_hoff)
 {
 	map<int, DigitalWaveform*> ret;
@@ -2575,7 +2664,7 @@ map<int, DigitalWaveform*> LeCroyOscilloscope::ProcessDigitalWaveform(string& da
 	{
 		if(enabledChannels[i])
 		{
-			DigitalWaveform* cap = new DigitalWaveform;
+			DigitalWaveform* cap = WaveformPool::Get<DigitalWaveform>(num_samples);
 			cap->m_timescale = interval;
 			cap->m_densePacked = false;
 
@@ -2619,11 +2708,9 @@ map<int, DigitalWaveform*> LeCroyOscilloscope::ProcessDigitalWaveform(string& da
 
 			}
 
-			//Done, shrink any unused space
+			//Done, trim to the deduplicated length.
+			//Don't shrink_to_fit, the buffer goes back to the waveform pool and will be reused at full size.
 			cap->Resize(k);
-			cap->m_offsets.shrink_to_fit();
-			cap->m_durations.shrink_to_fit();
-			cap->m_samples.shrink_to_fit();
 
 			//See how much space we saved
 			/*
@@ -2656,12 +2743,13 @@ bool LeCroyOscilloscope::AcquireData()
 	time_t ttime = 0;
 	double basetime = 0;
 	bool denabled = false;
-	map<int, string> analogWaveformData;
 	string wavetime;
 	bool enabled[8] = {false};
 	vector<string> wavedescs;
 	double* pwtime = NULL;
 	string digitalWaveformData;
+	vector< vector<WaveformBase*> > waveforms;
+	waveforms.resize(m_analogChannelCount);
 
 	//Acquire the data (but don't parse it)
 	{
@@ -2732,11 +2820,25 @@ bool LeCroyOscilloscope::AcquireData()
 				wavetime = m_transport->ReadReply();
 			pwtime = reinterpret_cast<double*>(&wavetime[16]);	//skip 16-byte SCPI header
 
-			//Read the data from each analog waveform
+			//Read the data from each analog waveform straight into its receive buffer (reused from last time).
+			//Each chunk is converted on a worker thread while the next one is still on the wire.
+			m_analogWaveformData.resize(m_analogChannelCount);
 			for(unsigned int i=0; i<m_analogChannelCount; i++)
 			{
-				if(enabled[i])
-					analogWaveformData[i] = m_transport->ReadReply();
+				if(!enabled[i])
+					continue;
+
+				if(!DownloadAnalogWaveform(
+					m_analogWaveformData[i], wavedescs[i], num_sequences, ttime, basetime, pwtime, waveforms[i]))
+				{
+					LogError("failed to download analog waveform\n");
+					for(auto& w : waveforms)
+					{
+						for(auto p : w)
+							WaveformPool::Return(p);
+					}
+					return false;
+				}
 			}
 		}
 
@@ -2763,26 +2865,14 @@ bool LeCroyOscilloscope::AcquireData()
 	//Offset from start of waveform to trigger
 	double analog_hoff = 0;
 
-	//Process analog waveforms
-	vector< vector<WaveformBase*> > waveforms;
-	waveforms.resize(m_analogChannelCount);
+	//Analog waveforms were converted as they came in, just extract the timestamp
 	for(unsigned int i=0; i<m_analogChannelCount; i++)
 	{
 		if(enabled[i])
 		{
-			//Extract timestamp of waveform
 			auto pdesc = (unsigned char*)(&wavedescs[i][0]);
 			//cppcheck-suppress invalidPointerCast
 			analog_hoff = *reinterpret_cast<double*>(pdesc + 180) * FS_PER_SECOND;
-
-			waveforms[i] = ProcessAnalogWaveform(
-				&analogWaveformData[i][16],			//skip 16-byte SCPI header DATA,\n#9xxxxxxxx
-				analogWaveformData[i].size() - 17,	//skip header plus \n at end
-				wavedescs[i],
-				num_sequences,
-				ttime,
-				basetime,
-				pwtime);
 		}
 	}
 
@@ -2869,7 +2959,7 @@ void LeCroyOscilloscope::ForceTrigger()
 float LeCroyOscilloscope::GetChannelOffset(size_t i, size_t /*stream*/)
 {
 	//not meaningful for trigger or digital channels
-	if(i > m_analogChannelCount)
+	if(i >= m_analogChannelCount)
 		return 0;
 
 	{
@@ -2879,17 +2969,11 @@ float LeCroyOscilloscope::GetChannelOffset(size_t i, size_t /*stream*/)
 			return m_channelOffsets[i];
 	}
 
-	lock_guard<recursive_mutex> lock2(m_mutex);
-
-	m_transport->SendCommand(m_channels[i]->GetHwname() + ":OFFSET?");
-
-	string reply = m_transport->ReadReply();
-	float offset;
-	sscanf(reply.c_str(), "%f", &offset);
+	//Not in cache, fetch it (and everything else that's missing) in one go
+	BulkCheckChannelSettings();
 
 	lock_guard<recursive_mutex> lock(m_cacheMutex);
-	m_channelOffsets[i] = offset;
-	return offset;
+	return m_channelOffsets[i];
 }
 
 void LeCroyOscilloscope::SetChannelOffset(size_t i, size_t /*stream*/, float offset)
@@ -2912,7 +2996,7 @@ void LeCroyOscilloscope::SetChannelOffset(size_t i, size_t /*stream*/, float off
 float LeCroyOscilloscope::GetChannelVoltageRange(size_t i, size_t /*stream*/)
 {
 	//not meaningful for trigger or digital channels
-	if(i > m_analogChannelCount)
+	if(i >= m_analogChannelCount)
 		return 1;
 
 	{
@@ -2921,18 +3005,11 @@ float LeCroyOscilloscope::GetChannelVoltageRange(size_t i, size_t /*stream*/)
 			return m_channelVoltageRanges[i];
 	}
 
-	lock_guard<recursive_mutex> lock2(m_mutex);
-
-	m_transport->SendCommand(m_channels[i]->GetHwname() + ":VOLT_DIV?");
-
-	string reply = m_transport->ReadReply();
-	double volts_per_div;
-	sscanf(reply.c_str(), "%lf", &volts_per_div);
+	//Not in cache, fetch it (and everything else that's missing) in one go
+	BulkCheckChannelSettings();
 
-	double v = volts_per_div * 8;	//plot is 8 divisions high on all MAUI scopes
 	lock_guard<recursive_mutex> lock(m_cacheMutex);
-	m_channelVoltageRanges[i] = v;
-	return v;
+	return m_channelVoltageRanges[i];
 }
 
 void LeCroyOscilloscope::SetChannelVoltageRange(size_t i, size_t /*stream*/, float range)
@@ -270,6 +270,7 @@ protected:
 	void PushWindowTrigger(WindowTrigger* trig);
 
 	void BulkCheckChannelEnableState();
+	void BulkCheckChannelSettings();
 
 	std::string GetPossiblyEmptyString(const std::string& property);
 
@@ -281,8 +282,7 @@ protected:
 		bool& any_enabled);
 	void RequestWaveforms(bool* enabled, uint32_t num_sequences, bool denabled);
 	time_t ExtractTimestamp(unsigned char* wavedesc, double& basetime);
-	std::vector<WaveformBase*> ProcessAnalogWaveform(
-		const char* data,
+	std::vector<WaveformBase*> AllocateAnalogWaveforms(
 		size_t datalen,
 		std::string& wavedesc,
 		uint32_t num_sequences,
@@ -290,6 +290,15 @@ protected:
 		double basetime,
 		double* wavetime
 		);
+	bool DownloadAnalogWaveform(
+		SCPITransport::BlockBuffer& buf,
+		std::string& wavedesc,
+		uint32_t num_sequences,
+		time_t ttime,
+		double basetime,
+		double* wavetime,
+		std::vector<WaveformBase*>& ret
+		);
 	std::map<int, DigitalWaveform*> ProcessDigitalWaveform(std::string& data, int64_t analog_hoff);
 
 	//hardware analog channel count, independent of LA option etc
@@ -336,6 +345,9 @@ protected:
 	//True if we have >8 bit capture depth
 	bool m_highDefinition;
 
+	//Raw sample data for each analog channel, kept from one acquisition to the next to avoid reallocating
+	std::vector<SCPITransport::BlockBuffer> m_analogWaveformData;
+
 	//External trigger input
 	OscilloscopeChannel* m_extTrigChannel;
 	std::vector<OscilloscopeChannel*> m_digitalChannels;
@@ -0,0 +1,113 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* libscopehal v0.1                                                                                                     *
+*                                                                                                                      *
+* Copyright (c) 2012-2022 Andrew D. Zonenberg and contributors                                                         *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of MPSCQueue
+ */
+
+#ifndef MPSCQueue_h
+#define MPSCQueue_h
+
+#include <atomic>
+
+/**
+	@brief Lock-free unbounded queue with any number of producers and a single consumer
+
+	Push() may be called from any thread at any time. Pop() must only ever be called by one thread at a time (the
+	caller is responsible for this, e.g. by only popping while holding some other lock).
+
+	This is Dmitry Vyukov's intrusive-free MPSC queue: producers swap themselves in at the head with one atomic
+	exchange, and the consumer walks the list from the tail. A Pop() racing a Push() that hasn't finished linking its
+	node may return false even though the queue isn't empty, so callers should retry rather than assume it's empty.
+ */
+template<class T>
+class MPSCQueue
+{
+public:
+	MPSCQueue()
+	{
+		m_tail = new Node;
+		m_head.store(m_tail);
+	}
+
+	~MPSCQueue()
+	{
+		T tmp;
+		while(Pop(tmp))
+		{}
+		delete m_tail;
+	}
+
+	MPSCQueue(const MPSCQueue&) =delete;
+	MPSCQueue& operator=(const MPSCQueue&) =delete;
+
+	void Push(T value)
+	{
+		Node* node = new Node;
+		node->m_value = std::move(value);
+
+		Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+		prev->m_next.store(node, std::memory_order_release);
+	}
+
+	bool Pop(T& value)
+	{
+		Node* tail = m_tail;
+		Node* next = tail->m_next.load(std::memory_order_acquire);
+		if(next == NULL)
+			return false;
+
+		//The old tail is a dummy, next becomes the new dummy once we've taken its value
+		value = std::move(next->m_value);
+		m_tail = next;
+		delete tail;
+		return true;
+	}
+
+protected:
+	struct Node
+	{
+		Node()
+		: m_next(NULL)
+		{}
+
+		std::atomic<Node*> m_next;
+		T m_value;
+	};
+
+	///@brief Most recently pushed node
+	std::atomic<Node*> m_head;
+
+	///@brief Dummy node preceding the oldest unpopped node, only touched by the consumer
+	Node* m_tail;
+};
+
+#endif
@@ -456,7 +456,7 @@ bool MockOscilloscope::LoadBIN(const string& path)
 		chan->SetDefaultDisplayName();
 
 		//Create new waveform for channel
-		auto wfm = new AnalogWaveform;
+		auto wfm = WaveformPool::Get<AnalogWaveform>();
 		wfm->m_timescale = wh.interval * 1e15;
 		wfm->m_startTimestamp = 0;
 		wfm->m_startFemtoseconds = 0;
@@ -57,6 +57,8 @@ Oscilloscope::CreateMapType Oscilloscope::m_createprocs;
 Oscilloscope::Oscilloscope()
 {
 	m_trigger = NULL;
+	m_deferSampleConversion = false;
+	m_uniformAnalogWaveforms = false;
 }
 
 Oscilloscope::~Oscilloscope()
@@ -75,7 +77,7 @@ Oscilloscope::~Oscilloscope()
 	for(auto set : m_pendingWaveforms)
 	{
 		for(auto it : set)
-			delete it.second;
+			WaveformPool::Return(it.second);
 	}
 	m_pendingWaveforms.clear();
 }
@@ -194,26 +196,37 @@ void Oscilloscope::ClearPendingWaveforms()
 	{
 		SequenceSet set = *m_pendingWaveforms.begin();
 		for(auto it : set)
-			delete it.second;
+			WaveformPool::Return(it.second);
 		m_pendingWaveforms.pop_front();
 	}
 }
 
 /**
-	@brief Pops the queue of pending waveforms and updates each channel with a new waveform
+	@brief Moves the oldest pending set of waveforms into our channels.
+
+	Filters that depend on the channels that got new data are marked dirty. Nothing else in the filter graph is touched.
+
+	@return True if a waveform was popped, false if there were none pending
  */
 bool Oscilloscope::PopPendingWaveform()
 {
-	lock_guard<mutex> lock(m_pendingWaveformsMutex);
-	if(m_pendingWaveforms.size())
+	set<StreamDescriptor> streams;
 	{
+		lock_guard<mutex> lock(m_pendingWaveformsMutex);
+		if(m_pendingWaveforms.empty())
+			return false;
+
 		SequenceSet set = *m_pendingWaveforms.begin();
 		for(auto it : set)
+		{
 			it.first.m_channel->SetData(it.second, it.first.m_stream);
+			streams.emplace(it.first);
+		}
 		m_pendingWaveforms.pop_front();
-		return true;
 	}
-	return false;
+
+	Filter::SetDirtyDownstreamOf(streams);
+	return true;
 }
 
 
@@ -765,6 +778,60 @@ bool Oscilloscope::HasFrequencyControls()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Helpers for converting raw 8-bit ADC samples to fp32 waveforms
 
+/**
+	@brief Decides whether the AVX-512 conversion kernels should use non-temporal stores
+
+	Converting a deep capture is limited by memory bandwidth. Streaming the outputs straight to memory avoids reading
+	each destination cache line in before overwriting it, which nearly doubles throughput. It also bypasses the cache,
+	which would hurt whoever reads a short waveform next, so we only do it when the output is far bigger than the cache
+	anyway. Non-temporal stores need 64-byte alignment.
+ */
+static bool UseStreamingStores(int64_t* offs, int64_t* durs, float* pout, size_t count)
+{
+	if(count < 256*1024)
+		return false;
+
+	uintptr_t addrs = reinterpret_cast<uintptr_t>(offs) | reinterpret_cast<uintptr_t>(durs) | reinterpret_cast<uintptr_t>(pout);
+	return (addrs & 63) == 0;
+}
+
+__attribute__((target("avx512f")))
+static inline void StoreAVX512(int64_t* p, __m512i v, bool stream)
+{
+	if(stream)
+		_mm512_stream_si512(reinterpret_cast<__m512i*>(p), v);
+	else
+		_mm512_storeu_si512(p, v);
+}
+
+__attribute__((target("avx512f")))
+static inline void StoreAVX512(float* p, __m512 v, bool stream)
+{
+	if(stream)
+		_mm512_stream_ps(p, v);
+	else
+		_mm512_storeu_ps(p, v);
+}
+
+/*
+	Widening conversions to fp32 for the AVX-512 kernels.
+
+	The unmasked _mm512_cvtepi*_epi32() / _mm512_cvtepi32_ps() intrinsics pass an "undefined" vector as the merge
+	source, which GCC 12 flags with -Wmaybe-uninitialized at every call site. The zero-masked forms with every lane
+	enabled compile to the same instructions without the warning.
+ */
+__attribute__((target("avx512f")))
+static inline __m512 ConvertInt8ToFloatAVX512(__m128i v)
+{ return _mm512_maskz_cvtepi32_ps(0xffff, _mm512_maskz_cvtepi8_epi32(0xffff, v)); }
+
+__attribute__((target("avx512f")))
+static inline __m512 ConvertUint8ToFloatAVX512(__m128i v)
+{ return _mm512_maskz_cvtepi32_ps(0xffff, _mm512_maskz_cvtepu8_epi32(0xffff, v)); }
+
+__attribute__((target("avx512f")))
+static inline __m512 ConvertInt16ToFloatAVX512(__m256i v)
+{ return _mm512_maskz_cvtepi32_ps(0xffff, _mm512_maskz_cvtepi16_epi32(0xffff, v)); }
+
 /**
 	@brief Converts 8-bit ADC samples to floating point
  */
@@ -775,11 +842,11 @@ void Oscilloscope::Convert8BitSamples(
 	//TODO: tune split
 	if(count > 1000000)
 	{
-		//Round blocks to multiples of 32 samples for clean vectorization
+		//Round blocks to multiples of 64 samples for clean vectorization
 		size_t numblocks = omp_get_max_threads();
 		size_t lastblock = numblocks - 1;
 		size_t blocksize = count / numblocks;
-		blocksize = blocksize - (blocksize % 32);
+		blocksize = blocksize - (blocksize % 64);
 
 		#pragma omp parallel for
 		for(size_t i=0; i<numblocks; i++)
@@ -790,7 +857,19 @@ void Oscilloscope::Convert8BitSamples(
 				nsamp = count - i*blocksize;
 
 			size_t off = i*blocksize;
-			if(g_hasAvx2)
+			if(g_hasAvx512F)
+			{
+				Convert8BitSamplesAVX512F(
+					offs + off,
+					durs + off,
+					pout + off,
+					pin + off,
+					gain,
+					offset,
+					nsamp,
+					ibase + off);
+			}
+			else if(g_hasAvx2)
 			{
 				Convert8BitSamplesAVX2(
 					offs + off,
@@ -820,7 +899,9 @@ void Oscilloscope::Convert8BitSamples(
 	//Small waveforms get done single threaded to avoid overhead
 	else
 	{
-		if(g_hasAvx2)
+		if(g_hasAvx512F)
+			Convert8BitSamplesAVX512F(offs, durs, pout, pin, gain, offset, count, ibase);
+		else if(g_hasAvx2)
 			Convert8BitSamplesAVX2(offs, durs, pout, pin, gain, offset, count, ibase);
 		else
 			Convert8BitSamplesGeneric(offs, durs, pout, pin, gain, offset, count, ibase);
@@ -950,6 +1031,72 @@ void Oscilloscope::Convert8BitSamplesAVX2(
 	}
 }
 
+/**
+	@brief AVX-512 version of Convert8BitSamples(), converting 64 samples per iteration
+ */
+__attribute__((target("avx512f")))
+void Oscilloscope::Convert8BitSamplesAVX512F(
+	int64_t* offs, int64_t* durs, float* pout, int8_t* pin, float gain, float offset, size_t count, int64_t ibase)
+{
+	size_t end = count - (count % 64);
+
+	__m512i all_ones	= _mm512_set1_epi64(1);
+	__m512i all_eights	= _mm512_set1_epi64(8);
+	__m512i counts		= _mm512_add_epi64(_mm512_set1_epi64(ibase), _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0));
+
+	__m512 gains = _mm512_set1_ps(gain);
+	__m512 offsets = _mm512_set1_ps(offset);
+
+	bool stream = UseStreamingStores(offs, durs, pout, count);
+
+	for(size_t k=0; k<end; k += 64)
+	{
+		//Load all 64 raw ADC samples, in blocks of 16
+		__m128i block0_x16 = _mm_loadu_si128(reinterpret_cast<__m128i*>(pin + k));
+		__m128i block1_x16 = _mm_loadu_si128(reinterpret_cast<__m128i*>(pin + k + 16));
+		__m128i block2_x16 = _mm_loadu_si128(reinterpret_cast<__m128i*>(pin + k + 32));
+		__m128i block3_x16 = _mm_loadu_si128(reinterpret_cast<__m128i*>(pin + k + 48));
+
+		//Fill duration and offset, 8 samples per store
+		for(size_t j=0; j<64; j += 8)
+		{
+			StoreAVX512(durs + k + j, all_ones, stream);
+			StoreAVX512(offs + k + j, counts, stream);
+			counts = _mm512_add_epi64(counts, all_eights);
+		}
+
+		//Sign extend each block to 32 bit, then convert to fp32
+		__m512 block0_float = ConvertInt8ToFloatAVX512(block0_x16);
+		__m512 block1_float = ConvertInt8ToFloatAVX512(block1_x16);
+		__m512 block2_float = ConvertInt8ToFloatAVX512(block2_x16);
+		__m512 block3_float = ConvertInt8ToFloatAVX512(block3_x16);
+
+		//Scale and offset
+		block0_float = _mm512_fmsub_ps(block0_float, gains, offsets);
+		block1_float = _mm512_fmsub_ps(block1_float, gains, offsets);
+		block2_float = _mm512_fmsub_ps(block2_float, gains, offsets);
+		block3_float = _mm512_fmsub_ps(block3_float, gains, offsets);
+
+		//All done, store back to the output buffer
+		StoreAVX512(pout + k,		block0_float, stream);
+		StoreAVX512(pout + k + 16,	block1_float, stream);
+		StoreAVX512(pout + k + 32,	block2_float, stream);
+		StoreAVX512(pout + k + 48,	block3_float, stream);
+	}
+
+	//Make sure streaming stores are visible before anyone else looks at the waveform
+	if(stream)
+		_mm_sfence();
+
+	//Get any extras we didn't get in the SIMD loop
+	for(size_t k=end; k<count; k++)
+	{
+		offs[k] = ibase + k;
+		durs[k] = 1;
+		pout[k] = pin[k] * gain - offset;
+	}
+}
+
 /**
 	@brief Converts Unsigned 8-bit ADC samples to floating point
  */
@@ -960,11 +1107,11 @@ void Oscilloscope::ConvertUnsigned8BitSamples(
 	//TODO: tune split
 	if(count > 1000000)
 	{
-		//Round blocks to multiples of 32 samples for clean vectorization
+		//Round blocks to multiples of 64 samples for clean vectorization
 		size_t numblocks = omp_get_max_threads();
 		size_t lastblock = numblocks - 1;
 		size_t blocksize = count / numblocks;
-		blocksize = blocksize - (blocksize % 32);
+		blocksize = blocksize - (blocksize % 64);
 
 		#pragma omp parallel for
 		for(size_t i=0; i<numblocks; i++)
@@ -975,7 +1122,19 @@ void Oscilloscope::ConvertUnsigned8BitSamples(
 				nsamp = count - i*blocksize;
 
 			size_t off = i*blocksize;
-			if(g_hasAvx2)
+			if(g_hasAvx512F)
+			{
+				ConvertUnsigned8BitSamplesAVX512F(
+					offs + off,
+					durs + off,
+					pout + off,
+					pin + off,
+					gain,
+					offset,
+					nsamp,
+					ibase + off);
+			}
+			else if(g_hasAvx2)
 			{
 				ConvertUnsigned8BitSamplesAVX2(
 					offs + off,
@@ -1005,7 +1164,9 @@ void Oscilloscope::ConvertUnsigned8BitSamples(
 	//Small waveforms get done single threaded to avoid overhead
 	else
 	{
-		if(g_hasAvx2)
+		if(g_hasAvx512F)
+			ConvertUnsigned8BitSamplesAVX512F(offs, durs, pout, pin, gain, offset, count, ibase);
+		else if(g_hasAvx2)
 			ConvertUnsigned8BitSamplesAVX2(offs, durs, pout, pin, gain, offset, count, ibase);
 		else
 			ConvertUnsigned8BitSamplesGeneric(offs, durs, pout, pin, gain, offset, count, ibase);
@@ -1135,6 +1296,72 @@ void Oscilloscope::ConvertUnsigned8BitSamplesAVX2(
 	}
 }
 
+/**
+	@brief AVX-512 version of ConvertUnsigned8BitSamples(), converting 64 samples per iteration
+ */
+__attribute__((target("avx512f")))
+void Oscilloscope::ConvertUnsigned8BitSamplesAVX512F(
+	int64_t* offs, int64_t* durs, float* pout, uint8_t* pin, float gain, float offset, size_t count, int64_t ibase)
+{
+	size_t end = count - (count % 64);
+
+	__m512i all_ones	= _mm512_set1_epi64(1);
+	__m512i all_eights	= _mm512_set1_epi64(8);
+	__m512i counts		= _mm512_add_epi64(_mm512_set1_epi64(ibase), _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0));
+
+	__m512 gains = _mm512_set1_ps(gain);
+	__m512 offsets = _mm512_set1_ps(offset);
+
+	bool stream = UseStreamingStores(offs, durs, pout, count);
+
+	for(size_t k=0; k<end; k += 64)
+	{
+		//Load all 64 raw ADC samples, in blocks of 16
+		__m128i block0_x16 = _mm_loadu_si128(reinterpret_cast<__m128i*>(pin + k));
+		__m128i block1_x16 = _mm_loadu_si128(reinterpret_cast<__m128i*>(pin + k + 16));
+		__m128i block2_x16 = _mm_loadu_si128(reinterpret_cast<__m128i*>(pin + k + 32));
+		__m128i block3_x16 = _mm_loadu_si128(reinterpret_cast<__m128i*>(pin + k + 48));
+
+		//Fill duration and offset, 8 samples per store
+		for(size_t j=0; j<64; j += 8)
+		{
+			StoreAVX512(durs + k + j, all_ones, stream);
+			StoreAVX512(offs + k + j, counts, stream);
+			counts = _mm512_add_epi64(counts, all_eights);
+		}
+
+		//Zero extend each block to 32 bit, then convert to fp32
+		__m512 block0_float = ConvertUint8ToFloatAVX512(block0_x16);
+		__m512 block1_float = ConvertUint8ToFloatAVX512(block1_x16);
+		__m512 block2_float = ConvertUint8ToFloatAVX512(block2_x16);
+		__m512 block3_float = ConvertUint8ToFloatAVX512(block3_x16);
+
+		//Scale and offset
+		block0_float = _mm512_fmsub_ps(block0_float, gains, offsets);
+		block1_float = _mm512_fmsub_ps(block1_float, gains, offsets);
+		block2_float = _mm512_fmsub_ps(block2_float, gains, offsets);
+		block3_float = _mm512_fmsub_ps(block3_float, gains, offsets);
+
+		//All done, store back to the output buffer
+		StoreAVX512(pout + k,		block0_float, stream);
+		StoreAVX512(pout + k + 16,	block1_float, stream);
+		StoreAVX512(pout + k + 32,	block2_float, stream);
+		StoreAVX512(pout + k + 48,	block3_float, stream);
+	}
+
+	//Make sure streaming stores are visible before anyone else looks at the waveform
+	if(stream)
+		_mm_sfence();
+
+	//Get any extras we didn't get in the SIMD loop
+	for(size_t k=end; k<count; k++)
+	{
+		offs[k] = ibase + k;
+		durs[k] = 1;
+		pout[k] = pin[k] * gain - offset;
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Helpers for converting raw 16-bit ADC samples to fp32 waveforms
 
@@ -1148,11 +1375,11 @@ void Oscilloscope::Convert16BitSamples(
 	//TODO: tune split
 	if(count > 1000000)
 	{
-		//Round blocks to multiples of 32 samples for clean vectorization
+		//Round blocks to multiples of 64 samples for clean vectorization
 		size_t numblocks = omp_get_max_threads();
 		size_t lastblock = numblocks - 1;
 		size_t blocksize = count / numblocks;
-		blocksize = blocksize - (blocksize % 32);
+		blocksize = blocksize - (blocksize % 64);
 
 		#pragma omp parallel for
 		for(size_t i=0; i<numblocks; i++)
@@ -1163,7 +1390,19 @@ void Oscilloscope::Convert16BitSamples(
 				nsamp = count - i*blocksize;
 
 			size_t off = i*blocksize;
-			if(g_hasAvx2)
+			if(g_hasAvx512F)
+			{
+				Convert16BitSamplesAVX512F(
+					offs + off,
+					durs + off,
+					pout + off,
+					pin + off,
+					gain,
+					offset,
+					nsamp,
+					ibase + off);
+			}
+			else if(g_hasAvx2)
 			{
 				if(g_hasFMA)
 				{
@@ -1208,7 +1447,9 @@ void Oscilloscope::Convert16BitSamples(
 	//Small waveforms get done single threaded to avoid overhead
 	else
 	{
-		if(g_hasAvx2)
+		if(g_hasAvx512F)
+			Convert16BitSamplesAVX512F(offs, durs, pout, pin, gain, offset, count, ibase);
+		else if(g_hasAvx2)
 		{
 			if(g_hasFMA)
 				Convert16BitSamplesFMA(offs, durs, pout, pin, gain, offset, count, ibase);
@@ -1220,6 +1461,97 @@ void Oscilloscope::Convert16BitSamples(
 	}
 }
 
+/**
+	@brief Converts 16-bit ADC samples to floating point, for a UniformAnalogWaveform (no timestamps to fill out)
+ */
+void Oscilloscope::ConvertUniform16BitSamples(float* pout, int16_t* pin, float gain, float offset, size_t count)
+{
+	//Without timestamps this is a simple enough loop that the compiler vectorizes it just fine.
+	//Same split as Convert16BitSamples() for large waveforms.
+	size_t numblocks = 1;
+	if(count > 1000000)
+		numblocks = omp_get_max_threads();
+	size_t blocksize = count / numblocks;
+	blocksize = blocksize - (blocksize % 64);
+
+	#pragma omp parallel for if(numblocks > 1)
+	for(size_t i=0; i<numblocks; i++)
+	{
+		size_t start = i*blocksize;
+		size_t end = (i == numblocks-1) ? count : start + blocksize;
+		for(size_t k=start; k<end; k++)
+			pout[k] = pin[k] * gain - offset;
+	}
+}
+
+/**
+	@brief Converts part of a raw sample block into a set of equal-length AnalogWaveform segments
+
+	Converts bytes [start, end) of a block of signed 8- or 16-bit samples. Lets drivers convert a block a chunk at a
+	time as it comes in, see SCPITransport::ReadRawDataStreaming(). start and end must be on sample boundaries.
+	Samples past the end of the last segment are ignored.
+
+	@param segments		Waveforms to convert into, already resized to the segment length
+	@param data			Start of the raw sample block (not the start of the range)
+	@param start		Offset of the first byte to convert
+	@param end			Offset of the byte after the last one to convert
+	@param sixteenBit	True for 16-bit samples, false for 8-bit
+	@param gain			Volts per LSB
+	@param offset		Offset subtracted from the scaled sample to get volts
+ */
+void Oscilloscope::ConvertSegmentedSamples(
+	vector<WaveformBase*>& segments,
+	const unsigned char* data,
+	size_t start,
+	size_t end,
+	bool sixteenBit,
+	float gain,
+	float offset)
+{
+	size_t bytesPerSample = sixteenBit ? 2 : 1;
+	size_t first = start / bytesPerSample;
+	size_t last = end / bytesPerSample;
+
+	for(size_t j=0; j<segments.size(); j++)
+	{
+		auto cap = static_cast<AnalogWaveform*>(segments[j]);
+		size_t seglen = cap->m_samples.size();
+		size_t segstart = j*seglen;
+
+		//Part of the range that lands in this segment
+		size_t from = max(first, segstart);
+		size_t to = min(last, segstart + seglen);
+		if(from >= to)
+			continue;
+		size_t i = from - segstart;
+
+		if(sixteenBit)
+		{
+			Convert16BitSamples(
+				(int64_t*)&cap->m_offsets[i],
+				(int64_t*)&cap->m_durations[i],
+				(float*)&cap->m_samples[i],
+				(int16_t*)data + from,
+				gain,
+				offset,
+				to - from,
+				i);
+		}
+		else
+		{
+			Convert8BitSamples(
+				(int64_t*)&cap->m_offsets[i],
+				(int64_t*)&cap->m_durations[i],
+				(float*)&cap->m_samples[i],
+				(int8_t*)data + from,
+				gain,
+				offset,
+				to - from,
+				i);
+		}
+	}
+}
+
 /**
 	@brief Converts raw ADC samples to floating point
  */
@@ -1481,3 +1813,69 @@ void Oscilloscope::Convert16BitSamplesFMA(
 		pout[k] = pin[k] * gain - offset;
 	}
 }
+
+/**
+	@brief AVX-512 version of Convert16BitSamples(), converting 64 samples per iteration
+ */
+__attribute__((target("avx512f")))
+void Oscilloscope::Convert16BitSamplesAVX512F(
+		int64_t* offs, int64_t* durs, float* pout, int16_t* pin, float gain, float offset, size_t count, int64_t ibase)
+{
+	size_t end = count - (count % 64);
+
+	__m512i all_ones	= _mm512_set1_epi64(1);
+	__m512i all_eights	= _mm512_set1_epi64(8);
+	__m512i counts		= _mm512_add_epi64(_mm512_set1_epi64(ibase), _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0));
+
+	__m512 gains = _mm512_set1_ps(gain);
+	__m512 offsets = _mm512_set1_ps(offset);
+
+	bool stream = UseStreamingStores(offs, durs, pout, count);
+
+	for(size_t k=0; k<end; k += 64)
+	{
+		//Load all 64 raw ADC samples, in blocks of 16
+		__m256i block0_i16 = _mm256_loadu_si256(reinterpret_cast<__m256i*>(pin + k));
+		__m256i block1_i16 = _mm256_loadu_si256(reinterpret_cast<__m256i*>(pin + k + 16));
+		__m256i block2_i16 = _mm256_loadu_si256(reinterpret_cast<__m256i*>(pin + k + 32));
+		__m256i block3_i16 = _mm256_loadu_si256(reinterpret_cast<__m256i*>(pin + k + 48));
+
+		//Fill duration and offset, 8 samples per store
+		for(size_t j=0; j<64; j += 8)
+		{
+			StoreAVX512(durs + k + j, all_ones, stream);
+			StoreAVX512(offs + k + j, counts, stream);
+			counts = _mm512_add_epi64(counts, all_eights);
+		}
+
+		//Sign extend each block to 32 bit, then convert to fp32
+		__m512 block0_float = ConvertInt16ToFloatAVX512(block0_i16);
+		__m512 block1_float = ConvertInt16ToFloatAVX512(block1_i16);
+		__m512 block2_float = ConvertInt16ToFloatAVX512(block2_i16);
+		__m512 block3_float = ConvertInt16ToFloatAVX512(block3_i16);
+
+		//Scale and offset
+		block0_float = _mm512_fmsub_ps(block0_float, gains, offsets);
+		block1_float = _mm512_fmsub_ps(block1_float, gains, offsets);
+		block2_float = _mm512_fmsub_ps(block2_float, gains, offsets);
+		block3_float = _mm512_fmsub_ps(block3_float, gains, offsets);
+
+		//All done, store back to the output buffer
+		StoreAVX512(pout + k,		block0_float, stream);
+		StoreAVX512(pout + k + 16,	block1_float, stream);
+		StoreAVX512(pout + k + 32,	block2_float, stream);
+		StoreAVX512(pout + k + 48,	block3_float, stream);
+	}
+
+	//Make sure streaming stores are visible before anyone else looks at the waveform
+	if(stream)
+		_mm_sfence();
+
+	//Get any extras we didn't get in the SIMD loop
+	for(size_t k=end; k<count; k++)
+	{
+		offs[k] = ibase + k;
+		durs[k] = 1;
+		pout[k] = pin[k] * gain - offset;
+	}
+}
@@ -814,30 +814,80 @@ public:
 
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// Sample format conversion
+public:
+
+	/**
+		@brief Requests that analog waveforms be delivered as raw ADC codes (ADCCodeWaveform) rather than volts.
+
+		Codes are converted to volts on demand the first time a consumer needs them. Drivers which don't support this
+		ignore the setting and always deliver AnalogWaveforms.
+	 */
+	void SetDeferredSampleConversion(bool defer)
+	{ m_deferSampleConversion = defer; }
+
+	bool IsDeferredSampleConversionEnabled()
+	{ return m_deferSampleConversion; }
+
+	/**
+		@brief Requests that analog waveforms be delivered as UniformAnalogWaveform rather than AnalogWaveform.
+
+		Uniform waveforms have no per-sample timestamps, saving 16 bytes per sample. Filters which only understand
+		explicit timestamps still get an AnalogWaveform from GetAnalogInputWaveform(), made on demand. Drivers which
+		don't support this ignore the setting.
+	 */
+	void SetUniformAnalogWaveforms(bool uniform)
+	{ m_uniformAnalogWaveforms = uniform; }
+
+	bool IsUniformAnalogWaveformsEnabled()
+	{ return m_uniformAnalogWaveforms; }
+
 protected:
-	void Convert8BitSamples(
+	///True if drivers should deliver raw ADC codes rather than volts when they can
+	bool m_deferSampleConversion;
+
+	///True if drivers should deliver analog waveforms without timestamps when they can
+	bool m_uniformAnalogWaveforms;
+
+	static void Convert8BitSamples(
+		int64_t* offs, int64_t* durs, float* pout, int8_t* pin, float gain, float offset, size_t count, int64_t ibase);
+	static void Convert8BitSamplesGeneric(
 		int64_t* offs, int64_t* durs, float* pout, int8_t* pin, float gain, float offset, size_t count, int64_t ibase);
-	void Convert8BitSamplesGeneric(
+	static void Convert8BitSamplesAVX2(
 		int64_t* offs, int64_t* durs, float* pout, int8_t* pin, float gain, float offset, size_t count, int64_t ibase);
-	void Convert8BitSamplesAVX2(
+	static void Convert8BitSamplesAVX512F(
 		int64_t* offs, int64_t* durs, float* pout, int8_t* pin, float gain, float offset, size_t count, int64_t ibase);
 
-	void ConvertUnsigned8BitSamples(
+	static void ConvertUnsigned8BitSamples(
 		int64_t* offs, int64_t* durs, float* pout, uint8_t* pin, float gain, float offset, size_t count, int64_t ibase);
-	void ConvertUnsigned8BitSamplesGeneric(
+	static void ConvertUnsigned8BitSamplesGeneric(
 		int64_t* offs, int64_t* durs, float* pout, uint8_t* pin, float gain, float offset, size_t count, int64_t ibase);
-	void ConvertUnsigned8BitSamplesAVX2(
+	static void ConvertUnsigned8BitSamplesAVX2(
+		int64_t* offs, int64_t* durs, float* pout, uint8_t* pin, float gain, float offset, size_t count, int64_t ibase);
+	static void ConvertUnsigned8BitSamplesAVX512F(
 		int64_t* offs, int64_t* durs, float* pout, uint8_t* pin, float gain, float offset, size_t count, int64_t ibase);
 
-	void Convert16BitSamples(
+	static void Convert16BitSamples(
+		int64_t* offs, int64_t* durs, float* pout, int16_t* pin, float gain, float offset, size_t count, int64_t ibase);
+	static void Convert16BitSamplesGeneric(
 		int64_t* offs, int64_t* durs, float* pout, int16_t* pin, float gain, float offset, size_t count, int64_t ibase);
-	void Convert16BitSamplesGeneric(
+	static void Convert16BitSamplesAVX2(
 		int64_t* offs, int64_t* durs, float* pout, int16_t* pin, float gain, float offset, size_t count, int64_t ibase);
-	void Convert16BitSamplesAVX2(
+	static void Convert16BitSamplesFMA(
 		int64_t* offs, int64_t* durs, float* pout, int16_t* pin, float gain, float offset, size_t count, int64_t ibase);
-	void Convert16BitSamplesFMA(
+	static void Convert16BitSamplesAVX512F(
 		int64_t* offs, int64_t* durs, float* pout, int16_t* pin, float gain, float offset, size_t count, int64_t ibase);
 
+	static void ConvertUniform16BitSamples(float* pout, int16_t* pin, float gain, float offset, size_t count);
+
+	static void ConvertSegmentedSamples(
+		std::vector<WaveformBase*>& segments,
+		const unsigned char* data,
+		size_t start,
+		size_t end,
+		bool sixteenBit,
+		float gain,
+		float offset);
+
 public:
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// Waveform Access
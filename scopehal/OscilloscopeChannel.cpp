@@ -112,7 +112,7 @@ void OscilloscopeChannel::SetDefaultDisplayName()
 OscilloscopeChannel::~OscilloscopeChannel()
 {
 	for(auto p : m_streams)
-		delete p.m_waveform;
+		WaveformPool::Return(p.m_waveform);
 	m_streams.clear();
 }
 
@@ -122,7 +122,7 @@ OscilloscopeChannel::~OscilloscopeChannel()
 void OscilloscopeChannel::ClearStreams()
 {
 	for(auto s : m_streams)
-		delete s.m_waveform;
+		WaveformPool::Return(s.m_waveform);
 	m_streams.clear();
 }
 
@@ -355,10 +355,14 @@ void OscilloscopeChannel::SetInputMux(size_t select)
 
 void OscilloscopeChannel::SetData(WaveformBase* pNew, size_t stream)
 {
+	//New data, so anything computed from the old contents is stale
+	if(pNew)
+		pNew->MarkModified();
+
 	if(m_streams[stream].m_waveform == pNew)
 		return;
 
 	if(m_streams[stream].m_waveform != NULL)
-		delete m_streams[stream].m_waveform;
+		WaveformPool::Return(m_streams[stream].m_waveform);
 	m_streams[stream].m_waveform = pNew;
 }
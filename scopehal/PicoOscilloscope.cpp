@@ -32,6 +32,8 @@
 #include <thread>
 #endif
 
+#include <immintrin.h>
+
 #include "scopehal.h"
 #include "PicoOscilloscope.h"
 #include "EdgeTrigger.h"
@@ -380,7 +382,7 @@ bool PicoOscilloscope::AcquireData()
 
 	//Analog channels get processed separately
 	vector<int16_t*> abufs;
-	vector<AnalogWaveform*> awfms;
+	vector<WaveformBase*> awfms;
 	vector<float> scales;
 	vector<float> offsets;
 
@@ -396,7 +398,6 @@ bool PicoOscilloscope::AcquireData()
 		//Analog channels
 		if(chnum < m_analogChannelCount)
 		{
-			abufs.push_back(buf);
 
 			//Scale and offset are sent in the header since they might have changed since the capture began
 			if(!m_transport->ReadRawData(sizeof(config), (uint8_t*)&config))
@@ -409,11 +410,39 @@ bool PicoOscilloscope::AcquireData()
 
 			//TODO: stream timestamp from the server
 
+			//Keep the raw ADC codes if requested. Read them straight into the waveform, conversion happens on demand.
+			if(m_deferSampleConversion)
+			{
+				delete[] buf;
+
+				auto cap = WaveformPool::Get<ADC16Waveform>(memdepth);
+				cap->Resize(memdepth);
+				if(!m_transport->ReadRawData(memdepth * sizeof(int16_t), (uint8_t*)&cap->m_samples[0]))
+				{
+					WaveformPool::Return(cap);
+					return false;
+				}
+
+				cap->m_timescale = fs_per_sample;
+				cap->m_triggerPhase = trigphase;
+				cap->m_startTimestamp = time(NULL);
+				cap->m_startFemtoseconds = fs;
+				cap->SetScaling(scale, -offset);
+
+				s[m_channels[chnum]] = cap;
+				continue;
+			}
+
+			abufs.push_back(buf);
 			if(!m_transport->ReadRawData(memdepth * sizeof(int16_t), (uint8_t*)buf))
 				return false;
 
 			//Create our waveform
-			AnalogWaveform* cap = new AnalogWaveform;
+			WaveformBase* cap;
+			if(m_uniformAnalogWaveforms)
+				cap = WaveformPool::Get<UniformAnalogWaveform>(memdepth);
+			else
+				cap = WaveformPool::Get<AnalogWaveform>(memdepth);
 			cap->m_timescale = fs_per_sample;
 			cap->m_triggerPhase = trigphase;
 			cap->m_startTimestamp = time(NULL);
@@ -445,70 +474,37 @@ bool PicoOscilloscope::AcquireData()
 				return false;
 			}
 
-			//Create buffers for output waveforms
-			DigitalWaveform* caps[8];
-			for(size_t j=0; j<8; j++)
-			{
-				caps[j] = new DigitalWaveform;
-				s[m_channels[m_digitalChannelBase + 8*podnum + j] ] = caps[j];
-			}
+			//Split the pod into one bit-plane per channel in a single pass
+			size_t nwords = (memdepth + 63) / 64;
+			vector<uint64_t> planes(8 * nwords);
+			TransposePodSamples(buf, memdepth, planes.data());
+			delete[] buf;
 
-			//Now that we have the waveform data, unpack it into individual channels
+			//Now that we have the waveform data, run-length encode each channel
+			DigitalWaveform* caps[8];
 			#pragma omp parallel for
 			for(size_t j=0; j<8; j++)
 			{
-				//Bitmask for this digital channel
-				int16_t mask = (1 << j);
+				//Count the runs first so we can check out exactly the right size buffer from the pool
+				const uint64_t* plane = &planes[j * nwords];
+				size_t nruns = 0;
+				for(size_t w=0; w<nwords; w++)
+					nruns += __builtin_popcountll(GetPodRunStartMask(plane, w, memdepth));
 
-				//Create the waveform
-				auto cap = caps[j];
+				auto cap = WaveformPool::Get<DigitalWaveform>(nruns);
 				cap->m_timescale = fs_per_sample;
 				cap->m_triggerPhase = trigphase;
 				cap->m_startTimestamp = time(NULL);
 				cap->m_densePacked = false;
 				cap->m_startFemtoseconds = fs;
+				cap->Resize(nruns);
+				UnpackPodChannel(plane, memdepth, cap);
 
-				//Preallocate memory assuming no deduplication possible
-				cap->Resize(memdepth);
-
-				//First sample never gets deduplicated
-				bool last = (buf[0] & mask) ? true : false;
-				size_t k = 0;
-				cap->m_offsets[0] = 0;
-				cap->m_durations[0] = 1;
-				cap->m_samples[0] = last;
-
-				//Read and de-duplicate the other samples
-				//TODO: can we vectorize this somehow?
-				for(size_t m=1; m<memdepth; m++)
-				{
-					bool sample = (buf[m] & mask) ? true : false;
-
-					//Deduplicate consecutive samples with same value
-					//FIXME: temporary workaround for rendering bugs
-					//if(last == sample)
-					if( (last == sample) && ((m+3) < memdepth) )
-						cap->m_durations[k] ++;
-
-					//Nope, it toggled - store the new value
-					else
-					{
-						k++;
-						cap->m_offsets[k] = m;
-						cap->m_durations[k] = 1;
-						cap->m_samples[k] = sample;
-						last = sample;
-					}
-				}
-
-				//Free space reclaimed by deduplication
-				cap->Resize(k);
-				cap->m_offsets.shrink_to_fit();
-				cap->m_durations.shrink_to_fit();
-				cap->m_samples.shrink_to_fit();
+				caps[j] = cap;
 			}
 
-			delete[] buf;
+			for(size_t j=0; j<8; j++)
+				s[m_channels[m_digitalChannelBase + 8*podnum + j] ] = caps[j];
 		}
 	}
 
@@ -516,16 +512,22 @@ bool PicoOscilloscope::AcquireData()
 	#pragma omp parallel for
 	for(size_t i=0; i<awfms.size(); i++)
 	{
-		auto cap = awfms[i];
-		Convert16BitSamples(
-			(int64_t*)&cap->m_offsets[0],
-			(int64_t*)&cap->m_durations[0],
-			(float*)&cap->m_samples[0],
-			abufs[i],
-			scales[i],
-			-offsets[i],
-			cap->m_offsets.size(),
-			0);
+		auto ucap = dynamic_cast<UniformAnalogWaveform*>(awfms[i]);
+		if(ucap)
+			ConvertUniform16BitSamples((float*)&ucap->m_samples[0], abufs[i], scales[i], -offsets[i], ucap->size());
+		else
+		{
+			auto cap = static_cast<AnalogWaveform*>(awfms[i]);
+			Convert16BitSamples(
+				(int64_t*)&cap->m_offsets[0],
+				(int64_t*)&cap->m_durations[0],
+				(float*)&cap->m_samples[0],
+				abufs[i],
+				scales[i],
+				-offsets[i],
+				cap->m_offsets.size(),
+				0);
+		}
 		delete[] abufs[i];
 	}
 
@@ -541,6 +543,170 @@ bool PicoOscilloscope::AcquireData()
 	return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Digital pod unpacking
+
+/**
+	@brief Splits the samples from a digital pod into one bit-plane per channel
+
+	Bit (i % 64) of word (i / 64) of plane j is bit j of sample i. Plane j starts at planes + j*nwords, where nwords is
+	len rounded up to a whole number of words. Bits past the end of the capture are zero.
+ */
+void PicoOscilloscope::TransposePodSamples(const int16_t* buf, size_t len, uint64_t* planes)
+{
+	if(g_hasAvx2)
+		TransposePodSamplesAVX2(buf, len, planes);
+	else
+		TransposePodSamplesGeneric(buf, 0, len, planes);
+}
+
+/**
+	@brief Generic backend for TransposePodSamples(), handling samples [start, len). start must be a multiple of 64.
+ */
+void PicoOscilloscope::TransposePodSamplesGeneric(const int16_t* buf, size_t start, size_t len, uint64_t* planes)
+{
+	size_t nwords = (len + 63) / 64;
+	for(size_t w=start/64; w<nwords; w++)
+	{
+		uint64_t bits[8] = {0};
+
+		size_t base = w*64;
+		size_t n = min((size_t)64, len - base);
+		for(size_t i=0; i<n; i++)
+		{
+			uint64_t sample = buf[base + i];
+			for(size_t j=0; j<8; j++)
+				bits[j] |= ((sample >> j) & 1) << i;
+		}
+
+		for(size_t j=0; j<8; j++)
+			planes[j*nwords + w] = bits[j];
+	}
+}
+
+/**
+	@brief Optimized version of TransposePodSamples()
+
+	Each block of 32 samples is narrowed to one byte per sample. Shifting bit j of every byte up to the MSB and
+	collecting the MSBs with movemask then gives 32 samples of channel j at once.
+ */
+__attribute__((target("avx2")))
+void PicoOscilloscope::TransposePodSamplesAVX2(const int16_t* buf, size_t len, uint64_t* planes)
+{
+	size_t nwords = (len + 63) / 64;
+	size_t end = len - (len % 64);
+
+	__m256i lowbyte = _mm256_set1_epi16(0xff);
+
+	for(size_t k=0; k<end; k += 64)
+	{
+		uint64_t bits[8] = {0};
+
+		for(size_t half=0; half<2; half++)
+		{
+			//Load 32 samples, without assuming alignment
+			const int16_t* p = buf + k + half*32;
+			__m256i samples_lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+			__m256i samples_hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 16));
+
+			//Narrow to 8 bits. Pack works within 128-bit lanes, so fix up the order of the 64-bit blocks afterwards.
+			__m256i bytes = _mm256_packus_epi16(
+				_mm256_and_si256(samples_lo, lowbyte),
+				_mm256_and_si256(samples_hi, lowbyte));
+			bytes = _mm256_permute4x64_epi64(bytes, 0xd8);
+
+			//Pull out one channel at a time.
+			//The 16-bit shift moves bits across byte boundaries, but never into the MSB we care about.
+			for(size_t j=0; j<8; j++)
+			{
+				uint32_t mask = _mm256_movemask_epi8(_mm256_slli_epi16(bytes, 7 - j));
+				bits[j] |= (uint64_t)mask << (half*32);
+			}
+		}
+
+		size_t w = k / 64;
+		for(size_t j=0; j<8; j++)
+			planes[j*nwords + w] = bits[j];
+	}
+
+	//Get any extras we didn't get in the SIMD loop
+	if(end < len)
+		TransposePodSamplesGeneric(buf, end, len, planes);
+}
+
+/**
+	@brief Finds which samples in one word of a bit-plane start a new run
+
+	A sample starts a run if it differs from the previous one. The first sample always starts a run, and so do the
+	last three samples of the capture, since we never deduplicate those (temporary workaround for rendering bugs).
+
+	@param plane	Bit-plane for one channel
+	@param iword	Index of the word to process
+	@param len		Number of samples in the capture
+ */
+uint64_t PicoOscilloscope::GetPodRunStartMask(const uint64_t* plane, size_t iword, size_t len)
+{
+	size_t base = iword * 64;
+	uint64_t cur = plane[iword];
+
+	uint64_t starts;
+	if(iword == 0)
+		starts = (cur ^ (cur << 1)) | 1;
+	else
+		starts = cur ^ ((cur << 1) | (plane[iword-1] >> 63));
+
+	//FIXME: temporary workaround for rendering bugs
+	size_t forced = (len > 3) ? (len - 3) : 1;
+	if(forced < base + 64)
+	{
+		size_t first = (forced > base) ? (forced - base) : 0;
+		starts |= ~0ULL << first;
+	}
+
+	//Discard anything past the end of the capture
+	size_t valid = len - base;
+	if(valid < 64)
+		starts &= (1ULL << valid) - 1;
+
+	return starts;
+}
+
+/**
+	@brief Run-length encodes one channel of a digital pod
+
+	@param plane	Bit-plane for the channel, from TransposePodSamples()
+	@param len		Number of samples in the capture
+	@param cap		Output waveform, already resized to the number of runs
+ */
+void PicoOscilloscope::UnpackPodChannel(const uint64_t* plane, size_t len, DigitalWaveform* cap)
+{
+	size_t nwords = (len + 63) / 64;
+	size_t k = 0;
+	for(size_t w=0; w<nwords; w++)
+	{
+		uint64_t cur = plane[w];
+		uint64_t starts = GetPodRunStartMask(plane, w, len);
+
+		//Jump straight from one run to the next, no need to look at the samples in between
+		while(starts)
+		{
+			size_t bit = __builtin_ctzll(starts);
+			starts &= starts - 1;
+
+			int64_t m = w*64 + bit;
+			if(k > 0)
+				cap->m_durations[k-1] = m - cap->m_offsets[k-1];
+			cap->m_offsets[k] = m;
+			cap->m_samples[k] = (cur >> bit) & 1;
+			k++;
+		}
+	}
+
+	//Last run extends to the end of the capture
+	if(k > 0)
+		cap->m_durations[k-1] = len - cap->m_offsets[k-1];
+}
+
 bool PicoOscilloscope::IsTriggerArmed()
 {
 	return m_triggerArmed;
@@ -197,6 +197,13 @@ protected:
 	bool CanEnableChannel6000Series10Bit(size_t i);
 	bool CanEnableChannel6000Series12Bit(size_t i);
 
+	//Digital pod unpacking
+	static void TransposePodSamples(const int16_t* buf, size_t len, uint64_t* planes);
+	static void TransposePodSamplesGeneric(const int16_t* buf, size_t start, size_t len, uint64_t* planes);
+	static void TransposePodSamplesAVX2(const int16_t* buf, size_t len, uint64_t* planes);
+	static uint64_t GetPodRunStartMask(const uint64_t* plane, size_t iword, size_t len);
+	static void UnpackPodChannel(const uint64_t* plane, size_t len, DigitalWaveform* cap);
+
 	std::string GetChannelColor(size_t i);
 
 	//hardware analog channel count, independent of LA option etc
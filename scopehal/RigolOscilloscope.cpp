@@ -770,7 +770,7 @@ bool RigolOscilloscope::AcquireData()
 		}
 
 		//Set up the capture we're going to store our data into
-		AnalogWaveform* cap = new AnalogWaveform;
+		AnalogWaveform* cap = WaveformPool::Get<AnalogWaveform>();
 		cap->m_timescale = fs_per_sample;
 		cap->m_triggerPhase = 0;
 		cap->m_startTimestamp = time(NULL);
@@ -519,7 +519,7 @@ bool RohdeSchwarzOscilloscope::AcquireData()
 		float* temp_buf = new float[length];
 
 		//Set up the capture we're going to store our data into (no high res timer on R&S scopes)
-		AnalogWaveform* cap = new AnalogWaveform;
+		AnalogWaveform* cap = WaveformPool::Get<AnalogWaveform>();
 		cap->m_timescale = fs_per_sample;
 		cap->m_triggerPhase = 0;
 		cap->m_startTimestamp = time(NULL);
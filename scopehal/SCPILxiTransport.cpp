@@ -103,6 +103,8 @@ SCPILxiTransport::SCPILxiTransport(const string& args)
 
 SCPILxiTransport::~SCPILxiTransport()
 {
+	StopIOThread();
+
 	delete[] m_staging_buf;
 }
 
@@ -53,7 +53,7 @@ SCPINullTransport::SCPINullTransport(const string& args)
 
 SCPINullTransport::~SCPINullTransport()
 {
-
+	StopIOThread();
 }
 
 bool SCPINullTransport::IsConnected()
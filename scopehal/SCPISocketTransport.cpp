@@ -33,6 +33,8 @@
 	@brief Implementation of SCPISocketTransport
  */
 
+#include <limits.h>
+
 #include "scopehal.h"
 
 using namespace std;
@@ -98,6 +100,7 @@ void SCPISocketTransport::SharedCtorInit()
 
 SCPISocketTransport::~SCPISocketTransport()
 {
+	StopIOThread();
 }
 
 bool SCPISocketTransport::IsConnected()
@@ -129,25 +132,13 @@ bool SCPISocketTransport::SendCommand(const string& cmd)
 
 string SCPISocketTransport::ReadReply(bool endOnSemicolon)
 {
-	//FIXME: there *has* to be a more efficient way to do this...
-	char tmp = ' ';
-	string ret;
-	while(true)
-	{
-		if(!m_socket.RecvLooped((unsigned char*)&tmp, 1))
-			break;
-		if( (tmp == '\n') || ( (tmp == ';') && endOnSemicolon ) )
-			break;
-		else
-			ret += tmp;
-	}
-	LogTrace("Got %s\n", ret.c_str());
-	return ret;
+	return ReadBufferedReply(endOnSemicolon);
 }
 
 void SCPISocketTransport::FlushRXBuffer(void)
 
 {
+	ClearReceiveBuffer();
 	m_socket.FlushRxBuffer();
 }
 
@@ -158,14 +149,28 @@ void SCPISocketTransport::SendRawData(size_t len, const unsigned char* buf)
 
 size_t SCPISocketTransport::ReadRawData(size_t len, unsigned char* buf)
 {
-	if(!m_socket.RecvLooped(buf, len))
+	return ReadBufferedRawData(len, buf);
+}
+
+/**
+	@brief Reads whatever is waiting in the socket, blocking until there's at least one byte
+ */
+size_t SCPISocketTransport::ReceiveAvailable(unsigned char* buf, size_t len)
+{
+	while(true)
 	{
-		LogTrace("Failed to get %ld bytes\n", len);
+		int n = recv((ZSOCKET)m_socket, (char*)buf, min(len, (size_t)INT_MAX), 0);
+		if(n > 0)
+			return n;
+
+		//A signal landing while we wait isn't an error, go back to waiting
+#ifndef _WIN32
+		if( (n < 0) && (errno == EINTR) )
+			continue;
+#endif
+
 		return 0;
 	}
-
-	LogTrace("Got %ld bytes\n", len);
-	return len;
 }
 
 bool SCPISocketTransport::IsCommandBatchingSupported()
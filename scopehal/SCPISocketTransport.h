@@ -71,6 +71,7 @@ public:
 protected:
 
 	void SharedCtorInit();
+	virtual size_t ReceiveAvailable(unsigned char* buf, size_t len);
 
 	Socket m_socket;
 
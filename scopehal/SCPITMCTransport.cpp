@@ -79,6 +79,8 @@ SCPITMCTransport::SCPITMCTransport(const string& args)
 
 SCPITMCTransport::~SCPITMCTransport()
 {
+	StopIOThread();
+
 	if (IsConnected())
 		close(m_handle);
 
@@ -126,17 +128,30 @@ string SCPITMCTransport::ReadReply(bool endOnSemicolon)
 	if (!m_staging_buf || !IsConnected())
 		return ret;
 
-	//FIXME: there *has* to be a more efficient way to do this...
-	char tmp = ' ';
-	while(true)
+	//Search the staging buffer for the end of the reply, rather than copying it out a byte at a time
+	while(!m_data_depleted)
 	{
-		if (m_data_depleted)
-			break;
-		ReadRawData(1, (unsigned char *)&tmp);
-		if( (tmp == '\n') || ( (tmp == ';') && endOnSemicolon ) )
-			break;
+		if (m_data_in_staging_buf == 0)
+			FillStagingBuffer(1);
+
+		const char* start = (const char*)m_staging_buf + m_data_offset;
+		size_t avail = m_data_in_staging_buf - m_data_offset;
+		const char* end = FindReplyEnd(start, avail, endOnSemicolon);
+		if(end)
+		{
+			ret.append(start, end - start);
+			m_data_offset += (end - start) + 1;
+		}
 		else
-			ret += tmp;
+		{
+			ret.append(start, avail);
+			m_data_offset += avail;
+		}
+
+		if (m_data_offset == m_data_in_staging_buf)
+			m_data_depleted = true;
+		if(end)
+			break;
 	}
 	LogTrace("Got %s\n", ret.c_str());
 	return ret;
@@ -161,33 +176,7 @@ size_t SCPITMCTransport::ReadRawData(size_t len, unsigned char* buf)
 	if (!m_data_depleted)
 	{
 		if (m_data_in_staging_buf == 0)
-		{
-
-#if 0
-			// This is what we'd use if we could be sure that the installed Linux kernel had
-			// usbtmc driver v2.
-			m_data_in_staging_buf = read(m_handle, (char *)m_staging_buf, m_staging_buf_size);
-#else
-			// Split up one potentially large read into a bunch of smaller ones.
-			// The performance impact of this is pretty small.
-			const int max_bytes_per_req = 2032;
-			int i = 0;
-			int bytes_fetched, bytes_requested;
-
-			do
-			{
-				bytes_requested = (max_bytes_per_req < len) ? max_bytes_per_req : len;
-				bytes_fetched = read(m_handle, (char *)m_staging_buf + i, m_staging_buf_size);
-				i += bytes_fetched;
-			} while(bytes_fetched == bytes_requested);
-
-			m_data_in_staging_buf = i;
-#endif
-
-			if (m_data_in_staging_buf <= 0)
-				m_data_in_staging_buf = 0;
-			m_data_offset = 0;
-		}
+			FillStagingBuffer(len);
 
 		unsigned int data_left = m_data_in_staging_buf - m_data_offset;
 		if (data_left > 0)
@@ -213,6 +202,37 @@ size_t SCPITMCTransport::ReadRawData(size_t len, unsigned char* buf)
 	return len;
 }
 
+/**
+	@brief Fetches the reply to the last command into the staging buffer
+ */
+void SCPITMCTransport::FillStagingBuffer(size_t len)
+{
+#if 0
+	// This is what we'd use if we could be sure that the installed Linux kernel had
+	// usbtmc driver v2.
+	m_data_in_staging_buf = read(m_handle, (char *)m_staging_buf, m_staging_buf_size);
+#else
+	// Split up one potentially large read into a bunch of smaller ones.
+	// The performance impact of this is pretty small.
+	const int max_bytes_per_req = 2032;
+	int i = 0;
+	int bytes_fetched, bytes_requested;
+
+	do
+	{
+		bytes_requested = (max_bytes_per_req < len) ? max_bytes_per_req : len;
+		bytes_fetched = read(m_handle, (char *)m_staging_buf + i, m_staging_buf_size);
+		i += bytes_fetched;
+	} while(bytes_fetched == bytes_requested);
+
+	m_data_in_staging_buf = i;
+#endif
+
+	if (m_data_in_staging_buf <= 0)
+		m_data_in_staging_buf = 0;
+	m_data_offset = 0;
+}
+
 bool SCPITMCTransport::IsCommandBatchingSupported()
 {
 	return false;
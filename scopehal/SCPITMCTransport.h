@@ -65,6 +65,8 @@ public:
 	{ return m_devicePath; }
 
 protected:
+	void FillStagingBuffer(size_t len);
+
 	std::string m_devicePath;
 
 	int m_handle;
@@ -33,20 +33,55 @@
 	@brief Implementation of SCPITransport
  */
 
+#include <condition_variable>
+
 #include "scopehal.h"
 
 using namespace std;
 
 SCPITransport::CreateMapType SCPITransport::m_createprocs;
 
+//Maximum number of pipelined queries sent ahead of the reply being read
+static const size_t MAX_QUERIES_IN_FLIGHT = 32;
+
+//Receive buffer size. Big enough to take a few max-size TCP segments per call, small enough to not care about the memory
+static const size_t RX_BUFFER_SIZE = 256 * 1024;
+
 SCPITransport::SCPITransport()
-	: m_rateLimitingEnabled(false)
+	: m_ioThreadRunning(false)
+	, m_ioPending(0)
+	, m_ioSleeping(false)
+	, m_ioStop(false)
+	, m_rateLimitingEnabled(false)
 	, m_rateLimitingInterval(0)
+	, m_rxHead(0)
+	, m_rxTail(0)
+	, m_chunkCallback(NULL)
+	, m_chunkReceived(0)
+	, m_chunkDone(0)
+	, m_chunkFinished(false)
+	, m_chunkExit(false)
 {
+	ResetIOLaneStats();
+	for(int i=0; i<IO_LANE_COUNT; i++)
+		m_ioDepth[i] = 0;
 }
 
 SCPITransport::~SCPITransport()
 {
+	//Transports stop the thread in their own destructors, since queued transactions call their virtual functions.
+	//This is just a backstop.
+	StopIOThread();
+
+	if(m_chunkThread.joinable())
+	{
+		{
+			lock_guard<mutex> lock(m_chunkMutex);
+			m_chunkExit = true;
+		}
+		m_chunkReady.notify_one();
+		m_chunkThread.join();
+	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -84,8 +119,15 @@ void SCPITransport::SendCommandQueued(const string& cmd)
 {
 	lock_guard<mutex> lock(m_queueMutex);
 
-	//Do deduplication if there are existing queued commands
-	if(!m_dedupCommands.empty() && !m_txQueue.empty())
+	//Do deduplication if there are existing queued commands.
+	//Only look at commands after the last queued query, so a query still sees the settings it was queued after.
+	auto dedupStart = m_txQueue.end();
+	if(!m_dedupCommands.empty())
+	{
+		while( (dedupStart != m_txQueue.begin()) && !prev(dedupStart)->m_isQuery )
+			dedupStart --;
+	}
+	if(dedupStart != m_txQueue.end())
 	{
 		//Parse the INCOMING command into sections
 
@@ -113,10 +155,10 @@ void SCPITransport::SendCommandQueued(const string& cmd)
 		//Only attempt to deduplicate previous instances if this command is on the list of commands where it's OK
 		if(m_dedupCommands.find(incoming_cmd) != m_dedupCommands.end())
 		{
-			auto it = m_txQueue.begin();
+			auto it = dedupStart;
 			while(it != m_txQueue.end())
 			{
-				tmp = *it;
+				tmp = it->m_cmd;
 
 				//Split off subject, if we have one
 				//(ignore leading colon)
@@ -142,7 +184,7 @@ void SCPITransport::SendCommandQueued(const string& cmd)
 				{
 					LogTrace("Deduplicating redundant %s command %s and pushing new command %s\n",
 						ncmd.c_str(),
-						(*it).c_str(),
+						it->m_cmd.c_str(),
 						cmd.c_str());
 
 					auto oldit = it;
@@ -159,7 +201,11 @@ void SCPITransport::SendCommandQueued(const string& cmd)
 
 	}
 
-	m_txQueue.push_back(cmd);
+	m_txQueue.emplace_back();
+	auto& queued = m_txQueue.back();
+	queued.m_cmd = cmd;
+	queued.m_isQuery = false;
+	queued.m_endOnSemicolon = false;
 
 	LogTrace("%zu commands now queued\n", m_txQueue.size());
 }
@@ -174,28 +220,103 @@ void SCPITransport::RateLimitingWait()
 }
 
 /**
-	@brief Pushes all pending commands from SendCommandQueued() calls and blocks until they are all sent.
+	@brief Pushes all pending commands from SendCommandQueued() and SendCommandQueuedWithFutureReply() calls, in the
+	order they were queued, and blocks until they are all sent and every query has its reply.
+
+	Queries are pipelined: later commands are sent without waiting for earlier queries' replies (if the transport
+	supports batching), up to MAX_QUERIES_IN_FLIGHT unanswered queries at a time.
+
+	@return False if any command couldn't be sent or any query got no reply
  */
 bool SCPITransport::FlushCommandQueue()
 {
 	//Grab the queue, then immediately release the mutex so we can do more queued sends
-	list<string> tmp;
+	list<QueuedCommand> tmp;
 	{
 		lock_guard<mutex> lock(m_queueMutex);
-		tmp = move(m_txQueue);
-		m_txQueue.clear();
+		tmp.swap(m_txQueue);
 	}
+	if(tmp.empty())
+		return true;
 
-	if(tmp.size())
-		LogTrace("%zu commands being flushed\n", tmp.size());
+	LogTrace("%zu commands being flushed\n", tmp.size());
 
-	lock_guard<recursive_mutex> lock(m_netMutex);
-	for(auto str : tmp)
+	return RunTransaction<bool>(IO_LANE_CONTROL, [&]()
+		{
+			//Don't get too far ahead of the instrument, it may only have a small input buffer.
+			//Transports that can't batch commands have to wait for each reply before sending anything else.
+			bool batching = IsCommandBatchingSupported();
+			size_t maxInFlight = batching ? MAX_QUERIES_IN_FLIGHT : 1;
+
+			bool ok = true;
+			list<QueuedCommand*> inFlight;
+			for(auto& cmd : tmp)
+			{
+				while( !inFlight.empty() && ( !batching || (cmd.m_isQuery && (inFlight.size() >= maxInFlight)) ) )
+				{
+					ok &= ReadQueuedReply(*inFlight.front());
+					inFlight.pop_front();
+				}
+
+				if(m_rateLimitingEnabled)
+					RateLimitingWait();
+				if(!SendCommand(cmd.m_cmd))
+				{
+					ok = false;
+					if(cmd.m_isQuery)
+					{
+						cmd.m_reply.set_exception(make_exception_ptr(
+							runtime_error("Failed to send queued query \"" + cmd.m_cmd + "\"")));
+					}
+					continue;
+				}
+
+				if(cmd.m_isQuery)
+					inFlight.push_back(&cmd);
+			}
+
+			for(auto query : inFlight)
+				ok &= ReadQueuedReply(*query);
+			return ok;
+		});
+}
+
+/**
+	@brief Queues a query to be sent by the next FlushCommandQueue(), and returns a future for its reply
+ */
+future<string> SCPITransport::SendCommandQueuedWithFutureReply(const string& cmd, bool endOnSemicolon)
+{
+	lock_guard<mutex> lock(m_queueMutex);
+
+	m_txQueue.emplace_back();
+	auto& query = m_txQueue.back();
+	query.m_cmd = cmd;
+	query.m_isQuery = true;
+	query.m_endOnSemicolon = endOnSemicolon;
+
+	LogTrace("%zu commands now queued\n", m_txQueue.size());
+	return query.m_reply.get_future();
+}
+
+/**
+	@brief Reads the reply to a pipelined query and resolves its future
+
+	An empty reply means the read failed or timed out, so the future gets an exception rather than a value that could
+	be mistaken for a real setting.
+
+	@return True if a reply was received
+ */
+bool SCPITransport::ReadQueuedReply(QueuedCommand& query)
+{
+	string reply = ReadReply(query.m_endOnSemicolon);
+	if(reply.empty())
 	{
-		if(m_rateLimitingEnabled)
-			RateLimitingWait();
-		SendCommand(str);
+		query.m_reply.set_exception(make_exception_ptr(
+			runtime_error("No reply to queued query \"" + query.m_cmd + "\"")));
+		return false;
 	}
+
+	query.m_reply.set_value(reply);
 	return true;
 }
 
@@ -217,14 +338,15 @@ string SCPITransport::SendCommandQueuedWithReply(string cmd, bool endOnSemicolon
  */
 string SCPITransport::SendCommandImmediateWithReply(string cmd, bool endOnSemicolon)
 {
-	lock_guard<recursive_mutex> lock(m_netMutex);
-
-	if(m_rateLimitingEnabled)
-		RateLimitingWait();
+	return RunTransaction<string>(IO_LANE_CONTROL, [&]()
+		{
+			if(m_rateLimitingEnabled)
+				RateLimitingWait();
 
-	SendCommand(cmd);
+			SendCommand(cmd);
 
-	return ReadReply(endOnSemicolon);
+			return ReadReply(endOnSemicolon);
+		});
 }
 
 /**
@@ -232,12 +354,13 @@ string SCPITransport::SendCommandImmediateWithReply(string cmd, bool endOnSemico
  */
 void SCPITransport::SendCommandImmediate(string cmd)
 {
-	lock_guard<recursive_mutex> lock(m_netMutex);
-
-	if(m_rateLimitingEnabled)
-		RateLimitingWait();
+	RunTransaction<bool>(IO_LANE_CONTROL, [&]()
+		{
+			if(m_rateLimitingEnabled)
+				RateLimitingWait();
 
-	SendCommand(cmd);
+			return SendCommand(cmd);
+		});
 }
 
 /**
@@ -245,30 +368,577 @@ void SCPITransport::SendCommandImmediate(string cmd)
  */
 void* SCPITransport::SendCommandImmediateWithRawBlockReply(string cmd, size_t& len)
 {
+	return RunTransaction<void*>(IO_LANE_BULK, [&]() -> void*
+		{
+			if(m_rateLimitingEnabled)
+				RateLimitingWait();
+			SendCommand(cmd);
+
+			if(!ReadBlockHeader(len))
+				return NULL;
+
+			//Read the actual data
+			unsigned char* buf = new unsigned char[len];
+			len = ReadRawData(len, buf);
+			return buf;
+		});
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// I/O thread
+
+/**
+	@brief Starts the I/O thread, which runs transactions posted by callers that found the transport busy
+
+	See the comment on IOLane in SCPITransport.h.
+ */
+void SCPITransport::StartIOThread()
+{
+	lock_guard<mutex> lock(m_ioStartStopMutex);
+	if(m_ioThreadRunning)
+		return;
+
+	{
+		lock_guard<mutex> wakelock(m_ioWakeMutex);
+		m_ioStop = false;
+	}
+	m_ioThread = thread(&SCPITransport::IOThreadProc, this);
+	m_ioThreadRunning = true;
+}
+
+/**
+	@brief Stops the I/O thread after it has run everything already posted to it
+ */
+void SCPITransport::StopIOThread()
+{
+	lock_guard<mutex> lock(m_ioStartStopMutex);
+	if(!m_ioThreadRunning)
+		return;
+
+	//New transactions go straight to the transport from here on
+	m_ioThreadRunning = false;
+
+	{
+		lock_guard<mutex> wakelock(m_ioWakeMutex);
+		m_ioStop = true;
+	}
+	m_ioWake.notify_one();
+	m_ioThread.join();
+}
+
+/**
+	@brief Queues a transaction for whichever thread holds the transport next
+
+	Doesn't allocate anything besides the queue node, and only takes a lock if the I/O thread is asleep.
+
+	@return False if the I/O thread is stopping, in which case the transaction was not queued
+ */
+bool SCPITransport::PostIORequest(IOLane lane, IORequest& req)
+{
+	req.m_posted = chrono::steady_clock::now();
+
+	//Count the request before checking m_ioStop, so the I/O thread can't exit while it's on its way into the queue
+	m_ioDepth[lane] ++;
+	m_ioPending ++;
+	if(m_ioStop)
+	{
+		m_ioDepth[lane] --;
+		m_ioPending --;
+		return false;
+	}
+
+	m_ioQueues[lane].Push(&req);
+
+	//If the I/O thread might be waiting, take the mutex so the notify can't land between its check and its wait
+	if(m_ioSleeping)
+	{
+		lock_guard<mutex> lock(m_ioWakeMutex);
+		m_ioWake.notify_one();
+	}
+	return true;
+}
+
+/**
+	@brief Blocks until a posted request has run, then rethrows anything it threw
+ */
+void SCPITransport::WaitIORequest(IORequest& req)
+{
+	unique_lock<mutex> lock(req.m_doneMutex);
+	req.m_doneCond.wait(lock, [&]{ return req.m_done; });
+
+	if(req.m_error)
+		rethrow_exception(req.m_error);
+}
+
+/**
+	@brief Runs the oldest request in a lane, if there is one
+
+	Caller must hold m_netMutex, which is what makes this the queue's only consumer.
+
+	@return True if a request was run
+ */
+bool SCPITransport::RunIORequest(IOLane lane)
+{
+	//Pop() can transiently fail while a push is halfway done, the depth counter says whether it's worth retrying
+	IORequest* req = NULL;
+	while(!m_ioQueues[lane].Pop(req))
+	{
+		if(m_ioDepth[lane] == 0)
+			return false;
+		this_thread::yield();
+	}
+
+	m_ioDepth[lane] --;
+	m_ioPending --;
+
+	//Update statistics
+	int64_t wait = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - req->m_posted).count();
+	m_ioTotalWaitNs[lane] += wait;
+	int64_t oldmax = m_ioMaxWaitNs[lane];
+	while( (wait > oldmax) && !m_ioMaxWaitNs[lane].compare_exchange_weak(oldmax, wait) )
+	{}
+
+	try
+	{
+		req->m_transaction();
+	}
+	catch(...)
+	{
+		req->m_error = current_exception();
+	}
+	m_ioCompleted[lane] ++;
+
+	//The poster's stack frame goes away as soon as it sees m_done, so this is the last we can touch req
+	lock_guard<mutex> lock(req->m_doneMutex);
+	req->m_done = true;
+	req->m_doneCond.notify_one();
+	return true;
+}
+
+/**
+	@brief Runs every request in a lane, including any posted while doing so
+
+	Caller must hold m_netMutex.
+ */
+void SCPITransport::RunIORequests(IOLane lane)
+{
+	while(RunIORequest(lane))
+	{}
+}
+
+/**
+	@brief Lets control transactions queued by other threads run partway through a long locked sequence
+
+	Call this while holding GetMutex(), between transactions, at a point where other commands going out won't
+	disturb the sequence: no replies outstanding and no multi-command instrument state half set up. Does nothing if
+	the I/O thread isn't running.
+ */
+void SCPITransport::RunQueuedControlRequests()
+{
+	if(!m_ioThreadRunning)
+		return;
+
 	lock_guard<recursive_mutex> lock(m_netMutex);
+	RunIORequests(IO_LANE_CONTROL);
+}
 
-	if(m_rateLimitingEnabled)
-		RateLimitingWait();
-	SendCommand(cmd);
+void SCPITransport::IOThreadProc()
+{
+	while(true)
+	{
+		{
+			unique_lock<mutex> lock(m_ioWakeMutex);
+			m_ioSleeping = true;
+			m_ioWake.wait(lock, [&]{ return m_ioStop || (m_ioPending != 0); });
+			m_ioSleeping = false;
+
+			if(m_ioStop && (m_ioPending == 0))
+				break;
+		}
 
-	//Read the length
-	char tmplen[3] = {0};
-	if(2 != ReadRawData(2, (unsigned char*)tmplen))			//expect #n
-		return NULL;
-	if(tmplen[0] == 0)	//Not sure how this happens, but sometimes occurs on Tek MSO6?
-		return NULL;
-	size_t ndigits = stoull(tmplen+1);
+		//Everything in the control lane first, then one bulk transaction before checking for control work again
+		lock_guard<recursive_mutex> lock(m_netMutex);
+		RunIORequests(IO_LANE_CONTROL);
+		RunIORequest(IO_LANE_BULK);
+	}
+}
+
+/**
+	@brief Gets queue depth and wait time statistics for one lane
+ */
+SCPITransport::IOLaneStats SCPITransport::GetIOLaneStats(IOLane lane)
+{
+	IOLaneStats stats;
+	stats.m_depth = m_ioDepth[lane];
+	stats.m_completed = m_ioCompleted[lane];
+	stats.m_maxWait = m_ioMaxWaitNs[lane] * 1e-9;
+	if(stats.m_completed)
+		stats.m_meanWait = m_ioTotalWaitNs[lane] * 1e-9 / stats.m_completed;
+	else
+		stats.m_meanWait = 0;
+	return stats;
+}
+
+/**
+	@brief Clears the completed count and wait time statistics for all lanes
+ */
+void SCPITransport::ResetIOLaneStats()
+{
+	for(int i=0; i<IO_LANE_COUNT; i++)
+	{
+		m_ioCompleted[i] = 0;
+		m_ioTotalWaitNs[i] = 0;
+		m_ioMaxWaitNs[i] = 0;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Definite-length blocks
+
+/**
+	@brief Reads the "#nddd" header of a definite-length block, skipping any short text prefix in front of it
+
+	@param len	Set to the length of the block data
+
+	@return True on success, false on timeout or if the reply isn't a definite-length block
+ */
+bool SCPITransport::ReadBlockHeader(size_t& len)
+{
+	//Skip up to the '#'. Give up if it doesn't turn up soon, there's probably no block in this reply at all.
+	const size_t maxPrefix = 32;
+	char c = 0;
+	size_t i = 0;
+	for(; i < maxPrefix; i++)
+	{
+		if(1 != ReadRawData(1, (unsigned char*)&c))
+			return false;
+		if(c == '#')
+			break;
+		if(c == 0)	//Not sure how this happens, but sometimes occurs on Tek MSO6?
+			return false;
+	}
+	if(i == maxPrefix)
+	{
+		LogWarning("ReadBlockHeader: no block header found\n");
+		return false;
+	}
+
+	//Number of length digits. Zero means indefinite length, which we don't support.
+	if(1 != ReadRawData(1, (unsigned char*)&c))
+		return false;
+	if( (c < '1') || (c > '9') )
+	{
+		LogWarning("ReadBlockHeader: unsupported block header #%c\n", c);
+		return false;
+	}
+	size_t ndigits = c - '0';
 
 	//Read the digits
 	char digits[10] = {0};
 	if(ndigits != ReadRawData(ndigits, (unsigned char*)digits))
-		return NULL;
+		return false;
 	len = stoull(digits);
 
-	//Read the actual data
-	unsigned char* buf = new unsigned char[len];
-	len = ReadRawData(len, buf);
-	return buf;
+	return true;
+}
+
+/**
+	@brief Reads a definite-length block into a caller-owned buffer
+
+	The buffer is resized to the block length. Reusing the same buffer from one trigger to the next means it only
+	gets reallocated when the block grows.
+
+	@return True on success, false (with an empty buffer) on failure
+ */
+bool SCPITransport::ReadBlock(BlockBuffer& buf)
+{
+	size_t len;
+	if(!ReadBlockHeader(len))
+	{
+		buf.clear();
+		return false;
+	}
+
+	buf.resize(len);
+	if( (len != 0) && (len != ReadRawData(len, &buf[0])) )
+	{
+		buf.clear();
+		return false;
+	}
+
+	return true;
+}
+
+/**
+	@brief Discards the rest of the current reply, up to and including its terminator
+
+	Used to eat the newline after a block read with ReadBlockHeader() / ReadBlock().
+ */
+void SCPITransport::DiscardReplyRemainder()
+{
+	ReadReply(false);
+}
+
+/**
+	@brief Reads len bytes of raw data, handing it to a worker thread a chunk at a time as it arrives
+
+	The calling thread receives the data chunkSize bytes at a time. Each time a chunk is complete, the worker thread
+	calls onChunk() for everything received since its last call, while the next chunk is on the wire. If the worker
+	falls behind, one call may cover several chunks. Ranges always start and end on chunk boundaries, except for the
+	end of the data.
+
+	Returns once all data has been received and the last callback has finished. Caller must hold the transport mutex.
+
+	If the callback throws, it isn't called again for the rest of this read, but the data is still received so the
+	transport stays in sync with the instrument. The exception is logged and the read fails.
+
+	@return True on success. On failure, callbacks may already have been made for the data that did arrive.
+ */
+bool SCPITransport::ReadRawDataStreaming(size_t len, unsigned char* buf, size_t chunkSize, const ChunkCallback& onChunk)
+{
+	if(len == 0)
+		return true;
+
+	{
+		lock_guard<mutex> lock(m_chunkMutex);
+		if(!m_chunkThread.joinable())
+			m_chunkThread = thread(&SCPITransport::ChunkThreadProc, this);
+
+		m_chunkCallback = &onChunk;
+		m_chunkReceived = 0;
+		m_chunkDone = 0;
+		m_chunkFinished = false;
+		m_chunkError = nullptr;
+	}
+
+	bool ok = true;
+	for(size_t off = 0; off < len; )
+	{
+		size_t n = min(chunkSize, len - off);
+		if(n != ReadRawData(n, buf + off))
+		{
+			LogTrace("ReadRawDataStreaming: failed after %zu of %zu bytes\n", off, len);
+			ok = false;
+			break;
+		}
+		off += n;
+
+		{
+			lock_guard<mutex> lock(m_chunkMutex);
+			m_chunkReceived = off;
+		}
+		m_chunkReady.notify_one();
+	}
+
+	//Wait for the worker to catch up
+	exception_ptr error;
+	{
+		unique_lock<mutex> lock(m_chunkMutex);
+		m_chunkFinished = true;
+		m_chunkReady.notify_one();
+		m_chunkIdle.wait(lock, [&]{ return m_chunkCallback == NULL; });
+		swap(error, m_chunkError);
+	}
+
+	if(error)
+	{
+		try
+		{
+			rethrow_exception(error);
+		}
+		catch(const exception& e)
+		{
+			LogError("ReadRawDataStreaming: chunk callback failed: %s\n", e.what());
+		}
+		catch(...)
+		{
+			LogError("ReadRawDataStreaming: chunk callback failed\n");
+		}
+		ok = false;
+	}
+
+	return ok;
+}
+
+/**
+	@brief Worker thread for ReadRawDataStreaming(), runs callbacks for newly received data
+ */
+void SCPITransport::ChunkThreadProc()
+{
+	unique_lock<mutex> lock(m_chunkMutex);
+	while(true)
+	{
+		m_chunkReady.wait(lock, [&]
+			{ return m_chunkExit || ( m_chunkCallback && ( (m_chunkReceived > m_chunkDone) || m_chunkFinished) ); });
+
+		if(m_chunkCallback == NULL)
+			break;
+
+		//Snapshot the state, then run the callback without the lock so the reader can keep going
+		size_t start = m_chunkDone;
+		size_t end = m_chunkReceived;
+		bool last = m_chunkFinished;
+		bool failed = (m_chunkError != nullptr);
+		auto callback = m_chunkCallback;
+		lock.unlock();
+
+		//An exception escaping this thread would terminate the process, so hand it back to the reader instead
+		exception_ptr error;
+		if( (end > start) && !failed )
+		{
+			try
+			{
+				(*callback)(start, end);
+			}
+			catch(...)
+			{
+				error = current_exception();
+			}
+		}
+
+		lock.lock();
+		if(error)
+			m_chunkError = error;
+		m_chunkDone = end;
+		if(last)
+		{
+			m_chunkCallback = NULL;
+			m_chunkIdle.notify_one();
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Buffered receive path
+
+/**
+	@brief Reads whatever data the instrument has sent, blocking until there is at least one byte
+
+	Only transports using ReadBufferedReply() / ReadBufferedRawData() need to implement this.
+
+	@return Number of bytes read, or zero on error or timeout
+ */
+size_t SCPITransport::ReceiveAvailable(unsigned char* /*buf*/, size_t /*len*/)
+{
+	LogError("SCPITransport::ReceiveAvailable is unimplemented\n");
+	return 0;
+}
+
+/**
+	@brief Finds the end of a reply, if there is one within a block of received data
+
+	@return Pointer to the terminating newline (or semicolon), or NULL if the reply continues past the block
+ */
+const char* SCPITransport::FindReplyEnd(const char* buf, size_t len, bool endOnSemicolon)
+{
+	auto eol = static_cast<const char*>(memchr(buf, '\n', len));
+	if(endOnSemicolon)
+	{
+		auto semi = static_cast<const char*>(memchr(buf, ';', eol ? (eol - buf) : len));
+		if(semi)
+			return semi;
+	}
+	return eol;
+}
+
+/**
+	@brief Refills the receive buffer. Must only be called when it's empty.
+
+	@return True if any data was received
+ */
+bool SCPITransport::FillReceiveBuffer()
+{
+	if(m_rxBuffer.empty())
+		m_rxBuffer.resize(RX_BUFFER_SIZE);
+
+	m_rxHead = 0;
+	m_rxTail = ReceiveAvailable(&m_rxBuffer[0], m_rxBuffer.size());
+	return (m_rxTail != 0);
+}
+
+/**
+	@brief Discards any received data that hasn't been read yet
+ */
+void SCPITransport::ClearReceiveBuffer()
+{
+	m_rxHead = 0;
+	m_rxTail = 0;
+}
+
+/**
+	@brief Reads a reply from the receive buffer, refilling it as needed
+
+	The terminator is consumed but not included in the reply.
+	If the connection fails partway through, whatever was received so far is returned.
+ */
+string SCPITransport::ReadBufferedReply(bool endOnSemicolon)
+{
+	string ret;
+	while(true)
+	{
+		const char* start = reinterpret_cast<const char*>(m_rxBuffer.data()) + m_rxHead;
+		size_t avail = m_rxTail - m_rxHead;
+		if(avail)
+		{
+			const char* end = FindReplyEnd(start, avail, endOnSemicolon);
+			if(end)
+			{
+				ret.append(start, end - start);
+				m_rxHead += (end - start) + 1;
+				break;
+			}
+			ret.append(start, avail);
+		}
+
+		if(!FillReceiveBuffer())
+			break;
+	}
+
+	LogTrace("Got %s\n", ret.c_str());
+	return ret;
+}
+
+/**
+	@brief Reads exactly len bytes, starting with anything already in the receive buffer
+
+	Once the buffer is drained, reads at least as big as the buffer go directly into the caller's buffer.
+
+	@return len on success, zero on error or timeout
+ */
+size_t SCPITransport::ReadBufferedRawData(size_t len, unsigned char* buf)
+{
+	size_t done = 0;
+	while(done < len)
+	{
+		size_t avail = m_rxTail - m_rxHead;
+		size_t remaining = len - done;
+
+		if(avail)
+		{
+			size_t n = min(avail, remaining);
+			memcpy(buf + done, &m_rxBuffer[m_rxHead], n);
+			m_rxHead += n;
+			done += n;
+		}
+		else if(remaining >= RX_BUFFER_SIZE)
+		{
+			size_t n = ReceiveAvailable(buf + done, remaining);
+			if(n == 0)
+				break;
+			done += n;
+		}
+		else if(!FillReceiveBuffer())
+			break;
+	}
+
+	if(done < len)
+	{
+		LogTrace("Failed to get %zu bytes (got %zu)\n", len, done);
+		return 0;
+	}
+
+	LogTrace("Got %zu bytes\n", len);
+	return len;
 }
 
 void SCPITransport::FlushRXBuffer(void)
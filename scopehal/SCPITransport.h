@@ -37,6 +37,15 @@
 #define SCPITransport_h
 
 #include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+
+#include "AlignedAllocator.h"
+#include "MPSCQueue.h"
 
 /**
 	@brief Abstraction of a transport layer for moving SCPI data between endpoints
@@ -67,6 +76,138 @@ public:
 	void* SendCommandImmediateWithRawBlockReply(std::string cmd, size_t& len);
 	bool FlushCommandQueue();
 
+	/*
+		Pipelined query API
+
+		Queries queued with SendCommandQueuedWithFutureReply() are sent by the next FlushCommandQueue(), in order with
+		any queued write-only commands. They go out back to back (if the transport supports batching) rather than
+		waiting for each reply before sending the next command, so a burst of N queries costs about one round trip
+		rather than N. Replies are read in order and each one resolves its query's future. If a query gets no reply
+		(e.g. a timeout), its future holds an exception rather than a value.
+
+		Nothing is sent until the queue is flushed, so don't wait on the future before calling FlushCommandQueue().
+	 */
+	std::future<std::string> SendCommandQueuedWithFutureReply(const std::string& cmd, bool endOnSemicolon = true);
+
+	/*
+		Optional I/O thread
+
+		Every transaction made through the queued / immediate API (one command and its reply, one raw block, one
+		queue flush) runs with the transport mutex held. Normally a caller that finds the transport busy just blocks on
+		the mutex, so a GUI thread changing a setting waits behind a whole multi-channel waveform download.
+
+		With the I/O thread running, a caller that finds the transport busy instead posts its transaction to a
+		lock-free queue and waits for the result. There are two priority lanes. The I/O thread runs everything in the
+		control lane, then one bulk transaction, then checks the control lane again. Uncontended transactions, and
+		transactions made by a thread which already holds the transport, still run directly on the calling thread, and
+		the synchronous API is unchanged.
+
+		Queued transactions never run in the middle of another thread's locked sequence on their own. A driver which
+		holds GetMutex() across a long download can call RunQueuedControlRequests() at points where it's safe for
+		other commands to go out (no replies outstanding, no multi-command state half set up) to let control traffic
+		through between waveform blocks.
+
+		The thread is off by default, applications opt in with StartIOThread().
+
+		Drivers which call SendCommand() / ReadReply() directly must hold GetMutex() while doing so, as always.
+		Every concrete transport must call StopIOThread() at the start of its destructor.
+	 */
+	enum IOLane
+	{
+		IO_LANE_CONTROL,	//Settings changes and small queries
+		IO_LANE_BULK,		//Waveform downloads
+
+		IO_LANE_COUNT
+	};
+
+	void StartIOThread();
+	void StopIOThread();
+
+	bool IsIOThreadRunning()
+	{ return m_ioThreadRunning; }
+
+	/**
+		@brief Runs one transaction with exclusive use of the transport, returning its result
+
+		If the I/O thread is running and the transport is busy, the transaction is queued in the given lane rather
+		than blocking on the transport mutex.
+	 */
+	template<class R>
+	R RunTransaction(IOLane lane, const std::function<R()>& transaction)
+	{
+		if(!m_ioThreadRunning)
+		{
+			std::lock_guard<std::recursive_mutex> lock(m_netMutex);
+			return transaction();
+		}
+
+		//(try_lock succeeds if we already hold the mutex, so there's no risk of waiting on ourselves)
+		std::unique_lock<std::recursive_mutex> lock(m_netMutex, std::try_to_lock);
+		if(lock.owns_lock())
+			return transaction();
+
+		//Transport is busy, hand the transaction to whoever has it next and wait.
+		//The request and the result live on our stack since we don't return until the transaction has run.
+		R result;
+		IORequest req;
+		req.m_transaction = [&result, &transaction]() { result = transaction(); };
+		if(PostIORequest(lane, req))
+		{
+			WaitIORequest(req);
+			return result;
+		}
+
+		//I/O thread is shutting down, wait our turn the old way
+		lock.lock();
+		return transaction();
+	}
+
+	void RunQueuedControlRequests();
+
+	///@brief Statistics for one lane of the I/O queue
+	struct IOLaneStats
+	{
+		///@brief Transactions currently waiting
+		size_t m_depth;
+
+		///@brief Transactions run since the last reset
+		size_t m_completed;
+
+		///@brief Mean time from posting to starting a transaction, in seconds
+		double m_meanWait;
+
+		///@brief Longest time from posting to starting a transaction, in seconds
+		double m_maxWait;
+	};
+
+	IOLaneStats GetIOLaneStats(IOLane lane);
+	void ResetIOLaneStats();
+
+	/*
+		Definite-length block API (IEEE 488.2 "#9000001234<data>" replies)
+
+		ReadBlockHeader() skips a short text prefix (e.g. "DAT1,"), parses the length header, and leaves the
+		transport positioned at the first byte of data. The caller can then ReadRawData() the payload straight into
+		wherever it's going, rather than through a temporary string. ReadBlock() does the same into a reusable
+		aligned buffer, which only reallocates when it has to grow. Either way DiscardReplyRemainder() then eats the
+		terminator after the block.
+
+		Caller must hold the transport mutex across the whole sequence.
+	 */
+	typedef std::vector<unsigned char, AlignedAllocator<unsigned char, 64> > BlockBuffer;
+	bool ReadBlockHeader(size_t& len);
+	bool ReadBlock(BlockBuffer& buf);
+	virtual void DiscardReplyRemainder();
+
+	/*
+		Streaming reads, so the caller can process the start of a big block while the rest is still on the wire.
+		The callback is given each newly received range [start, end) of the buffer, in order, on a worker thread.
+		The worker is started on first use and lives as long as the transport, so it (and any OpenMP team it spins
+		up) is reused across channels and acquisitions.
+	 */
+	typedef std::function<void(size_t start, size_t end)> ChunkCallback;
+	bool ReadRawDataStreaming(size_t len, unsigned char* buf, size_t chunkSize, const ChunkCallback& onChunk);
+
 	//Manual mutex locking for ReadRawData() etc
 	std::recursive_mutex& GetMutex()
 	{ return m_netMutex; }
@@ -128,14 +269,85 @@ public:
 protected:
 	void RateLimitingWait();
 
+	/*
+		Buffered receive path for stream transports.
+
+		Transports which can read whatever data is waiting, rather than an exact byte count, override
+		ReceiveAvailable() and implement ReadReply() and ReadRawData() with ReadBufferedReply() and
+		ReadBufferedRawData(). Replies are then found with memchr() over a block of received data instead of one
+		recv() per byte, and bulk reads go straight into the caller's buffer.
+	 */
+	virtual size_t ReceiveAvailable(unsigned char* buf, size_t len);
+	std::string ReadBufferedReply(bool endOnSemicolon);
+	size_t ReadBufferedRawData(size_t len, unsigned char* buf);
+	bool FillReceiveBuffer();
+	void ClearReceiveBuffer();
+
+	static const char* FindReplyEnd(const char* buf, size_t len, bool endOnSemicolon);
+
 	//Class enumeration
 	typedef std::map< std::string, CreateProcType > CreateMapType;
 	static CreateMapType m_createprocs;
 
-	//Queued commands waiting to be sent
+	//Queued commands and queries waiting to be sent, in submission order. Protected by m_queueMutex.
+	struct QueuedCommand
+	{
+		std::string m_cmd;
+		bool m_isQuery;
+		bool m_endOnSemicolon;
+		std::promise<std::string> m_reply;	//only used for queries
+	};
 	std::mutex m_queueMutex;
 	std::recursive_mutex m_netMutex;
-	std::list<std::string> m_txQueue;
+	std::list<QueuedCommand> m_txQueue;
+
+	bool ReadQueuedReply(QueuedCommand& query);
+
+	//I/O thread and its request queues. Requests belong to the thread that posted them, which waits on m_done.
+	struct IORequest
+	{
+		IORequest()
+		: m_done(false)
+		{}
+
+		std::function<void()> m_transaction;
+		std::chrono::steady_clock::time_point m_posted;
+		std::exception_ptr m_error;
+
+		bool m_done;
+		std::mutex m_doneMutex;
+		std::condition_variable m_doneCond;
+	};
+
+	bool PostIORequest(IOLane lane, IORequest& req);
+	void WaitIORequest(IORequest& req);
+	bool RunIORequest(IOLane lane);
+	void RunIORequests(IOLane lane);
+	void IOThreadProc();
+
+	//Requests are only ever popped by whichever thread holds m_netMutex, so there's a single consumer
+	MPSCQueue<IORequest*> m_ioQueues[IO_LANE_COUNT];
+
+	std::thread m_ioThread;
+	std::atomic<bool> m_ioThreadRunning;
+
+	//Serializes StartIOThread() / StopIOThread(), held across the join so a restart can't race a stop
+	std::mutex m_ioStartStopMutex;
+
+	//Wakes the I/O thread. Posting is lock-free: the poster bumps m_ioPending and then only takes m_ioWakeMutex if
+	//m_ioSleeping says the I/O thread may be about to wait. The I/O thread sets m_ioSleeping before checking
+	//m_ioPending, so one side always sees the other.
+	std::mutex m_ioWakeMutex;
+	std::condition_variable m_ioWake;
+	std::atomic<size_t> m_ioPending;
+	std::atomic<bool> m_ioSleeping;
+	std::atomic<bool> m_ioStop;
+
+	//Queue statistics, per lane
+	std::atomic<size_t> m_ioDepth[IO_LANE_COUNT];
+	std::atomic<size_t> m_ioCompleted[IO_LANE_COUNT];
+	std::atomic<int64_t> m_ioTotalWaitNs[IO_LANE_COUNT];
+	std::atomic<int64_t> m_ioMaxWaitNs[IO_LANE_COUNT];
 
 	//Set of commands that are OK to deduplicate
 	std::set<std::string> m_dedupCommands;
@@ -144,6 +356,24 @@ protected:
 	bool m_rateLimitingEnabled;
 	std::chrono::system_clock::time_point m_nextCommandReady;
 	std::chrono::milliseconds m_rateLimitingInterval;
+
+	//Received data not yet consumed by ReadReply() / ReadRawData(), valid from m_rxHead to m_rxTail
+	std::vector<unsigned char> m_rxBuffer;
+	size_t m_rxHead;
+	size_t m_rxTail;
+
+	//Worker thread for ReadRawDataStreaming(), all state protected by m_chunkMutex
+	void ChunkThreadProc();
+	std::thread m_chunkThread;
+	std::mutex m_chunkMutex;
+	std::condition_variable m_chunkReady;
+	std::condition_variable m_chunkIdle;
+	const ChunkCallback* m_chunkCallback;	//Callback for the read in progress, NULL when idle
+	size_t m_chunkReceived;					//Bytes of the current read received so far
+	size_t m_chunkDone;						//Bytes of the current read passed to the callback so far
+	bool m_chunkFinished;					//True once the reader has stopped receiving
+	std::exception_ptr m_chunkError;		//Exception thrown by the callback for the current read, if any
+	bool m_chunkExit;
 };
 
 #define TRANSPORT_INITPROC(T) \
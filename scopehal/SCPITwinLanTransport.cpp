@@ -56,6 +56,7 @@ SCPITwinLanTransport::SCPITwinLanTransport(const string& args)
 
 SCPITwinLanTransport::~SCPITwinLanTransport()
 {
+	StopIOThread();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -35,6 +35,10 @@
 
 #include "scopehal.h"
 
+#ifndef _WIN32
+#include <sys/ioctl.h>
+#endif
+
 using namespace std;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -68,6 +72,7 @@ SCPIUARTTransport::SCPIUARTTransport(const string& args)
 
 SCPIUARTTransport::~SCPIUARTTransport()
 {
+	StopIOThread();
 }
 
 bool SCPIUARTTransport::IsConnected()
@@ -99,21 +104,7 @@ bool SCPIUARTTransport::SendCommand(const string& cmd)
 
 string SCPIUARTTransport::ReadReply(bool endOnSemicolon)
 {
-	//FIXME: there *has* to be a more efficient way to do this...
-	// (see the same code in Socket)
-	char tmp = ' ';
-	string ret;
-	while(true)
-	{
-		if(!m_uart.Read((unsigned char*)&tmp, 1))
-			break;
-		if( (tmp == '\n') || ( (tmp == ';') && endOnSemicolon ) )
-			break;
-		else
-			ret += tmp;
-	}
-	LogTrace("Got %s\n", ret.c_str());
-	return ret;
+	return ReadBufferedReply(endOnSemicolon);
 }
 
 void SCPIUARTTransport::SendRawData(size_t len, const unsigned char* buf)
@@ -123,11 +114,57 @@ void SCPIUARTTransport::SendRawData(size_t len, const unsigned char* buf)
 
 size_t SCPIUARTTransport::ReadRawData(size_t len, unsigned char* buf)
 {
-	if(!m_uart.Read(buf, len))
+	//Use up anything ReceiveAvailable() buffered past the end of the last reply, then read the rest in one call
+	size_t done = min(len, m_rxTail - m_rxHead);
+	if(done)
+	{
+		memcpy(buf, &m_rxBuffer[m_rxHead], done);
+		m_rxHead += done;
+	}
+
+	if( (done < len) && !m_uart.Read(buf + done, len - done) )
 		return 0;
 	return len;
 }
 
+/**
+	@brief Reads whatever the instrument has sent, blocking until there is at least one byte
+
+	The UART API only does exact-length reads, and asking for more than the instrument has sent would block. So we
+	wait for one byte, then read however many more the driver says have already arrived.
+ */
+size_t SCPIUARTTransport::ReceiveAvailable(unsigned char* buf, size_t len)
+{
+	if( (len == 0) || !m_uart.Read(buf, 1) )
+		return 0;
+
+	size_t extra = min(len - 1, m_uart.GetBytesAvailable());
+	if( extra && !m_uart.Read(buf + 1, extra) )
+		return 0;
+	return 1 + extra;
+}
+
+/**
+	@brief Gets the number of bytes received by the serial driver which haven't been read yet
+
+	Returns zero if that can't be determined (e.g. for a UART tunneled over a network socket).
+ */
+size_t SCPIUART::GetBytesAvailable()
+{
+#ifdef _WIN32
+	COMSTAT stat;
+	DWORD errors;
+	if(!ClearCommError(m_fd, &errors, &stat))
+		return 0;
+	return stat.cbInQue;
+#else
+	int n = 0;
+	if(ioctl(m_fd, FIONREAD, &n) < 0)
+		return 0;
+	return n;
+#endif
+}
+
 bool SCPIUARTTransport::IsCommandBatchingSupported()
 {
 	return true;
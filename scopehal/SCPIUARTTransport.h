@@ -38,6 +38,15 @@
 
 #include "../xptools/UART.h"
 
+/**
+	@brief UART which can also report how many received bytes are waiting to be read
+ */
+class SCPIUART : public UART
+{
+public:
+	size_t GetBytesAvailable();
+};
+
 /**
 	@brief Abstraction of a transport layer for moving SCPI data between endpoints
  */
@@ -61,7 +70,9 @@ public:
 	TRANSPORT_INITPROC(SCPIUARTTransport)
 
 protected:
-	UART m_uart;
+	virtual size_t ReceiveAvailable(unsigned char* buf, size_t len);
+
+	SCPIUART m_uart;
 
 	std::string m_devfile;
 	unsigned int m_baudrate;
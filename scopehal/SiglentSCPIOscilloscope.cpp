@@ -91,6 +91,9 @@
 
 using namespace std;
 
+//Waveforms are converted this many bytes at a time while downloading
+static const size_t WAVEFORM_CHUNK_SIZE = 1024 * 1024;
+
 static const struct
 {
 	const char* name;
@@ -1283,7 +1286,12 @@ Oscilloscope::TriggerMode SiglentSCPIOscilloscope::PollTrigger()
 	return TRIGGER_MODE_RUN;
 }
 
-int SiglentSCPIOscilloscope::ReadWaveformBlock(uint32_t maxsize, char* data, bool hdSizeWorkaround)
+/**
+	@brief Reads the length header of a waveform block
+
+	@return Length of the block data, in bytes
+ */
+uint32_t SiglentSCPIOscilloscope::ReadWaveformBlockHeader(bool hdSizeWorkaround)
 {
 	char packetSizeSequence[17];
 	uint32_t getLength;
@@ -1310,19 +1318,69 @@ int SiglentSCPIOscilloscope::ReadWaveformBlock(uint32_t maxsize, char* data, boo
 	LogTrace("INITIAL PACKET [%s]\n", packetSizeSequence);
 	getLength = atoi(packetSizeSequence);
 
-	uint32_t len = getLength;
 	if(hdSizeWorkaround)
-		len *= 2;
-	len = min(len, maxsize);
+		return getLength*2;
+	return getLength;
+}
+
+int SiglentSCPIOscilloscope::ReadWaveformBlock(uint32_t maxsize, char* data, bool hdSizeWorkaround)
+{
+	uint32_t getLength = ReadWaveformBlockHeader(hdSizeWorkaround);
 
 	// Now get the data
-	m_transport->ReadRawData(len, (unsigned char*)data);
+	m_transport->ReadRawData(min(getLength, maxsize), (unsigned char*)data);
 
-	if(hdSizeWorkaround)
-		return getLength*2;
 	return getLength;
 }
 
+/**
+	@brief Downloads one analog channel's waveform block into m_analogWaveformData, converting it as it arrives
+
+	Each chunk is converted on a worker thread while the next one is still on the wire.
+
+	@param i			Channel index
+	@param segments		Waveform(s) to convert into, one per segment. Resized here once the length is known.
+	@param sixteenBit	True for 16-bit samples, false for 8-bit
+	@param gain			Volts per LSB
+	@param offset		Offset subtracted from the scaled sample to get volts
+	@param hdSizeWorkaround	True if the length header is in 16-bit words rather than bytes
+
+	@return True on success
+ */
+bool SiglentSCPIOscilloscope::DownloadAnalogWaveform(
+	size_t i,
+	vector<WaveformBase*>& segments,
+	bool sixteenBit,
+	float gain,
+	float offset,
+	bool hdSizeWorkaround)
+{
+	uint32_t len = min(ReadWaveformBlockHeader(hdSizeWorkaround), (uint32_t)WAVEFORM_SIZE);
+	m_analogWaveformDataSize[i] = len;
+
+	size_t num_samples = sixteenBit ? len/2 : len;
+	size_t num_per_segment = num_samples / segments.size();
+	for(auto w : segments)
+		w->Resize(num_per_segment);
+
+	auto data = (unsigned char*)m_analogWaveformData[i];
+	bool ok = m_transport->ReadRawDataStreaming(
+		len,
+		data,
+		WAVEFORM_CHUNK_SIZE,
+		[&](size_t start, size_t end)
+		{ ConvertSegmentedSamples(segments, data, start, end, sixteenBit, gain, offset); });
+
+	//This is the 0x0a0a at the end. If the block itself failed, don't wait for a trailer that may never come.
+	if(ok)
+	{
+		char tmp[2];
+		m_transport->ReadRawData(2, (unsigned char*)tmp);
+	}
+
+	return ok;
+}
+
 /**
 	@brief Optimized function for checking channel enable status en masse with less round trips to the scope
  */
@@ -1453,14 +1511,19 @@ time_t SiglentSCPIOscilloscope::ExtractTimestamp(unsigned char* wavedesc, double
 	return mktime(&tstruc);
 }
 
-vector<WaveformBase*> SiglentSCPIOscilloscope::ProcessAnalogWaveform(const char* data,
-	size_t datalen,
-	char* wavedesc,
+/**
+	@brief Sets up the waveform(s) for one channel from its wavedesc, ready for DownloadAnalogWaveform() to fill
+
+	@param v_gain	Set to the volts per LSB
+	@param v_off	Set to the offset subtracted from the scaled sample to get volts
+ */
+vector<WaveformBase*> SiglentSCPIOscilloscope::AllocateAnalogWaveforms(char* wavedesc,
 	uint32_t num_sequences,
 	time_t ttime,
 	double basetime,
 	double* wavetime,
-	int /* ch */)
+	float& v_gain,
+	float& v_off)
 {
 	vector<WaveformBase*> ret;
 
@@ -1468,10 +1531,10 @@ vector<WaveformBase*> SiglentSCPIOscilloscope::ProcessAnalogWaveform(const char*
 	auto pdesc = wavedesc;
 
 	//cppcheck-suppress invalidPointerCast
-	float v_gain = *reinterpret_cast<float*>(pdesc + 156);
+	v_gain = *reinterpret_cast<float*>(pdesc + 156);
 
 	//cppcheck-suppress invalidPointerCast
-	float v_off = *reinterpret_cast<float*>(pdesc + 160);
+	v_off = *reinterpret_cast<float*>(pdesc + 160);
 
 	//cppcheck-suppress invalidPointerCast
 	float v_probefactor = *reinterpret_cast<float*>(pdesc + 328);
@@ -1489,16 +1552,6 @@ vector<WaveformBase*> SiglentSCPIOscilloscope::ProcessAnalogWaveform(const char*
 	if(h_off_frac < 0)
 		h_off_frac = h_off;	   //interval + h_off_frac;	   //double h_unit = *reinterpret_cast<double*>(pdesc + 244);
 
-	//Raw waveform data
-	size_t num_samples;
-	if(m_highDefinition)
-		num_samples = datalen / 2;
-	else
-		num_samples = datalen;
-	size_t num_per_segment = num_samples / num_sequences;
-	int16_t* wdata = (int16_t*)&data[0];
-	int8_t* bdata = (int8_t*)&data[0];
-
 	// SDS2000X+ and SDS5000X have 30 codes per div. Todo; SDS6000X has 425.
 	// We also need to accomodate probe attenuation here.
 	v_gain = v_gain * v_probefactor / 30;
@@ -1516,18 +1569,17 @@ vector<WaveformBase*> SiglentSCPIOscilloscope::ProcessAnalogWaveform(const char*
 	// m_triggerOffset = ((interval * datalen) / 2) + h_off;
 	// m_triggerOffsetValid = true;
 
-	LogTrace("\nV_Gain=%f, V_Off=%f, interval=%f, h_off=%f, h_off_frac=%f, datalen=%ld\n",
+	LogTrace("\nV_Gain=%f, V_Off=%f, interval=%f, h_off=%f, h_off_frac=%f\n",
 		v_gain,
 		v_off,
 		interval,
 		h_off,
-		h_off_frac,
-		datalen);
+		h_off_frac);
 
 	for(size_t j = 0; j < num_sequences; j++)
 	{
 		//Set up the capture we're going to store our data into
-		AnalogWaveform* cap = new AnalogWaveform;
+		AnalogWaveform* cap = WaveformPool::Get<AnalogWaveform>();
 		cap->m_timescale = round(interval);
 
 		cap->m_triggerPhase = h_off_frac;
@@ -1540,32 +1592,6 @@ vector<WaveformBase*> SiglentSCPIOscilloscope::ProcessAnalogWaveform(const char*
 		else
 			cap->m_startFemtoseconds = static_cast<int64_t>(basetime * FS_PER_SECOND);
 
-		cap->Resize(num_per_segment);
-
-		//Convert raw ADC samples to volts
-		if(m_highDefinition)
-		{
-			Convert16BitSamples((int64_t*)&cap->m_offsets[0],
-				(int64_t*)&cap->m_durations[0],
-				(float*)&cap->m_samples[0],
-				wdata + j * num_per_segment,
-				v_gain,
-				v_off,
-				num_per_segment,
-				0);
-		}
-		else
-		{
-			Convert8BitSamples((int64_t*)&cap->m_offsets[0],
-				(int64_t*)&cap->m_durations[0],
-				(float*)&cap->m_samples[0],
-				bdata + j * num_per_segment,
-				v_gain,
-				v_off,
-				num_per_segment,
-				0);
-		}
-
 		ret.push_back(cap);
 	}
 
@@ -1653,7 +1679,7 @@ map<int, DigitalWaveform*> SiglentSCPIOscilloscope::ProcessDigitalWaveform(strin
 	{
 		if(enabledChannels[i])
 		{
-			DigitalWaveform* cap = new DigitalWaveform;
+			DigitalWaveform* cap = WaveformPool::Get<DigitalWaveform>();
 			cap->m_timescale = interval;
 			cap->m_densePacked = true;
 
@@ -1737,9 +1763,8 @@ bool SiglentSCPIOscilloscope::AcquireData()
 	string wavetime;
 	bool enabled[8] = {false};
 	double* pwtime = NULL;
-	char tmp[128];
 
-	//Acquire the data (but don't parse it)
+	//Acquire the data
 
 	lock_guard<recursive_mutex> lock(m_transport->GetMutex());
 	start = GetTime();
@@ -1762,15 +1787,39 @@ bool SiglentSCPIOscilloscope::AcquireData()
 				any_enabled |= enabled[i];
 			}
 			start = GetTime();
+
+			//Download and convert each waveform (conversion is overlapped with the download)
+			waveforms.resize(m_analogChannelCount);
 			for(unsigned int i = 0; i < m_analogChannelCount; i++)
 			{
 				if(enabled[i])
 				{
+					AnalogWaveform* cap = WaveformPool::Get<AnalogWaveform>();
+					cap->m_timescale = FS_PER_SECOND / m_sampleRate;
+					// no high res timer on scope ?
+					cap->m_triggerPhase = h_off_frac;
+					cap->m_startTimestamp = time(NULL);
+					cap->m_densePacked = true;
+					// Fixme
+					cap->m_startFemtoseconds = (start - floor(start)) * FS_PER_SECOND;
+					waveforms[i].push_back(cap);
+
+					//Previous channel is fully read, let any queued settings changes through before the next one
+					m_transport->RunQueuedControlRequests();
+
 					m_transport->SendCommand("C" + to_string(i + 1) + ":WAVEFORM? DAT2");
 					// length of data is current memory depth
-					m_analogWaveformDataSize[i] = ReadWaveformBlock(WAVEFORM_SIZE, m_analogWaveformData[i]);
-					// This is the 0x0a0a at the end
-					m_transport->ReadRawData(2, (unsigned char*)tmp);
+					if(!DownloadAnalogWaveform(
+						i, waveforms[i], false, m_channelVoltageRanges[i] / (8 * 25), m_channelOffsets[i]))
+					{
+						LogError("failed to download analog waveform\n");
+						for(auto& w : waveforms)
+						{
+							for(auto p : w)
+								WaveformPool::Return(p);
+						}
+						return false;
+					}
 				}
 			}
 			//At this point all data has been read so the scope is free to go do
@@ -1782,38 +1831,6 @@ bool SiglentSCPIOscilloscope::AcquireData()
 				m_triggerArmed = true;
 			}
 
-			//Process analog waveforms
-			waveforms.resize(m_analogChannelCount);
-			for(unsigned int i = 0; i < m_analogChannelCount; i++)
-			{
-				std::vector<WaveformBase*> ret;
-				if(m_channelsEnabled[i])
-				{
-					AnalogWaveform* cap = new AnalogWaveform;
-					cap->m_timescale = FS_PER_SECOND / m_sampleRate;
-					// no high res timer on scope ?
-					cap->m_triggerPhase = h_off_frac;
-					cap->m_startTimestamp = time(NULL);
-					;
-					cap->m_densePacked = true;
-					// Fixme
-					cap->m_startFemtoseconds = (start - floor(start)) * FS_PER_SECOND;
-
-					cap->Resize(m_analogWaveformDataSize[i]);
-
-					Convert8BitSamples((int64_t*)&cap->m_offsets[0],
-						(int64_t*)&cap->m_durations[0],
-						(float*)&cap->m_samples[0],
-						(int8_t*)m_analogWaveformData[i],
-						m_channelVoltageRanges[i] / (8 * 25),
-						m_channelOffsets[i],
-						m_analogWaveformDataSize[i],
-						0);
-					ret.push_back(cap);
-				}
-				waveforms[i] = ret;
-			}
-
 			//Save analog waveform data
 			for(unsigned int i = 0; i < m_analogChannelCount; i++)
 			{
@@ -1894,15 +1911,31 @@ bool SiglentSCPIOscilloscope::AcquireData()
 				if( (m_modelid == MODEL_SIGLENT_SDS2000XP) && m_highDefinition)
 					hdWorkaround = true;
 
-				//Read the data from each analog waveform
+				//Read the data from each analog waveform, converting it as it comes in
+				waveforms.resize(m_analogChannelCount);
 				for(unsigned int i = 0; i < m_analogChannelCount; i++)
 				{
 					if(enabled[i])
 					{
+						float v_gain;
+						float v_off;
+						waveforms[i] = AllocateAnalogWaveforms(
+							&m_wavedescs[i][0], num_sequences, ttime, basetime, pwtime, v_gain, v_off);
+
+						//Previous channel is fully read, let any queued settings changes through before the next one
+						m_transport->RunQueuedControlRequests();
+
 						m_transport->SendCommand(":WAVEFORM:SOURCE C" + to_string(i + 1) + ";:WAVEFORM:DATA?");
-						m_analogWaveformDataSize[i] = ReadWaveformBlock(WAVEFORM_SIZE, m_analogWaveformData[i], hdWorkaround);
-						// This is the 0x0a0a at the end
-						m_transport->ReadRawData(2, (unsigned char*)tmp);
+						if(!DownloadAnalogWaveform(i, waveforms[i], m_highDefinition, v_gain, v_off, hdWorkaround))
+						{
+							LogError("failed to download analog waveform\n");
+							for(auto& w : waveforms)
+							{
+								for(auto p : w)
+									WaveformPool::Return(p);
+							}
+							return false;
+						}
 					}
 				}
 			}
@@ -1912,7 +1945,12 @@ bool SiglentSCPIOscilloscope::AcquireData()
 			{
 				if(!ReadWaveformBlock(WAVEFORM_SIZE, m_digitalWaveformDataBytes))
 				{
-					LogDebug("failed to download digital waveform\n");
+					LogError("failed to download digital waveform\n");
+					for(auto& w : waveforms)
+					{
+						for(auto p : w)
+							WaveformPool::Return(p);
+					}
 					return false;
 				}
 			}
@@ -1925,23 +1963,6 @@ bool SiglentSCPIOscilloscope::AcquireData()
 				m_triggerArmed = true;
 			}
 
-			//Process analog waveforms
-			waveforms.resize(m_analogChannelCount);
-			for(unsigned int i = 0; i < m_analogChannelCount; i++)
-			{
-				if(enabled[i])
-				{
-					waveforms[i] = ProcessAnalogWaveform(&m_analogWaveformData[i][0],
-						m_analogWaveformDataSize[i],
-						&m_wavedescs[i][0],
-						num_sequences,
-						ttime,
-						basetime,
-						pwtime,
-						i);
-				}
-			}
-
 			//Save analog waveform data
 			for(unsigned int i = 0; i < m_analogChannelCount; i++)
 			{
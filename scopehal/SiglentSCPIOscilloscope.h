@@ -254,7 +254,14 @@ protected:
 	std::string GetPossiblyEmptyString(const std::string& property);
 
 	//  bool ReadWaveformBlock(std::string& data);
+	uint32_t ReadWaveformBlockHeader(bool hdSizeWorkaround = false);
 	int ReadWaveformBlock(uint32_t maxsize, char* data, bool hdSizeWorkaround = false);
+	bool DownloadAnalogWaveform(size_t i,
+		std::vector<WaveformBase*>& segments,
+		bool sixteenBit,
+		float gain,
+		float offset,
+		bool hdSizeWorkaround = false);
 	//  	bool ReadWavedescs(
 	//		std::vector<std::string>& wavedescs,
 	//		bool* enabled,
@@ -266,14 +273,13 @@ protected:
 	void RequestWaveforms(bool* enabled, uint32_t num_sequences, bool denabled);
 	time_t ExtractTimestamp(unsigned char* wavedesc, double& basetime);
 
-	std::vector<WaveformBase*> ProcessAnalogWaveform(const char* data,
-		size_t datalen,
-		char* wavedesc,
+	std::vector<WaveformBase*> AllocateAnalogWaveforms(char* wavedesc,
 		uint32_t num_sequences,
 		time_t ttime,
 		double basetime,
 		double* wavetime,
-		int i);
+		float& v_gain,
+		float& v_off);
 	std::map<int, DigitalWaveform*> ProcessDigitalWaveform(std::string& data);
 
 	//hardware analog channel count, independent of LA option etc
@@ -1293,7 +1293,7 @@ bool TektronixOscilloscope::AcquireData()
 				{
 					auto vec = it.second;
 					for(auto w : vec)
-						delete w;
+						WaveformPool::Return(w);
 				}
 				return false;
 			}
@@ -1328,7 +1328,7 @@ bool TektronixOscilloscope::AcquireData()
 
 			//Set up the capture we're going to store our data into
 			//(no TDC data available on Tektronix scopes?)
-			AnalogWaveform* cap = new AnalogWaveform;
+			AnalogWaveform* cap = WaveformPool::Get<AnalogWaveform>();
 			cap->m_timescale = fs_per_sample;
 			cap->m_triggerPhase = 0;
 			cap->m_startTimestamp = time(NULL);
@@ -1539,7 +1539,7 @@ bool TektronixOscilloscope::AcquireDataMSO56(map<int, vector<WaveformBase*> >& p
 
 			//Set up the capture we're going to store our data into
 			//(no TDC data or fine timestamping available on Tektronix scopes?)
-			AnalogWaveform* cap = new AnalogWaveform;
+			AnalogWaveform* cap = WaveformPool::Get<AnalogWaveform>();
 			cap->m_densePacked = true;
 			cap->m_timescale = timebase;
 			cap->m_triggerPhase = 0;
@@ -1648,7 +1648,7 @@ bool TektronixOscilloscope::AcquireDataMSO56(map<int, vector<WaveformBase*> >& p
 
 			//Set up the capture we're going to store our data into
 			//(no TDC data or fine timestamping available on Tektronix scopes?)
-			AnalogWaveform* cap = new AnalogWaveform;
+			AnalogWaveform* cap = WaveformPool::Get<AnalogWaveform>();
 			cap->m_timescale = preamble.hzbase;
 			cap->m_triggerPhase = 0;
 			cap->m_startTimestamp = time(NULL);
@@ -1776,7 +1776,7 @@ bool TektronixOscilloscope::AcquireDataMSO56(map<int, vector<WaveformBase*> >& p
 			{
 				//Set up the capture we're going to store our data into
 				//(no TDC data or fine timestamping available on Tektronix scopes?)
-				DigitalWaveform* cap = new DigitalWaveform;
+				DigitalWaveform* cap = WaveformPool::Get<DigitalWaveform>();
 				cap->m_timescale = timebase;
 				cap->m_triggerPhase = 0;
 				cap->m_startTimestamp = time(NULL);
@@ -43,6 +43,8 @@ using namespace std;
 VICPSocketTransport::VICPSocketTransport(const string& args)
 	: m_nextSequence(1)
 	, m_lastSequence(1)
+	, m_frameRemaining(0)
+	, m_frameEOI(true)
 	, m_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)
 {
 	char hostname[128];
@@ -81,6 +83,7 @@ VICPSocketTransport::VICPSocketTransport(const string& args)
 
 VICPSocketTransport::~VICPSocketTransport()
 {
+	StopIOThread();
 }
 
 bool VICPSocketTransport::IsConnected()
@@ -143,44 +146,75 @@ bool VICPSocketTransport::SendCommand(const string& cmd)
 	return true;
 }
 
+/**
+	@brief Reads the header of the next frame from the instrument
+
+	@return True on success, false on timeout or a malformed header
+ */
+bool VICPSocketTransport::ReadFrameHeader()
+{
+	m_frameRemaining = 0;
+
+	unsigned char header[8];
+	if(!m_socket.RecvLooped(header, 8))
+		return false;
+
+	//Sanity check
+	if(header[1] != 1)
+	{
+		LogError("Bad VICP protocol version\n");
+		return false;
+	}
+	if(header[2] != m_lastSequence)
+	{
+		//LogError("Bad VICP sequence number %d (expected %d)\n", header[2], m_lastSequence);
+		//return false;
+	}
+	if(header[3] != 0)
+	{
+		LogError("Bad VICP reserved field\n");
+		return false;
+	}
+
+	m_frameEOI = (header[0] & OP_EOI) != 0;
+	m_frameRemaining = (header[4] << 24) | (header[5] << 16) | (header[6] << 8) | header[7];
+	return true;
+}
+
 string VICPSocketTransport::ReadReply(bool /*endOnSemicolon*/)	//ignore endOnSemicolon, VICP has different framing
 {
 	string payload;
+
+	//If ReadRawData() stopped partway through a frame, pick up where it left off
+	if(m_frameRemaining)
+	{
+		payload.resize(m_frameRemaining);
+		if(!m_socket.RecvLooped((unsigned char*)&payload[0], m_frameRemaining))
+			payload = "";
+		m_frameRemaining = 0;
+		if(m_frameEOI)
+			return payload;
+	}
+
 	while(true)
 	{
 		//Read the header
-		unsigned char header[8];
-		ReadRawData(8, header);
-
-		//Sanity check
-		if(header[1] != 1)
-		{
-			LogError("Bad VICP protocol version\n");
+		if(!ReadFrameHeader())
 			return "";
-		}
-		if(header[2] != m_lastSequence)
-		{
-			//LogError("Bad VICP sequence number %d (expected %d)\n", header[2], m_lastSequence);
-			//return "";
-		}
-		if(header[3] != 0)
-		{
-			LogError("Bad VICP reserved field\n");
-			return "";
-		}
 
 		//Read the message data
-		uint32_t len = (header[4] << 24) | (header[5] << 16) | (header[6] << 8) | header[7];
+		uint32_t len = m_frameRemaining;
 		size_t current_size = payload.size();
 		payload.resize(current_size + len);
 		char* rxbuf = &payload[current_size];
-		ReadRawData(len, (unsigned char*)rxbuf);
+		m_socket.RecvLooped((unsigned char*)rxbuf, len);
+		m_frameRemaining = 0;
 
 		//Skip empty blocks, or just newlines
 		if( (len == 0) || (rxbuf[0] == '\n' && len == 1))
 		{
 			//Special handling needed for EOI.
-			if(header[0] & OP_EOI)
+			if(m_frameEOI)
 			{
 				//EOI on an empty block is a stop if we have data from previous blocks.
 				if(current_size != 0)
@@ -196,7 +230,7 @@ string VICPSocketTransport::ReadReply(bool /*endOnSemicolon*/)	//ignore endOnSem
 		}
 
 		//Check EOI flag
-		if(header[0] & OP_EOI)
+		if(m_frameEOI)
 			break;
 	}
 
@@ -210,13 +244,45 @@ void VICPSocketTransport::SendRawData(size_t len, const unsigned char* buf)
 	m_socket.SendLooped(buf, len);
 }
 
+/**
+	@brief Reads message data, with the VICP framing stripped off
+
+	Reads may span frames, so a definite-length block can be read straight into the caller's buffer however the
+	instrument chose to split it up.
+ */
 size_t VICPSocketTransport::ReadRawData(size_t len, unsigned char* buf)
 {
-	if(!m_socket.RecvLooped(buf, len))
-		return 0;
+	size_t done = 0;
+	while(done < len)
+	{
+		if(m_frameRemaining == 0)
+		{
+			if(!ReadFrameHeader())
+				return 0;
+			continue;
+		}
+
+		size_t n = min(len - done, m_frameRemaining);
+		if(!m_socket.RecvLooped(buf + done, n))
+		{
+			m_frameRemaining = 0;
+			return 0;
+		}
+		m_frameRemaining -= n;
+		done += n;
+	}
 	return len;
 }
 
+/**
+	@brief Discards the rest of the current message, if ReadRawData() didn't get all the way to the end of it
+ */
+void VICPSocketTransport::DiscardReplyRemainder()
+{
+	if(m_frameRemaining || !m_frameEOI)
+		ReadReply();
+}
+
 bool VICPSocketTransport::IsCommandBatchingSupported()
 {
 	return true;
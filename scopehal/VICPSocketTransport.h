@@ -56,6 +56,7 @@ public:
 	virtual std::string ReadReply(bool endOnSemicolon = true);
 	virtual size_t ReadRawData(size_t len, unsigned char* buf);
 	virtual void SendRawData(size_t len, const unsigned char* buf);
+	virtual void DiscardReplyRemainder();
 
 	virtual bool IsCommandBatchingSupported();
 	virtual bool IsConnected();
@@ -76,10 +77,15 @@ public:
 
 protected:
 	uint8_t GetNextSequenceNumber();
+	bool ReadFrameHeader();
 
 	uint8_t m_nextSequence;
 	uint8_t m_lastSequence;
 
+	//Message bytes left in the frame ReadRawData() is partway through, and whether it's the last of the message
+	size_t m_frameRemaining;
+	bool m_frameEOI;
+
 	Socket m_socket;
 
 	std::string m_hostname;
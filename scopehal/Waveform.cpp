@@ -0,0 +1,137 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* libscopehal v0.1                                                                                                     *
+*                                                                                                                      *
+* Copyright (c) 2012-2022 Andrew D. Zonenberg and contributors                                                         *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of UniformWaveformBase
+ */
+
+#include "scopehal.h"
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+UniformWaveformBase::UniformWaveformBase()
+	: m_sparseCopy(NULL)
+	, m_sparseCopyRevision(0)
+{
+	m_densePacked = true;
+}
+
+UniformWaveformBase::~UniformWaveformBase()
+{
+	InvalidateSparseCopy();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sparse copy for filters that need explicit timestamps
+
+/**
+	@brief Gets the waveform as an AnalogWaveform with explicit (dense packed) timestamps, making the copy if needed
+
+	The returned waveform is owned by this object. It remains valid until the samples are next modified (see
+	MarkModified()), resized or cleared.
+
+	@return The copy, or NULL if this isn't an analog waveform
+ */
+AnalogWaveform* UniformWaveformBase::GetSparseAnalogCopy()
+{
+	if(!HasAnalogSamples())
+		return NULL;
+
+	lock_guard<mutex> lock(m_sparseCopyMutex);
+	if(m_sparseCopy && (m_sparseCopyRevision == m_revision))
+		return m_sparseCopy;
+
+	//Reuse the old copy's buffers if the samples changed since it was made
+	size_t len = size();
+	auto cap = m_sparseCopy;
+	if(cap == NULL)
+		cap = WaveformPool::Get<AnalogWaveform>(len);
+	cap->m_timescale = m_timescale;
+	cap->m_startTimestamp = m_startTimestamp;
+	cap->m_startFemtoseconds = m_startFemtoseconds;
+	cap->m_triggerPhase = m_triggerPhase;
+	cap->m_flags = m_flags;
+	cap->m_densePacked = true;
+	cap->Resize(len);
+
+	//Copy in blocks small enough that the source and the copy stay in L2 while we work on them
+	const size_t blocksize = 16384;
+	size_t numblocks = (len + blocksize - 1) / blocksize;
+	#pragma omp parallel for
+	for(size_t i=0; i<numblocks; i++)
+	{
+		size_t start = i*blocksize;
+		size_t end = min(len, start + blocksize);
+		GetAnalogSamples((float*)&cap->m_samples[start], start, end - start);
+		cap->FillDenseTimestamps(start, end);
+	}
+	cap->MarkModified();
+
+	m_sparseCopy = cap;
+	m_sparseCopyRevision = m_revision;
+	return cap;
+}
+
+/**
+	@brief Discards the sparse copy of the waveform, if there is one
+ */
+void UniformWaveformBase::InvalidateSparseCopy()
+{
+	lock_guard<mutex> lock(m_sparseCopyMutex);
+	if(m_sparseCopy)
+	{
+		WaveformPool::Return(m_sparseCopy);
+		m_sparseCopy = NULL;
+	}
+}
+
+/**
+	@brief Resets the waveform for recycling, also releasing the sparse copy if there is one
+ */
+void UniformWaveformBase::ResetForReuse()
+{
+	WaveformBase::ResetForReuse();
+	InvalidateSparseCopy();
+}
+
+/**
+	@brief Gets the number of bytes used by the sparse copy of the waveform
+ */
+size_t UniformWaveformBase::GetSparseCopyBytes() const
+{
+	lock_guard<mutex> lock(m_sparseCopyMutex);
+	if(m_sparseCopy)
+		return m_sparseCopy->GetAllocatedBytes();
+	return 0;
+}
@@ -37,6 +37,8 @@
 #define Waveform_h
 
 #include <vector>
+#include <atomic>
+#include <mutex>
 #include <AlignedAllocator.h>
 
 /**
@@ -74,7 +76,13 @@ public:
 	One waveform contains a time-series of sample objects as well as scale information etc. The samples may
 	or may not be at regular intervals depending on whether the Oscilloscope uses RLE compression.
 
-	The WaveformBase contains all metadata, but the actual samples are stored in a derived class member.
+	The WaveformBase contains all metadata, but the actual samples (and timestamps, if any) are stored in a derived
+	class member.
+
+	There are two timebase representations:
+	* SparseWaveformBase (and Waveform<S>) stores an explicit offset and duration for every sample.
+	* UniformWaveformBase (and UniformWaveform<S>) stores no timestamps at all. Sample i starts at offset i and has a
+	  duration of one timebase unit.
  */
 class WaveformBase
 {
@@ -86,7 +94,9 @@ public:
 		, m_triggerPhase(0)
 		, m_densePacked(false)
 		, m_flags(0)
-	{}
+		, m_appendSession(0)
+		, m_revision(0)
+	{ MarkModified(); }
 
 	//empty virtual destructor in case any derived classes need one
 	virtual ~WaveformBase()
@@ -120,11 +130,13 @@ public:
 	/**
 		@brief True if the waveform is "dense packed".
 
-		This means that m_durations is always 1, and m_offsets ranges from 0 to m_offsets.size()-1.
+		This means that every sample has a duration of 1, and sample i has an offset of i.
 
 		If dense packed, we can often perform various optimizations to avoid excessive copying of waveform data.
 
 		Most oscilloscopes output dense packed waveforms natively.
+
+		Uniform waveforms are always dense packed. Sparse waveforms may or may not be.
 	 */
 	bool m_densePacked;
 
@@ -140,6 +152,120 @@ public:
 		WAVEFORM_CLIPPING = 1
 	};
 
+	/**
+		@brief Identifier of the append-only session this waveform is currently in, or zero if none.
+
+		While the session ID stays the same, the producer of the waveform promises that it only ever appends samples
+		(calling MarkModified() after each batch): existing samples, timestamps and timebase metadata are left untouched
+		(except that the duration of the final sample may grow). Filters that support incremental refresh use this to
+		process only the new samples.
+
+		Anything that modifies existing samples in place must call StartAppendSession() again, or ResetMetadata().
+	 */
+	uint64_t m_appendSession;
+
+	/**
+		@brief Begins a new append-only session, invalidating any state downstream filters have kept about this waveform
+	 */
+	void StartAppendSession()
+	{
+		static std::atomic<uint64_t> nextSession(1);
+		m_appendSession = nextSession ++;
+	}
+
+	/**
+		@brief Revision of the sample data.
+
+		Every change to the samples of any waveform gives it a new revision number, unique across all waveforms, so
+		(pointer, revision) identifies one particular set of data even if the waveform object is recycled.
+
+		Waveforms get a new revision when created, recycled through the WaveformPool, handed to a channel with
+		SetData(), or written by a filter's Refresh(). Anything else that modifies samples in place must call
+		MarkModified().
+	 */
+	uint64_t m_revision;
+
+	///@brief Gives the waveform a new revision number, indicating the sample data has changed
+	void MarkModified()
+	{
+		static std::atomic<uint64_t> nextRevision(1);
+		m_revision = nextRevision ++;
+	}
+
+	///@brief Returns the number of samples in the waveform
+	virtual size_t size() const =0;
+
+	///@brief Returns true if the waveform has no samples
+	bool empty() const
+	{ return (size() == 0); }
+
+	///@brief Returns true if this waveform has implicit (computed rather than stored) timestamps
+	virtual bool IsUniform() const =0;
+
+	virtual void clear() =0;
+	virtual void Resize(size_t size) =0;
+	virtual void Reserve(size_t size) =0;
+
+	///@brief Returns the number of samples that can be stored without reallocating
+	virtual size_t capacity() const =0;
+
+	///@brief Returns the number of bytes of sample and timestamp storage currently allocated
+	virtual size_t GetAllocatedBytes() const =0;
+
+	/**
+		@brief Resets all metadata to default values, leaving the sample buffers alone.
+
+		Used when a waveform is recycled for a new acquisition.
+	 */
+	void ResetMetadata()
+	{
+		m_timescale = 0;
+		m_startTimestamp = 0;
+		m_startFemtoseconds = 0;
+		m_triggerPhase = 0;
+		m_densePacked = IsUniform();
+		m_flags = 0;
+		m_appendSession = 0;
+		MarkModified();
+	}
+
+	/**
+		@brief Drops all samples and resets the waveform to the state of a newly constructed one, keeping its capacity.
+
+		Called by WaveformPool::Return(). Subclasses with state of their own beyond the base metadata must override
+		this (and call the base implementation) so none of it leaks into the next acquisition using the buffer.
+	 */
+	virtual void ResetForReuse()
+	{
+		clear();
+		ResetMetadata();
+	}
+
+	int64_t GetOffset(size_t i) const;
+	int64_t GetDuration(size_t i) const;
+
+	/**
+		@brief Gets the start time of a sample, in femtoseconds from the trigger
+	 */
+	int64_t GetOffsetScaled(size_t i) const
+	{ return GetOffset(i) * m_timescale + m_triggerPhase; }
+
+	/**
+		@brief Gets the duration of a sample, in femtoseconds
+	 */
+	int64_t GetDurationScaled(size_t i) const
+	{ return GetDuration(i) * m_timescale; }
+};
+
+/**
+	@brief Base class for waveforms with explicit per-sample timestamps
+ */
+class SparseWaveformBase : public WaveformBase
+{
+public:
+	SparseWaveformBase()
+	{}
+
 	///@brief Start timestamps of each sample
 	std::vector<
 		EmptyConstructorWrapper<int64_t>,
@@ -152,6 +278,12 @@ public:
 		AlignedAllocator< EmptyConstructorWrapper<int64_t>, 64 >
 		> m_durations;
 
+	virtual size_t size() const
+	{ return m_offsets.size(); }
+
+	virtual bool IsUniform() const
+	{ return false; }
+
 	virtual void clear()
 	{
 		m_offsets.clear();
@@ -164,30 +296,165 @@ public:
 		m_durations.resize(size);
 	}
 
+	virtual void Reserve(size_t size)
+	{
+		m_offsets.reserve(size);
+		m_durations.reserve(size);
+	}
+
 	/**
 		@brief Copies offsets/durations from one waveform to another.
 
-		Must have been resized to match rhs first.
+		Must have been resized to match rhs first. If rhs is uniform, the implicit timestamps are expanded.
 	 */
 	void CopyTimestamps(const WaveformBase* rhs)
 	{
-		size_t len = sizeof(int64_t) * rhs->m_offsets.size();
-		memcpy((void*)&m_offsets[0], (void*)&rhs->m_offsets[0], len);
-		memcpy((void*)&m_durations[0], (void*)&rhs->m_durations[0], len);
+		auto srhs = dynamic_cast<const SparseWaveformBase*>(rhs);
+		if(srhs)
+		{
+			size_t len = sizeof(int64_t) * srhs->m_offsets.size();
+			memcpy((void*)&m_offsets[0], (void*)&srhs->m_offsets[0], len);
+			memcpy((void*)&m_durations[0], (void*)&srhs->m_durations[0], len);
+		}
+		else
+			FillDenseTimestamps(0, rhs->size());
+	}
+
+	/**
+		@brief Fills timestamps in the range [start, end) with dense packed values (offset i, duration 1)
+	 */
+	void FillDenseTimestamps(size_t start, size_t end)
+	{
+		for(size_t i=start; i<end; i++)
+		{
+			m_offsets[i] = i;
+			m_durations[i] = 1;
+		}
 	}
 };
 
+template<class S> class Waveform;
+
+/**
+	@brief Base class for waveforms with implicit, uniformly spaced timestamps
+
+	No offset or duration is stored. Sample i starts at i timebase units and lasts for one unit, so the timebase costs
+	no memory and no bandwidth regardless of waveform length.
+
+	Most filters still take an AnalogWaveform with explicit timestamps. For those, GetSparseAnalogCopy() expands an
+	analog uniform waveform into a dense packed AnalogWaveform the first time one asks for it, and keeps the copy until
+	the samples change. Filters which take uniform inputs directly never pay for the copy.
+ */
+class UniformWaveformBase : public WaveformBase
+{
+public:
+	UniformWaveformBase();
+	virtual ~UniformWaveformBase();
+
+	virtual bool IsUniform() const
+	{ return true; }
+
+	Waveform<EmptyConstructorWrapper<float> >* GetSparseAnalogCopy();
+	void InvalidateSparseCopy();
+
+	virtual void ResetForReuse();
+
+	///@brief Returns true if this is an analog waveform (i.e. GetAnalogSamples() can be used on it)
+	virtual bool HasAnalogSamples() const
+	{ return false; }
+
+protected:
+
+	///@brief Converts samples [start, start+count) to volts
+	virtual void GetAnalogSamples(float* /*out*/, size_t /*start*/, size_t /*count*/) const
+	{}
+
+	size_t GetSparseCopyBytes() const;
+
+	///@brief Mutex protecting m_sparseCopy and m_sparseCopyRevision
+	mutable std::mutex m_sparseCopyMutex;
+
+	///@brief Expanded copy of the waveform, or NULL if nobody has asked for one
+	Waveform<EmptyConstructorWrapper<float> >* m_sparseCopy;
+
+	///@brief Value of m_revision when m_sparseCopy was made
+	uint64_t m_sparseCopyRevision;
+};
+
 /**
-	@brief A waveform that contains actual data
+	@brief Base class for waveforms that are 2D density plots (eye patterns, spectrograms, etc) rather than a time
+	series of samples.
+ */
+class DensityFunctionWaveform : public WaveformBase
+{
+public:
+	DensityFunctionWaveform()
+	{ m_densePacked = true; }
+
+	//No time-series samples
+	virtual size_t size() const
+	{ return 0; }
+
+	virtual bool IsUniform() const
+	{ return false; }
+
+	virtual void clear()
+	{}
+
+	virtual void Resize(size_t /*size*/)
+	{}
+
+	virtual void Reserve(size_t /*size*/)
+	{}
+
+	//Density plots manage their own fixed-size buffers and are never recycled
+	virtual size_t capacity() const
+	{ return 0; }
+
+	virtual size_t GetAllocatedBytes() const
+	{ return 0; }
+};
+
+/**
+	@brief Gets the start time of a sample, in timebase units
+ */
+inline int64_t WaveformBase::GetOffset(size_t i) const
+{
+	if(m_densePacked)
+		return i;
+	return static_cast<const SparseWaveformBase*>(this)->m_offsets[i].m_value;
+}
+
+/**
+	@brief Gets the duration of a sample, in timebase units
+ */
+inline int64_t WaveformBase::GetDuration(size_t i) const
+{
+	if(m_densePacked)
+		return 1;
+	return static_cast<const SparseWaveformBase*>(this)->m_durations[i].m_value;
+}
+
+/**
+	@brief A waveform that contains actual data, with explicit timestamps for each sample
  */
 template<class S>
-class Waveform : public WaveformBase
+class Waveform : public SparseWaveformBase
 {
 public:
 
 	///@brief Sample data
 	std::vector< S, AlignedAllocator<S, 64> > m_samples;
 
+	virtual size_t capacity() const
+	{ return m_samples.capacity(); }
+
+	virtual size_t GetAllocatedBytes() const
+	{
+		return m_samples.capacity() * sizeof(S) +
+			(m_offsets.capacity() + m_durations.capacity()) * sizeof(int64_t);
+	}
+
 	virtual void Resize(size_t size)
 	{
 		m_offsets.resize(size);
@@ -195,6 +462,13 @@ public:
 		m_samples.resize(size);
 	}
 
+	virtual void Reserve(size_t size)
+	{
+		m_offsets.reserve(size);
+		m_durations.reserve(size);
+		m_samples.reserve(size);
+	}
+
 	virtual void clear()
 	{
 		m_offsets.clear();
@@ -203,10 +477,168 @@ public:
 	}
 };
 
+/**
+	@brief A waveform that contains actual data, sampled at uniform intervals
+ */
+template<class S>
+class UniformWaveform : public UniformWaveformBase
+{
+public:
+
+	///@brief Sample data
+	std::vector< S, AlignedAllocator<S, 64> > m_samples;
+
+	virtual size_t size() const
+	{ return m_samples.size(); }
+
+	virtual size_t capacity() const
+	{ return m_samples.capacity(); }
+
+	virtual size_t GetAllocatedBytes() const
+	{ return m_samples.capacity() * sizeof(S) + GetSparseCopyBytes(); }
+
+	virtual void Resize(size_t size)
+	{
+		InvalidateSparseCopy();
+		m_samples.resize(size);
+	}
+
+	virtual void Reserve(size_t size)
+	{ m_samples.reserve(size); }
+
+	virtual void clear()
+	{
+		InvalidateSparseCopy();
+		m_samples.clear();
+	}
+
+	virtual bool HasAnalogSamples() const;
+
+protected:
+	virtual void GetAnalogSamples(float* out, size_t start, size_t count) const;
+};
+
+template<class S>
+bool UniformWaveform<S>::HasAnalogSamples() const
+{ return false; }
+
+template<class S>
+void UniformWaveform<S>::GetAnalogSamples(float* /*out*/, size_t /*start*/, size_t /*count*/) const
+{}
+
+template<>
+inline bool UniformWaveform<EmptyConstructorWrapper<float> >::HasAnalogSamples() const
+{ return true; }
+
+template<>
+inline void UniformWaveform<EmptyConstructorWrapper<float> >::GetAnalogSamples(
+	float* out, size_t start, size_t count) const
+{ memcpy(out, &m_samples[start], count * sizeof(float)); }
+
+/**
+	@brief A uniformly sampled digital waveform stored one bit per sample
+
+	Sample i is bit (i % 64) of m_words[i / 64]. Bits past the end of the waveform are always zero, so whole-word
+	operations on the last word do not need to mask the tail.
+ */
+class PackedDigitalWaveform : public UniformWaveformBase
+{
+public:
+	PackedDigitalWaveform()
+	: m_size(0)
+	{}
+
+	///@brief Packed sample data, 64 samples per word
+	std::vector< uint64_t, AlignedAllocator<uint64_t, 64> > m_words;
+
+	virtual size_t size() const
+	{ return m_size; }
+
+	virtual size_t capacity() const
+	{ return m_words.capacity() * 64; }
+
+	virtual size_t GetAllocatedBytes() const
+	{ return m_words.capacity() * sizeof(uint64_t); }
+
+	virtual void Resize(size_t size)
+	{
+		m_words.resize((size + 63) / 64);
+		m_size = size;
+
+		//Clear anything past the new end in case we shrank
+		size_t tail = size % 64;
+		if(tail)
+			m_words[size / 64] &= (1ULL << tail) - 1;
+	}
+
+	virtual void Reserve(size_t size)
+	{ m_words.reserve((size + 63) / 64); }
+
+	virtual void clear()
+	{
+		m_words.clear();
+		m_size = 0;
+	}
+
+	bool Get(size_t i) const
+	{ return (m_words[i / 64] >> (i % 64)) & 1; }
+
+	void Set(size_t i, bool value)
+	{
+		uint64_t mask = 1ULL << (i % 64);
+		if(value)
+			m_words[i / 64] |= mask;
+		else
+			m_words[i / 64] &= ~mask;
+	}
+
+	void push_back(bool value)
+	{
+		if( (m_size % 64) == 0)
+			m_words.push_back(0);
+		if(value)
+			m_words[m_size / 64] |= 1ULL << (m_size % 64);
+		m_size ++;
+	}
+
+protected:
+
+	///@brief Number of valid samples (m_words may contain up to 63 bits of padding)
+	size_t m_size;
+};
+
 typedef Waveform<EmptyConstructorWrapper<bool> >	DigitalWaveform;
 typedef Waveform<EmptyConstructorWrapper<float>>	AnalogWaveform;
 
-typedef Waveform< std::vector<bool> > 	DigitalBusWaveform;
+/**
+	@brief A parallel bus of up to 64 bits, stored as one integer per sample
+
+	Bit i of each sample is the state of bus line i, so bus line 0 is the LSB.
+ */
+class DigitalBusWaveform : public Waveform<EmptyConstructorWrapper<uint64_t> >
+{
+public:
+	DigitalBusWaveform()
+	: m_width(0)
+	{}
+
+	///@brief Number of bus lines (at most 64)
+	size_t m_width;
+
+	virtual void ResetForReuse()
+	{
+		Waveform<EmptyConstructorWrapper<uint64_t> >::ResetForReuse();
+		m_width = 0;
+	}
+
+	bool GetBit(size_t i, size_t line) const
+	{ return (m_samples[i].m_value >> line) & 1; }
+};
+
+
 typedef Waveform<char>					AsciiWaveform;
 
+typedef UniformWaveform<EmptyConstructorWrapper<bool> >		UniformDigitalWaveform;
+typedef UniformWaveform<EmptyConstructorWrapper<float> >	UniformAnalogWaveform;
+
 #endif
@@ -0,0 +1,167 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* libscopehal v0.1                                                                                                     *
+*                                                                                                                      *
+* Copyright (c) 2012-2022 Andrew D. Zonenberg and contributors                                                         *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of WaveformPool
+ */
+
+#include "scopehal.h"
+#include "WaveformPool.h"
+
+using namespace std;
+
+mutex WaveformPool::m_mutex;
+map<type_index, WaveformPool::CapacityMap> WaveformPool::m_freeWaveforms;
+size_t WaveformPool::m_maxBytes = 1024LL * 1024LL * 1024LL;
+size_t WaveformPool::m_bytesHeld = 0;
+size_t WaveformPool::m_hits = 0;
+size_t WaveformPool::m_misses = 0;
+thread_local size_t WaveformPool::m_threadAllocatedBytes = 0;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Checkout and return
+
+/**
+	@brief Finds a free waveform of the given type with at least the requested capacity and removes it from the pool.
+
+	If capacity is zero, the smallest free waveform of the type is returned.
+
+	To avoid tying up a huge buffer for a tiny waveform, free waveforms more than 4x larger than the request are not
+	used.
+
+	@return The waveform, with metadata reset and size zero, or NULL if nothing suitable was found
+ */
+WaveformBase* WaveformPool::Find(type_index type, size_t capacity)
+{
+	WaveformBase* wfm = NULL;
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		auto it = m_freeWaveforms.find(type);
+		if(it != m_freeWaveforms.end())
+		{
+			auto& freelist = it->second;
+			auto jt = freelist.end();
+			if(capacity == 0)
+			{
+				if(!freelist.empty())
+					jt = freelist.begin();
+			}
+			else
+			{
+				jt = freelist.lower_bound(capacity);
+				if( (jt != freelist.end()) && (jt->first / 4 > capacity) )
+					jt = freelist.end();
+			}
+
+			if(jt != freelist.end())
+			{
+				wfm = jt->second;
+				freelist.erase(jt);
+				m_bytesHeld -= wfm->GetAllocatedBytes();
+			}
+		}
+
+		if(wfm)
+			m_hits ++;
+		else
+			m_misses ++;
+	}
+
+	//Return() already reset everything, but the waveform needs a new revision so it isn't mistaken for the one that
+	//was returned
+	if(wfm)
+		wfm->ResetMetadata();
+	return wfm;
+}
+
+/**
+	@brief Returns a waveform to the pool once its owner is done with it.
+
+	The caller must not touch the waveform afterwards. Waveforms which cannot be recycled, or which would push the pool
+	over its size limit, are deleted.
+ */
+void WaveformPool::Return(WaveformBase* wfm)
+{
+	if(wfm == NULL)
+		return;
+
+	//Drop the contents now so anything the waveform owns besides its sample buffer (e.g. the converted copy of an
+	//ADCCodeWaveform) is released rather than sitting in the pool, and subclass state (bus width, ADC scaling, etc)
+	//doesn't carry over into whatever acquisition gets this buffer next
+	wfm->ResetForReuse();
+
+	size_t cap = wfm->capacity();
+	size_t bytes = wfm->GetAllocatedBytes();
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+		if( (cap != 0) && (m_bytesHeld + bytes <= m_maxBytes) )
+		{
+			m_freeWaveforms[typeid(*wfm)].emplace(cap, wfm);
+			m_bytesHeld += bytes;
+			return;
+		}
+	}
+
+	delete wfm;
+}
+
+/**
+	@brief Frees all waveforms held by the pool
+ */
+void WaveformPool::Clear()
+{
+	//Destructors may return buffers of their own, so don't hold the lock while deleting
+	map<type_index, CapacityMap> waveforms;
+	{
+		lock_guard<mutex> lock(m_mutex);
+		waveforms.swap(m_freeWaveforms);
+		m_bytesHeld = 0;
+	}
+
+	for(auto& it : waveforms)
+	{
+		for(auto& jt : it.second)
+			delete jt.second;
+	}
+}
+
+/**
+	@brief Resets the hit and miss counters
+ */
+void WaveformPool::ResetStatistics()
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_hits = 0;
+	m_misses = 0;
+}
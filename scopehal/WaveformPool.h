@@ -0,0 +1,147 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* libscopehal v0.1                                                                                                     *
+*                                                                                                                      *
+* Copyright (c) 2012-2022 Andrew D. Zonenberg and contributors                                                         *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of WaveformPool
+ */
+
+#ifndef WaveformPool_h
+#define WaveformPool_h
+
+#include <map>
+#include <mutex>
+#include <typeindex>
+
+#include "Waveform.h"
+
+/**
+	@brief Recycling pool for waveform buffers.
+
+	Allocating a new multi-megabyte waveform on every trigger (and freeing the old one when it's replaced) pushes a lot
+	of memory through malloc and incurs page faults every time the freshly mapped buffer is first touched. Instead,
+	drivers and filters check waveforms out of the pool with Get(), and OscilloscopeChannel::SetData() hands replaced
+	waveforms back with Return().
+
+	Free waveforms are keyed by concrete type and sample capacity. Get() returns the smallest free waveform of the
+	requested type with at least the requested capacity, or allocates a new one if there is none.
+
+	The pool holds at most GetMaxBytes() bytes of free buffers. Waveforms returned beyond that are deleted.
+ */
+class WaveformPool
+{
+public:
+
+	/**
+		@brief Gets an empty waveform of type T from the pool, or allocates a new one.
+
+		The returned waveform has default metadata and a size of zero, but retains whatever capacity it had.
+
+		@param capacity		Number of samples the caller intends to store. Zero if unknown.
+	 */
+	template<class T>
+	static T* Get(size_t capacity = 0)
+	{
+		auto wfm = dynamic_cast<T*>(Find(typeid(T), capacity));
+		if(wfm == NULL)
+		{
+			wfm = new T;
+			if(capacity)
+				wfm->Reserve(capacity);
+			m_threadAllocatedBytes += wfm->GetAllocatedBytes();
+		}
+		return wfm;
+	}
+
+	static void Return(WaveformBase* wfm);
+	static void Clear();
+
+	///@brief Sets the maximum number of bytes of free waveforms to keep around
+	static void SetMaxBytes(size_t bytes)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_maxBytes = bytes;
+	}
+
+	static size_t GetMaxBytes()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_maxBytes;
+	}
+
+	///@brief Number of Get() calls satisfied from the pool
+	static size_t GetHitCount()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_hits;
+	}
+
+	///@brief Number of Get() calls that had to allocate a new waveform
+	static size_t GetMissCount()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_misses;
+	}
+
+	///@brief Number of bytes of sample storage currently held by free waveforms
+	static size_t GetBytesHeld()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_bytesHeld;
+	}
+
+	static void ResetStatistics();
+
+	/**
+		@brief Total bytes of sample storage allocated by Get() on the calling thread, because the pool had nothing to
+		recycle. Take the difference of two calls to find how much a block of code allocated.
+	 */
+	static size_t GetThreadAllocatedBytes()
+	{ return m_threadAllocatedBytes; }
+
+protected:
+	static WaveformBase* Find(std::type_index type, size_t capacity);
+
+	typedef std::multimap<size_t, WaveformBase*> CapacityMap;
+
+	static std::mutex m_mutex;
+
+	///@brief Free waveforms, by type and capacity
+	static std::map<std::type_index, CapacityMap> m_freeWaveforms;
+
+	static size_t m_maxBytes;
+	static size_t m_bytesHeld;
+	static size_t m_hits;
+	static size_t m_misses;
+
+	static thread_local size_t m_threadAllocatedBytes;
+};
+
+#endif
@@ -0,0 +1,419 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* libscopehal v0.1                                                                                                     *
+*                                                                                                                      *
+* Copyright (c) 2012-2022 Andrew D. Zonenberg and contributors                                                         *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Implementation of WaveformSummary
+ */
+
+#include "scopehal.h"
+#include "WaveformSummary.h"
+#include <immintrin.h>
+#include <omp.h>
+
+using namespace std;
+
+mutex WaveformSummary::m_mutex;
+map<WaveformBase*, WaveformSummary::Entry> WaveformSummary::m_entries;
+WaveformSummary::LRUList WaveformSummary::m_lru;
+size_t WaveformSummary::m_maxEntries = 1024;
+size_t WaveformSummary::m_hits = 0;
+size_t WaveformSummary::m_misses = 0;
+
+///@brief Number of samples each thread works on at a time
+static const size_t SUMMARY_BLOCK_SIZE = 1024 * 1024;
+
+WaveformSummary::WaveformSummary()
+	: m_revision(0)
+	, m_count(0)
+	, m_min(FLT_MAX)
+	, m_max(-FLT_MAX)
+	, m_sum(0)
+	, m_sumSquares(0)
+	, m_histogram(HISTOGRAM_BINS, 0)
+{
+}
+
+/**
+	@brief Finds the most probable level within a range of histogram bins
+
+	@param binlo	First bin to search
+	@param binhi	One past the last bin to search
+
+	@return Voltage at the center of the tallest bin
+ */
+float WaveformSummary::GetHistogramPeak(size_t binlo, size_t binhi) const
+{
+	size_t binval = 0;
+	size_t idx = 0;
+	for(size_t i=binlo; i<binhi; i++)
+	{
+		if(m_histogram[i] > binval)
+		{
+			binval = m_histogram[i];
+			idx = i;
+		}
+	}
+
+	float fbin = (idx + 0.5f)/HISTOGRAM_BINS;
+	return fbin*(m_max - m_min) + m_min;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Summary kernels
+
+/**
+	@brief Finds the extrema, sum and sum of squares of a block of samples
+
+	Sums are accumulated in double precision so deep captures don't lose the low bits.
+ */
+static void GetMoments(const float* samples, size_t start, size_t end,
+	float& vmin, float& vmax, double& sum, double& sumSquares)
+{
+	float tmin = FLT_MAX;
+	float tmax = -FLT_MAX;
+	double tsum = 0;
+	double tsq = 0;
+	for(size_t i=start; i<end; i++)
+	{
+		float f = samples[i];
+		if(f < tmin)
+			tmin = f;
+		if(f > tmax)
+			tmax = f;
+		tsum += f;
+		tsq += (double)f * f;
+	}
+
+	vmin = tmin;
+	vmax = tmax;
+	sum = tsum;
+	sumSquares = tsq;
+}
+
+/**
+	@brief AVX2 version of GetMoments(), processing 8 samples per iteration
+ */
+__attribute__((target("avx2")))
+static void GetMomentsAVX2(const float* samples, size_t start, size_t end,
+	float& vmin, float& vmax, double& sum, double& sumSquares)
+{
+	__m256 tmin = _mm256_set1_ps(FLT_MAX);
+	__m256 tmax = _mm256_set1_ps(-FLT_MAX);
+	__m256d sumlo = _mm256_setzero_pd();
+	__m256d sumhi = _mm256_setzero_pd();
+	__m256d sqlo = _mm256_setzero_pd();
+	__m256d sqhi = _mm256_setzero_pd();
+
+	size_t i = start;
+	for(; i+8 <= end; i += 8)
+	{
+		__m256 x = _mm256_loadu_ps(samples + i);
+
+		//Sample goes in the first operand so NaNs are skipped, same as the scalar comparisons
+		tmin = _mm256_min_ps(x, tmin);
+		tmax = _mm256_max_ps(x, tmax);
+
+		__m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(x));
+		__m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1));
+		sumlo = _mm256_add_pd(sumlo, lo);
+		sumhi = _mm256_add_pd(sumhi, hi);
+		sqlo = _mm256_add_pd(sqlo, _mm256_mul_pd(lo, lo));
+		sqhi = _mm256_add_pd(sqhi, _mm256_mul_pd(hi, hi));
+	}
+
+	//Reduce the lanes
+	float mins[8];
+	float maxes[8];
+	double sums[4];
+	double sqs[4];
+	_mm256_storeu_ps(mins, tmin);
+	_mm256_storeu_ps(maxes, tmax);
+	_mm256_storeu_pd(sums, _mm256_add_pd(sumlo, sumhi));
+	_mm256_storeu_pd(sqs, _mm256_add_pd(sqlo, sqhi));
+
+	//Get any extras
+	GetMoments(samples, i, end, vmin, vmax, sum, sumSquares);
+	for(int j=0; j<8; j++)
+	{
+		vmin = min(vmin, mins[j]);
+		vmax = max(vmax, maxes[j]);
+	}
+	for(int j=0; j<4; j++)
+	{
+		sum += sums[j];
+		sumSquares += sqs[j];
+	}
+}
+
+/**
+	@brief AVX-512 version of GetMoments(), processing 16 samples per iteration
+ */
+__attribute__((target("avx512f")))
+static void GetMomentsAVX512F(const float* samples, size_t start, size_t end,
+	float& vmin, float& vmax, double& sum, double& sumSquares)
+{
+	__m512 tmin = _mm512_set1_ps(FLT_MAX);
+	__m512 tmax = _mm512_set1_ps(-FLT_MAX);
+	__m512d sumlo = _mm512_setzero_pd();
+	__m512d sumhi = _mm512_setzero_pd();
+	__m512d sqlo = _mm512_setzero_pd();
+	__m512d sqhi = _mm512_setzero_pd();
+
+	size_t i = start;
+	for(; i+16 <= end; i += 16)
+	{
+		__m512 x = _mm512_loadu_ps(samples + i);
+
+		//The zero-masked forms (with every lane enabled) compile to the same instructions as the plain intrinsics,
+		//but avoid their "undefined" merge source which GCC 12 flags with -Wmaybe-uninitialized
+		tmin = _mm512_maskz_min_ps(0xffff, x, tmin);
+		tmax = _mm512_maskz_max_ps(0xffff, x, tmax);
+
+		//Halves extracted as doubles since _mm512_extractf32x8_ps needs AVX512DQ
+		__m512d lo = _mm512_maskz_cvtps_pd(0xff, _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xf, _mm512_castps_pd(x), 0)));
+		__m512d hi = _mm512_maskz_cvtps_pd(0xff, _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xf, _mm512_castps_pd(x), 1)));
+		sumlo = _mm512_add_pd(sumlo, lo);
+		sumhi = _mm512_add_pd(sumhi, hi);
+		sqlo = _mm512_add_pd(sqlo, _mm512_mul_pd(lo, lo));
+		sqhi = _mm512_add_pd(sqhi, _mm512_mul_pd(hi, hi));
+	}
+
+	//Get any extras, then fold in the lanes.
+	//This happens once per block so do it in scalar code, the _mm512_reduce_* intrinsics trip the same GCC warning.
+	GetMoments(samples, i, end, vmin, vmax, sum, sumSquares);
+	float lanemin[16];
+	float lanemax[16];
+	double lanesum[8];
+	double lanesq[8];
+	_mm512_storeu_ps(lanemin, tmin);
+	_mm512_storeu_ps(lanemax, tmax);
+	_mm512_storeu_pd(lanesum, _mm512_add_pd(sumlo, sumhi));
+	_mm512_storeu_pd(lanesq, _mm512_add_pd(sqlo, sqhi));
+	for(size_t j=0; j<16; j++)
+	{
+		vmin = min(vmin, lanemin[j]);
+		vmax = max(vmax, lanemax[j]);
+	}
+	for(size_t j=0; j<8; j++)
+	{
+		sum += lanesum[j];
+		sumSquares += lanesq[j];
+	}
+}
+
+/**
+	@brief Adds a block of samples to a histogram
+
+	Binning is the same as Filter::MakeHistogram(), so results don't depend on which one was used.
+ */
+static void AddToHistogram(const float* samples, size_t start, size_t end, float low, float high, size_t* hist)
+{
+	const size_t bins = WaveformSummary::HISTOGRAM_BINS;
+	float delta = high - low;
+
+	for(size_t i=start; i<end; i++)
+	{
+		float fbin = (samples[i] - low) / delta;
+		size_t bin = floor(fbin * bins);
+		if(fbin < 0)
+			bin = 0;
+		else
+			bin = min(bin, bins-1);
+		hist[bin] ++;
+	}
+}
+
+/**
+	@brief Computes the summary of a block of samples
+
+	The histogram range depends on the extrema, so this takes two passes: one for the extrema and moments, and one for
+	the histogram. Both are split into blocks and run in parallel, with partial results combined in block order so the
+	output doesn't depend on the thread count.
+ */
+static void Summarize(const float* samples, size_t len, WaveformSummary& out)
+{
+	out.m_count = len;
+	if(len == 0)
+		return;
+
+	size_t nblocks = (len + SUMMARY_BLOCK_SIZE - 1) / SUMMARY_BLOCK_SIZE;
+	vector<float> mins(nblocks);
+	vector<float> maxes(nblocks);
+	vector<double> sums(nblocks);
+	vector<double> sqs(nblocks);
+
+	#pragma omp parallel for if(nblocks > 1)
+	for(size_t block=0; block<nblocks; block++)
+	{
+		size_t start = block * SUMMARY_BLOCK_SIZE;
+		size_t end = min(start + SUMMARY_BLOCK_SIZE, len);
+
+		if(g_hasAvx512F)
+			GetMomentsAVX512F(samples, start, end, mins[block], maxes[block], sums[block], sqs[block]);
+		else if(g_hasAvx2)
+			GetMomentsAVX2(samples, start, end, mins[block], maxes[block], sums[block], sqs[block]);
+		else
+			GetMoments(samples, start, end, mins[block], maxes[block], sums[block], sqs[block]);
+	}
+
+	for(size_t block=0; block<nblocks; block++)
+	{
+		out.m_min = min(out.m_min, mins[block]);
+		out.m_max = max(out.m_max, maxes[block]);
+		out.m_sum += sums[block];
+		out.m_sumSquares += sqs[block];
+	}
+
+	//Second pass for the histogram, now that we know its range
+	const size_t bins = WaveformSummary::HISTOGRAM_BINS;
+	vector<size_t> hists(nblocks * bins, 0);
+
+	#pragma omp parallel for if(nblocks > 1)
+	for(size_t block=0; block<nblocks; block++)
+	{
+		size_t start = block * SUMMARY_BLOCK_SIZE;
+		size_t end = min(start + SUMMARY_BLOCK_SIZE, len);
+		AddToHistogram(samples, start, end, out.m_min, out.m_max, &hists[block * bins]);
+	}
+
+	for(size_t block=0; block<nblocks; block++)
+	{
+		for(size_t i=0; i<bins; i++)
+			out.m_histogram[i] += hists[block*bins + i];
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Cache
+
+/**
+	@brief Gets the summary of the current revision of a waveform, computing it if necessary
+ */
+WaveformSummary::Ptr WaveformSummary::Get(AnalogWaveform* wfm)
+{
+	return Get(wfm, reinterpret_cast<const float*>(wfm->m_samples.data()), wfm->m_samples.size());
+}
+
+WaveformSummary::Ptr WaveformSummary::Get(UniformAnalogWaveform* wfm)
+{
+	return Get(wfm, reinterpret_cast<const float*>(wfm->m_samples.data()), wfm->m_samples.size());
+}
+
+WaveformSummary::Ptr WaveformSummary::Get(WaveformBase* wfm, const float* samples, size_t len)
+{
+	auto ret = Find(wfm);
+	if(ret)
+		return ret;
+
+	//Grab the revision before we start, so a concurrent modification can't be cached as the old revision
+	auto summary = make_shared<WaveformSummary>();
+	summary->m_revision = wfm->m_revision;
+	Summarize(samples, len, *summary);
+
+	Insert(wfm, summary);
+	return summary;
+}
+
+/**
+	@brief Looks up the summary of the current revision of a waveform
+
+	@return The cached summary, or NULL if there is none
+ */
+WaveformSummary::Ptr WaveformSummary::Find(WaveformBase* wfm)
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	auto it = m_entries.find(wfm);
+	if( (it == m_entries.end()) || (it->second.m_summary->m_revision != wfm->m_revision) )
+	{
+		m_misses ++;
+		return NULL;
+	}
+	m_hits ++;
+
+	//Move to the front of the LRU list
+	m_lru.splice(m_lru.begin(), m_lru, it->second.m_lruPosition);
+	return it->second.m_summary;
+}
+
+/**
+	@brief Adds a summary to the cache, replacing any older summary of the same waveform
+ */
+void WaveformSummary::Insert(WaveformBase* wfm, Ptr summary)
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	auto it = m_entries.find(wfm);
+	if(it != m_entries.end())
+	{
+		it->second.m_summary = summary;
+		m_lru.splice(m_lru.begin(), m_lru, it->second.m_lruPosition);
+		return;
+	}
+
+	m_lru.push_front(wfm);
+	Entry& entry = m_entries[wfm];
+	entry.m_summary = summary;
+	entry.m_lruPosition = m_lru.begin();
+
+	EvictToLimit();
+}
+
+/**
+	@brief Evicts least recently used entries until the cache is within its size limit. The caller must hold m_mutex.
+ */
+void WaveformSummary::EvictToLimit()
+{
+	while(m_entries.size() > m_maxEntries)
+	{
+		m_entries.erase(m_lru.back());
+		m_lru.pop_back();
+	}
+}
+
+/**
+	@brief Discards all cached summaries
+
+	Summaries which have already been handed out remain valid.
+ */
+void WaveformSummary::Clear()
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_entries.clear();
+	m_lru.clear();
+}
+
+void WaveformSummary::ResetStatistics()
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_hits = 0;
+	m_misses = 0;
+}
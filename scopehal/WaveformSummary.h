@@ -0,0 +1,149 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* libscopehal v0.1                                                                                                     *
+*                                                                                                                      *
+* Copyright (c) 2012-2022 Andrew D. Zonenberg and contributors                                                         *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@author Andrew D. Zonenberg
+	@brief Declaration of WaveformSummary
+ */
+
+#ifndef WaveformSummary_h
+#define WaveformSummary_h
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "Waveform.h"
+
+/**
+	@brief Summary statistics of an analog waveform, computed once per revision and shared by everyone who asks.
+
+	A measurement panel showing peak-to-peak, top, base, overshoot, rise time etc. of one signal would otherwise walk
+	the whole waveform several times per measurement. Instead, Get() scans the waveform once for the extrema and
+	moments, bins it into a coarse histogram spanning [m_min, m_max], and caches the result keyed by waveform and
+	revision (see WaveformBase::MarkModified()).
+
+	Summaries are small, so the cache is bounded by entry count rather than bytes. Once over GetMaxEntries(), the least
+	recently used summaries are discarded.
+ */
+class WaveformSummary
+{
+public:
+	WaveformSummary();
+
+	///@brief Number of bins in m_histogram
+	static const size_t HISTOGRAM_BINS = 100;
+
+	///@brief Revision of the waveform this summary was computed from
+	uint64_t m_revision;
+
+	size_t m_count;
+	float m_min;
+	float m_max;
+	double m_sum;
+	double m_sumSquares;
+
+	///@brief Histogram of sample values, with HISTOGRAM_BINS equal bins spanning [m_min, m_max]
+	std::vector<size_t> m_histogram;
+
+	///@brief Average of all samples
+	float GetMean() const
+	{ return m_sum / m_count; }
+
+	float GetHistogramPeak(size_t binlo, size_t binhi) const;
+
+	typedef std::shared_ptr<const WaveformSummary> Ptr;
+
+	static Ptr Get(AnalogWaveform* wfm);
+	static Ptr Get(UniformAnalogWaveform* wfm);
+	static void Clear();
+
+	///@brief Sets the maximum number of summaries to keep around
+	static void SetMaxEntries(size_t n)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_maxEntries = n;
+		EvictToLimit();
+	}
+
+	static size_t GetMaxEntries()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_maxEntries;
+	}
+
+	///@brief Number of Get() calls which returned a cached summary
+	static size_t GetHitCount()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_hits;
+	}
+
+	///@brief Number of Get() calls which had to scan the waveform
+	static size_t GetMissCount()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_misses;
+	}
+
+	static void ResetStatistics();
+
+protected:
+	static Ptr Get(WaveformBase* wfm, const float* samples, size_t len);
+	static Ptr Find(WaveformBase* wfm);
+	static void Insert(WaveformBase* wfm, Ptr summary);
+	static void EvictToLimit();
+
+	typedef std::list<WaveformBase*> LRUList;
+
+	class Entry
+	{
+	public:
+		Ptr m_summary;
+
+		///@brief Position of this entry in m_lru
+		LRUList::iterator m_lruPosition;
+	};
+
+	static std::mutex m_mutex;
+
+	///@brief Most recent summary of each waveform
+	static std::map<WaveformBase*, Entry> m_entries;
+
+	///@brief Waveforms in m_entries, most recently used first
+	static LRUList m_lru;
+
+	static size_t m_maxEntries;
+	static size_t m_hits;
+	static size_t m_misses;
+};
+
+#endif
@@ -0,0 +1,179 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* libscopehal v0.1                                                                                                     *
+*                                                                                                                      *
+* Copyright (c) 2012-2022 Andrew D. Zonenberg and contributors                                                         *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@brief Throughput benchmark for the ADC sample conversion kernels in Oscilloscope
+
+	Runs each Convert*BitSamples() implementation the CPU supports over a deep capture, checks the output against the
+	generic version, and prints the best of several runs. Usage: SampleConversionBenchmark [samples]
+ */
+
+#include "../scopehal.h"
+#include <cmath>
+
+using namespace std;
+
+///@brief Exposes the protected static conversion kernels without instantiating an Oscilloscope
+class ConversionKernels : public Oscilloscope
+{
+public:
+	using Oscilloscope::Convert8BitSamplesGeneric;
+	using Oscilloscope::Convert8BitSamplesAVX2;
+	using Oscilloscope::Convert8BitSamplesAVX512F;
+	using Oscilloscope::ConvertUnsigned8BitSamplesGeneric;
+	using Oscilloscope::ConvertUnsigned8BitSamplesAVX2;
+	using Oscilloscope::ConvertUnsigned8BitSamplesAVX512F;
+	using Oscilloscope::Convert16BitSamplesGeneric;
+	using Oscilloscope::Convert16BitSamplesAVX2;
+	using Oscilloscope::Convert16BitSamplesFMA;
+	using Oscilloscope::Convert16BitSamplesAVX512F;
+};
+
+template<class T>
+using ConversionKernel = void (*)(int64_t*, int64_t*, float*, T*, float, float, size_t, int64_t);
+
+///@brief Output buffers for one run, aligned the same way waveform buffers are
+struct ConversionOutput
+{
+	ConversionOutput(size_t count)
+		: offs(count)
+		, durs(count)
+		, samples(count)
+	{}
+
+	vector<int64_t, AlignedAllocator<int64_t, 64> > offs;
+	vector<int64_t, AlignedAllocator<int64_t, 64> > durs;
+	vector<float, AlignedAllocator<float, 64> > samples;
+};
+
+/**
+	@brief Times one kernel, returning false if its output doesn't match the reference
+ */
+template<class T>
+static bool RunKernel(
+	const char* name,
+	ConversionKernel<T> kernel,
+	vector<T, AlignedAllocator<T, 64> >& in,
+	ConversionOutput& ref,
+	ConversionOutput& out)
+{
+	const float gain = 0.0125;
+	const float offset = -0.3;
+	const size_t count = in.size();
+	const int iterations = 5;
+
+	double best = 1e9;
+	for(int i=0; i<iterations; i++)
+	{
+		double start = GetTime();
+		kernel(&out.offs[0], &out.durs[0], &out.samples[0], &in[0], gain, offset, count, 0);
+		best = min(best, GetTime() - start);
+	}
+
+	//FMA kernels round differently, so compare with a tolerance rather than exactly
+	bool ok = true;
+	for(size_t i=0; i<count; i++)
+	{
+		if( (out.offs[i] != ref.offs[i]) || (out.durs[i] != ref.durs[i]) ||
+			(fabs(out.samples[i] - ref.samples[i]) > 1e-4) )
+		{
+			LogError("%s: mismatch at sample %zu\n", name, i);
+			ok = false;
+			break;
+		}
+	}
+
+	//Each sample reads sizeof(T) bytes and writes a float plus two int64s
+	double bytes = count * (sizeof(T) + sizeof(float) + 2*sizeof(int64_t));
+	LogNotice("%-36s %8.2f ms %8.1f MS/s %7.2f GB/s%s\n",
+		name,
+		best * 1e3,
+		count / best * 1e-6,
+		bytes / best * 1e-9,
+		ok ? "" : "  MISMATCH");
+	return ok;
+}
+
+template<class T>
+static bool RunKernels(
+	const char* type,
+	size_t count,
+	ConversionKernel<T> generic,
+	const vector< pair<string, ConversionKernel<T> > >& kernels)
+{
+	vector<T, AlignedAllocator<T, 64> > in(count);
+	for(size_t i=0; i<count; i++)
+		in[i] = static_cast<T>(rand());
+
+	ConversionOutput ref(count);
+	ConversionOutput out(count);
+	generic(&ref.offs[0], &ref.durs[0], &ref.samples[0], &in[0], 0.0125, -0.3, count, 0);
+
+	bool ok = RunKernel((string(type) + " generic").c_str(), generic, in, ref, out);
+	for(auto& k : kernels)
+		ok &= RunKernel((string(type) + " " + k.first).c_str(), k.second, in, ref, out);
+	return ok;
+}
+
+int main(int argc, char* argv[])
+{
+	g_log_sinks.emplace(g_log_sinks.begin(), new ColoredSTDLogSink(Severity::NOTICE));
+
+	size_t count = 64 * 1024 * 1024;
+	if(argc > 1)
+		count = strtoull(argv[1], NULL, 10);
+
+	DetectCPUFeatures();
+	LogNotice("Converting %zu samples per run\n", count);
+
+	vector< pair<string, ConversionKernel<int8_t> > > k8;
+	vector< pair<string, ConversionKernel<uint8_t> > > ku8;
+	vector< pair<string, ConversionKernel<int16_t> > > k16;
+	if(g_hasAvx2)
+	{
+		k8.push_back(make_pair("AVX2", &ConversionKernels::Convert8BitSamplesAVX2));
+		ku8.push_back(make_pair("AVX2", &ConversionKernels::ConvertUnsigned8BitSamplesAVX2));
+		k16.push_back(make_pair("AVX2", &ConversionKernels::Convert16BitSamplesAVX2));
+		if(g_hasFMA)
+			k16.push_back(make_pair("FMA", &ConversionKernels::Convert16BitSamplesFMA));
+	}
+	if(g_hasAvx512F)
+	{
+		k8.push_back(make_pair("AVX512F", &ConversionKernels::Convert8BitSamplesAVX512F));
+		ku8.push_back(make_pair("AVX512F", &ConversionKernels::ConvertUnsigned8BitSamplesAVX512F));
+		k16.push_back(make_pair("AVX512F", &ConversionKernels::Convert16BitSamplesAVX512F));
+	}
+
+	bool ok = true;
+	ok &= RunKernels<int8_t>("int8", count, &ConversionKernels::Convert8BitSamplesGeneric, k8);
+	ok &= RunKernels<uint8_t>("uint8", count, &ConversionKernels::ConvertUnsigned8BitSamplesGeneric, ku8);
+	ok &= RunKernels<int16_t>("int16", count, &ConversionKernels::Convert16BitSamplesGeneric, k16);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+/***********************************************************************************************************************
+*                                                                                                                      *
+* libscopehal v0.1                                                                                                     *
+*                                                                                                                      *
+* Copyright (c) 2012-2022 Andrew D. Zonenberg and contributors                                                         *
+* All rights reserved.                                                                                                 *
+*                                                                                                                      *
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that the     *
+* following conditions are met:                                                                                        *
+*                                                                                                                      *
+*    * Redistributions of source code must retain the above copyright notice, this list of conditions, and the         *
+*      following disclaimer.                                                                                           *
+*                                                                                                                      *
+*    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the       *
+*      following disclaimer in the documentation and/or other materials provided with the distribution.                *
+*                                                                                                                      *
+*    * Neither the name of the author nor the names of any contributors may be used to endorse or promote products     *
+*      derived from this software without specific prior written permission.                                           *
+*                                                                                                                      *
+* THIS SOFTWARE IS PROVIDED BY THE AUTHORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED   *
+* TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL *
+* THE AUTHORS BE HELD LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES        *
+* (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR       *
+* BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT *
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE       *
+* POSSIBILITY OF SUCH DAMAGE.                                                                                          *
+*                                                                                                                      *
+***********************************************************************************************************************/
+
+/**
+	@file
+	@brief Loopback benchmark for SCPISocketTransport
+
+	Runs a minimal SCPI server on 127.0.0.1 and measures query round trip time and bulk read throughput through the
+	buffered receive path, with no instrument in the loop. POSIX only.
+	Usage: TransportLoopbackBenchmark [queries] [bulk MB]
+ */
+
+#include "../scopehal.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+using namespace std;
+
+/**
+	@brief Fake instrument: answers "*IDN?" with a short string and "DATA? n" with n raw bytes
+ */
+static void ServerThread(int listenfd)
+{
+	int fd = accept(listenfd, NULL, NULL);
+	if(fd < 0)
+		return;
+
+	vector<char> payload;
+	string line;
+	char buf[4096];
+	while(true)
+	{
+		ssize_t n = recv(fd, buf, sizeof(buf), 0);
+		if(n <= 0)
+			break;
+
+		for(ssize_t i=0; i<n; i++)
+		{
+			if(buf[i] != '\n')
+			{
+				line += buf[i];
+				continue;
+			}
+
+			if(line == "*IDN?")
+			{
+				const char* idn = "Loopback,Benchmark,0,0\n";
+				send(fd, idn, strlen(idn), 0);
+			}
+			else if(line.find("DATA? ") == 0)
+			{
+				size_t len = strtoull(line.c_str() + 6, NULL, 10);
+				payload.resize(len, 'x');
+				size_t sent = 0;
+				while(sent < len)
+				{
+					ssize_t m = send(fd, &payload[sent], len - sent, 0);
+					if(m <= 0)
+						break;
+					sent += m;
+				}
+			}
+			line.clear();
+		}
+	}
+	close(fd);
+}
+
+int main(int argc, char* argv[])
+{
+	g_log_sinks.emplace(g_log_sinks.begin(), new ColoredSTDLogSink(Severity::NOTICE));
+
+	size_t queries = 10000;
+	size_t megabytes = 1024;
+	if(argc > 1)
+		queries = strtoull(argv[1], NULL, 10);
+	if(argc > 2)
+		megabytes = strtoull(argv[2], NULL, 10);
+
+	//Listen on an ephemeral port
+	int listenfd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+	socklen_t addrlen = sizeof(addr);
+	if( (bind(listenfd, (sockaddr*)&addr, sizeof(addr)) < 0) ||
+		(listen(listenfd, 1) < 0) ||
+		(getsockname(listenfd, (sockaddr*)&addr, &addrlen) < 0) )
+	{
+		LogError("Couldn't set up loopback server: %s\n", strerror(errno));
+		return 1;
+	}
+	thread server(ServerThread, listenfd);
+
+	int ret = 0;
+	{
+		SCPISocketTransport transport("127.0.0.1", ntohs(addr.sin_port));
+		if(!transport.IsConnected())
+		{
+			LogError("Couldn't connect to loopback server\n");
+			return 1;
+		}
+
+		//Small query round trips
+		double start = GetTime();
+		for(size_t i=0; i<queries; i++)
+		{
+			if(transport.SendCommandImmediateWithReply("*IDN?") != "Loopback,Benchmark,0,0")
+			{
+				LogError("Bad reply to query %zu\n", i);
+				ret = 1;
+				break;
+			}
+		}
+		double dt = GetTime() - start;
+		LogNotice("%zu queries: %.2f us per round trip\n", queries, dt * 1e6 / queries);
+
+		//Bulk reads, in 64 MB blocks like a deep waveform download
+		const size_t blocksize = 64 * 1024 * 1024;
+		vector<unsigned char> block(blocksize);
+		size_t blocks = max((size_t)1, megabytes / 64);
+		start = GetTime();
+		for(size_t i=0; i<blocks; i++)
+		{
+			transport.SendCommandImmediate(string("DATA? ") + to_string(blocksize));
+			if(transport.ReadRawData(blocksize, &block[0]) != blocksize)
+			{
+				LogError("Bulk read %zu failed\n", i);
+				ret = 1;
+				break;
+			}
+		}
+		dt = GetTime() - start;
+		LogNotice("%zu MB bulk read: %.2f GB/s\n", blocks * 64, blocks * blocksize / dt * 1e-9);
+	}
+
+	server.join();
+	close(listenfd);
+	return ret;
+}
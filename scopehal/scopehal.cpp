@@ -355,6 +355,8 @@ void DetectGPUFeatures()
 
 void ScopehalStaticCleanup()
 {
+	WaveformPool::Clear();
+
 	#ifdef HAVE_OPENCL
 	#ifdef HAVE_CLFFT
 	clfftTeardown();
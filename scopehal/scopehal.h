@@ -82,6 +82,10 @@
 #include "VICPSocketTransport.h"
 #include "SCPIDevice.h"
 
+#include "WaveformPool.h"
+#include "EdgeCache.h"
+#include "WaveformSummary.h"
+#include "ADCCodeWaveform.h"
 #include "FlowGraphNode.h"
 #include "OscilloscopeChannel.h"
 #include "StreamDescriptor_inlines.h"
@@ -107,12 +111,14 @@
 
 #include "Statistic.h"
 #include "FilterParameter.h"
+#include "FilterProfiler.h"
 #include "Filter.h"
 #include "ImportFilter.h"
 #include "PeakDetectionFilter.h"
 #include "SpectrumChannel.h"
 #include "SParameterSourceFilter.h"
 #include "SParameterFilter.h"
+#include "FilterGraphExecutor.h"
 
 #include "ExportWizard.h"
 
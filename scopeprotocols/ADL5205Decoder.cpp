@@ -84,7 +84,7 @@ void ADL5205Decoder::Refresh()
 	size_t len = din->m_samples.size();
 
 	//Loop over the SPI events and process stuff
-	auto cap = new ADL5205Waveform;
+	auto cap = WaveformPool::Get<ADL5205Waveform>();
 	cap->m_timescale = din->m_timescale;
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startFemtoseconds = din->m_startFemtoseconds;
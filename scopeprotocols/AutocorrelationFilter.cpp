@@ -37,6 +37,9 @@ using namespace std;
 
 AutocorrelationFilter::AutocorrelationFilter(const string& color)
 	: Filter(OscilloscopeChannel::CHANNEL_TYPE_ANALOG, color, CAT_MATH)
+	, m_cachedNumPoints(0)
+	, m_forwardPlan(NULL)
+	, m_reversePlan(NULL)
 {
 	//Set up inputs
 	CreateInput("din");
@@ -46,6 +49,14 @@ AutocorrelationFilter::AutocorrelationFilter(const string& color)
 	m_parameters[m_maxDeltaName].SetIntVal(1000);
 }
 
+AutocorrelationFilter::~AutocorrelationFilter()
+{
+	if(m_forwardPlan)
+		ffts_free(m_forwardPlan);
+	if(m_reversePlan)
+		ffts_free(m_reversePlan);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Factory methods
 
@@ -79,7 +90,7 @@ void AutocorrelationFilter::Refresh()
 		return;
 	}
 
-	auto din = dynamic_cast<AnalogWaveform*>(GetInputWaveform(0));
+	auto din = GetAnalogInputWaveform(0);
 	auto len = din->m_samples.size();
 
 	//Copy the units
@@ -94,24 +105,97 @@ void AutocorrelationFilter::Refresh()
 	}
 
 	//Set up the output waveform
-	auto cap = new AnalogWaveform;
+	auto cap = SetupEmptyOutputWaveform(din, 0, false);
+	cap->Resize(range);
+	for(size_t i=0; i<range; i++)
+	{
+		cap->m_offsets[i] = i+1;
+		cap->m_durations[i] = 1;
+	}
 
-	size_t end = len - range;
+	//FFT costs a few passes over the waveform regardless of the range, so it's only worth it for larger ranges
+	if(range > 32)
+		DoRefreshFFT(din, cap, range);
+	else
+		DoRefreshDirect(din, cap, range);
+
+	//Copy our time scales from the input
+	cap->m_timescale 		= din->m_timescale;
+	cap->m_startTimestamp 	= din->m_startTimestamp;
+	cap->m_startFemtoseconds = din->m_startFemtoseconds;
+}
+
+/**
+	@brief Calculates each lag directly
+ */
+void AutocorrelationFilter::DoRefreshDirect(AnalogWaveform* din, AnalogWaveform* cap, size_t range)
+{
+	size_t end = din->m_samples.size() - range;
 	for(size_t delta=1; delta <= range; delta ++)
 	{
 		double total = 0;
 		for(size_t i=0; i<end; i++)
 			total += din->m_samples[i] * din->m_samples[i+delta];
 
-		cap->m_samples.push_back(total / end);
-		cap->m_offsets.push_back(delta);
-		cap->m_durations.push_back(1);
+		cap->m_samples[delta-1] = total / end;
 	}
+}
 
-	//Copy our time scales from the input
-	cap->m_timescale 		= din->m_timescale;
-	cap->m_startTimestamp 	= din->m_startTimestamp;
-	cap->m_startFemtoseconds = din->m_startFemtoseconds;
+/**
+	@brief Calculates all lags at once by FFT (Wiener-Khinchin theorem)
 
-	SetData(cap, 0);
+	Every lag sums over the same leading end = len - range samples, so this is the cross-correlation of that leading
+	segment with the whole waveform. Since i + delta < len for every term, zero padding to len points is enough to
+	keep the circular correlation from wrapping around.
+ */
+void AutocorrelationFilter::DoRefreshFFT(AnalogWaveform* din, AnalogWaveform* cap, size_t range)
+{
+	size_t len = din->m_samples.size();
+	size_t end = len - range;
+	const size_t npoints = next_pow2(len);
+	size_t nouts = npoints/2 + 1;
+
+	//Set up the FFT and allocate buffers if we change point count
+	if(m_cachedNumPoints != npoints)
+	{
+		if(m_forwardPlan)
+			ffts_free(m_forwardPlan);
+		m_forwardPlan = ffts_init_1d_real(npoints, FFTS_FORWARD);
+
+		if(m_reversePlan)
+			ffts_free(m_reversePlan);
+		m_reversePlan = ffts_init_1d_real(npoints, FFTS_BACKWARD);
+
+		m_timeBuf.resize(npoints);
+		m_leadSpectrum.resize(2 * nouts);
+		m_fullSpectrum.resize(2 * nouts);
+
+		m_cachedNumPoints = npoints;
+	}
+
+	//Transform the leading segment, then the whole waveform, zero padding both
+	memcpy(&m_timeBuf[0], &din->m_samples[0], end * sizeof(float));
+	memset(&m_timeBuf[end], 0, (npoints - end) * sizeof(float));
+	ffts_execute(m_forwardPlan, &m_timeBuf[0], &m_leadSpectrum[0]);
+
+	memcpy(&m_timeBuf[end], &din->m_samples[end], range * sizeof(float));
+	ffts_execute(m_forwardPlan, &m_timeBuf[0], &m_fullSpectrum[0]);
+
+	//Cross-correlation is the product of the conjugate of one spectrum with the other
+	for(size_t i=0; i<nouts; i++)
+	{
+		float are = m_leadSpectrum[i*2];
+		float aim = m_leadSpectrum[i*2 + 1];
+		float bre = m_fullSpectrum[i*2];
+		float bim = m_fullSpectrum[i*2 + 1];
+		m_fullSpectrum[i*2]		= are*bre + aim*bim;
+		m_fullSpectrum[i*2 + 1]	= are*bim - aim*bre;
+	}
+
+	ffts_execute(m_reversePlan, &m_fullSpectrum[0], &m_timeBuf[0]);
+
+	//Normalize for the inverse FFT and the number of terms in each sum
+	float scale = 1.0f / (npoints * (double)end);
+	for(size_t delta=1; delta <= range; delta ++)
+		cap->m_samples[delta-1] = m_timeBuf[delta] * scale;
 }
@@ -35,10 +35,13 @@
 #ifndef AutocorrelationFilter_h
 #define AutocorrelationFilter_h
 
+#include <ffts.h>
+
 class AutocorrelationFilter : public Filter
 {
 public:
 	AutocorrelationFilter(const std::string& color);
+	virtual ~AutocorrelationFilter();
 
 	virtual void Refresh();
 
@@ -49,7 +52,18 @@ public:
 	PROTOCOL_DECODER_INITPROC(AutocorrelationFilter)
 
 protected:
+	void DoRefreshDirect(AnalogWaveform* din, AnalogWaveform* cap, size_t range);
+	void DoRefreshFFT(AnalogWaveform* din, AnalogWaveform* cap, size_t range);
+
 	std::string m_maxDeltaName;
+
+	size_t m_cachedNumPoints;
+	ffts_plan_t* m_forwardPlan;
+	ffts_plan_t* m_reversePlan;
+
+	std::vector<float, AlignedAllocator<float, 64> > m_timeBuf;
+	std::vector<float, AlignedAllocator<float, 64> > m_leadSpectrum;
+	std::vector<float, AlignedAllocator<float, 64> > m_fullSpectrum;
 };
 
 #endif
@@ -45,7 +45,7 @@ string AverageStatistic::GetStatisticName()
 bool AverageStatistic::Calculate(StreamDescriptor stream, double& value)
 {
 	//Can't do anything if we have no data
-	auto data = dynamic_cast<AnalogWaveform*>(stream.GetData());
+	auto data = GetAnalogWaveform(stream.GetData());
 	if(!data)
 		return false;
 
@@ -104,7 +104,7 @@ void BaseMeasurement::Refresh()
 	float global_base = fbin*range + vmin;
 
 	//Create the output
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 
 	float last = vmin;
 	int64_t tfall = 0;
@@ -89,7 +89,7 @@ void CANDecoder::Refresh()
 	auto diff = dynamic_cast<DigitalWaveform*>(GetInputWaveform(0));
 
 	//Create the capture
-	auto cap = new CANWaveform;
+	auto cap = WaveformPool::Get<CANWaveform>();
 	cap->m_timescale = diff->m_timescale;
 	cap->m_startTimestamp = diff->m_startTimestamp;
 	cap->m_startFemtoseconds = diff->m_startFemtoseconds;
@@ -266,7 +266,7 @@ void CSVImportFilter::OnFileNameChanged()
 		{
 			AddStream(Unit(Unit::UNIT_COUNTS), names[i]);
 
-			auto wfm = new DigitalWaveform;
+			auto wfm = WaveformPool::Get<DigitalWaveform>();
 			wfm->m_timescale = 1;
 			wfm->m_startTimestamp = timestamp;
 			wfm->m_startFemtoseconds = fs;
@@ -283,7 +283,7 @@ void CSVImportFilter::OnFileNameChanged()
 		{
 			AddStream(Unit(Unit::UNIT_VOLTS), names[i]);
 
-			auto wfm = new AnalogWaveform;
+			auto wfm = WaveformPool::Get<AnalogWaveform>();
 			wfm->m_timescale = 1;
 			wfm->m_startTimestamp = timestamp;
 			wfm->m_startFemtoseconds = fs;
@@ -120,7 +120,7 @@ void ClockRecoveryFilter::Refresh()
 	int64_t period = round(FS_PER_SECOND / m_parameters[m_baudname].GetFloatVal());
 
 	//Create the output waveform and copy our timescales
-	auto cap = new DigitalWaveform;
+	auto cap = WaveformPool::Get<DigitalWaveform>();
 	if(adin)
 	{
 		cap->m_startTimestamp = adin->m_startTimestamp;
@@ -112,7 +112,7 @@ void ComplexImportFilter::Reload()
 		return;
 	int64_t interval = FS_PER_SECOND / samplerate;
 
-	auto iwfm = new AnalogWaveform;
+	auto iwfm = WaveformPool::Get<AnalogWaveform>();
 	iwfm->m_timescale = interval;
 	iwfm->m_startTimestamp = timestamp;
 	iwfm->m_startFemtoseconds = fs;
@@ -120,7 +120,7 @@ void ComplexImportFilter::Reload()
 	iwfm->m_densePacked = true;
 	SetData(iwfm, 0);
 
-	auto qwfm = new AnalogWaveform;
+	auto qwfm = WaveformPool::Get<AnalogWaveform>();
 	qwfm->m_timescale = interval;
 	qwfm->m_startTimestamp = timestamp;
 	qwfm->m_startFemtoseconds = fs;
@@ -83,6 +83,11 @@ void DCOffsetFilter::SetDefaultName()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Actual decoder logic
 
+bool DCOffsetFilter::SupportsIncrementalRefresh()
+{
+	return true;
+}
+
 void DCOffsetFilter::Refresh()
 {
 	//Make sure we've got valid inputs
@@ -101,6 +106,6 @@ void DCOffsetFilter::Refresh()
 	auto cap = SetupOutputWaveform(din, 0, 0, 0);
 	float* out = (float*)__builtin_assume_aligned(&cap->m_samples[0], 16);
 	float* a = (float*)__builtin_assume_aligned(&din->m_samples[0], 16);
-	for(size_t i=0; i<len; i++)
+	for(size_t i=GetFirstNewSample(0); i<len; i++)
 		out[i] 		= a[i] + offset;
 }
@@ -181,7 +181,7 @@ void DDJMeasurement::Refresh()
 			m_table[i] = 0;
 	}
 
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 	cap->m_offsets.push_back(0);
 	cap->m_durations.push_back(1);
 	cap->m_samples.push_back(ddjmax - ddjmin);
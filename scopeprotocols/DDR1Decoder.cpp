@@ -102,7 +102,7 @@ void DDR1Decoder::Refresh()
 	SampleOnRisingEdges(caps[5], cclk, a10);
 
 	//Create the capture
-	auto cap = new SDRAMWaveform;
+	auto cap = WaveformPool::Get<SDRAMWaveform>();
 	cap->m_timescale = 1;
 	cap->m_startTimestamp = cclk->m_startTimestamp;
 	cap->m_startFemtoseconds = 0;
@@ -105,7 +105,7 @@ void DDR3Decoder::Refresh()
 	SampleOnRisingEdges(caps[6], cclk, a10);
 
 	//Create the capture
-	auto cap = new SDRAMWaveform;
+	auto cap = WaveformPool::Get<SDRAMWaveform>();
 	cap->m_timescale = 1;
 	cap->m_startTimestamp = cclk->m_startTimestamp;
 	cap->m_startFemtoseconds = 0;
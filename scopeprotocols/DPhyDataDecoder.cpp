@@ -80,7 +80,7 @@ void DPhyDataDecoder::Refresh()
 	auto data = dynamic_cast<DPhySymbolWaveform*>(GetInputWaveform(1));
 
 	//Create output waveform
-	auto cap = new DPhyDataWaveform;
+	auto cap = WaveformPool::Get<DPhyDataWaveform>();
 	cap->m_timescale = data->m_timescale;
 	cap->m_startTimestamp = data->m_startTimestamp;
 	cap->m_startFemtoseconds = data->m_startFemtoseconds;
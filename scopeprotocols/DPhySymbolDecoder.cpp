@@ -102,7 +102,7 @@ void DPhySymbolDecoder::Refresh()
 		len = min(len, dn->m_samples.size());
 
 	//Create output waveform
-	DPhySymbolWaveform* cap = new DPhySymbolWaveform;
+	DPhySymbolWaveform* cap = WaveformPool::Get<DPhySymbolWaveform>();
 	cap->m_timescale = 1;
 	cap->m_startTimestamp = dp->m_startTimestamp;
 	cap->m_startFemtoseconds = dp->m_startFemtoseconds;
@@ -96,7 +96,7 @@ void DSIFrameDecoder::Refresh()
 	auto din = dynamic_cast<DSIWaveform*>(GetInputWaveform(0));
 
 	//Create the capture
-	DSIFrameWaveform* cap = new DSIFrameWaveform;
+	DSIFrameWaveform* cap = WaveformPool::Get<DSIFrameWaveform>();
 	cap->m_timescale = din->m_timescale;
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startFemtoseconds = din->m_startFemtoseconds;
@@ -100,7 +100,7 @@ void DSIPacketDecoder::Refresh()
 	} state = STATE_IDLE;
 
 	//Create output waveform
-	auto cap = new DSIWaveform;
+	auto cap = WaveformPool::Get<DSIWaveform>();
 	cap->m_timescale = din->m_timescale;
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startFemtoseconds = din->m_startFemtoseconds;
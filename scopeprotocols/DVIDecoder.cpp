@@ -108,7 +108,7 @@ void DVIDecoder::Refresh()
 	auto dred = dynamic_cast<TMDSWaveform*>(GetInputWaveform(2));
 
 	//Create the capture
-	DVIWaveform* cap = new DVIWaveform;
+	DVIWaveform* cap = WaveformPool::Get<DVIWaveform>();
 	cap->m_timescale = 1;
 	cap->m_startTimestamp = dblue->m_startTimestamp;
 	cap->m_startFemtoseconds = dblue->m_startFemtoseconds;
@@ -74,6 +74,11 @@ string DivideFilter::GetProtocolName()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Actual decoder logic
 
+bool DivideFilter::SupportsIncrementalRefresh()
+{
+	return true;
+}
+
 void DivideFilter::Refresh()
 {
 	//Make sure we've got valid inputs
@@ -96,6 +101,7 @@ void DivideFilter::Refresh()
 	float* fdst = (float*)__builtin_assume_aligned(&cap->m_samples[0], 16);
 
 	auto format = m_parameters[m_formatName].GetIntVal();
+	size_t start = min(GetFirstNewSample(0), GetFirstNewSample(1));
 
 	if(format == FORMAT_RATIO)
 	{
@@ -104,14 +110,14 @@ void DivideFilter::Refresh()
 		//Divide the units
 		//m_yAxisUnit = m_inputs[0].m_channel->GetYAxisUnits() / m_inputs[1].m_channel->GetYAxisUnits();
 
-		for(size_t i=0; i<len; i++)
+		for(size_t i=start; i<len; i++)
 			fdst[i] = fa[i] / fb[i];
 	}
 	else /*if(format == FORMAT_DB) */
 	{
 		SetYAxisUnits(Unit(Unit::UNIT_DB), 0);
 
-		for(size_t i=0; i<len; i++)
+		for(size_t i=start; i<len; i++)
 			fdst[i] = 20 * log10(fa[i] / fb[i]);
 	}
 }
@@ -76,8 +76,11 @@ bool DramClockFilter::ValidateChannel(size_t i, StreamDescriptor stream)
 		return true;
 	if( (i == 1) && (dynamic_cast<DigitalWaveform*>(stream.m_channel->GetData(stream.m_stream)) != NULL ) )
 		return true;
-	if( (i == 2) && (dynamic_cast<AnalogWaveform*>(stream.m_channel->GetData(stream.m_stream)) != NULL ) )
-		return true;
+	if(i == 2)
+	{
+		if(IsAnalogWaveform(stream.m_channel->GetData(stream.m_stream)))
+			return true;
+	}
 
 	return false;
 }
@@ -118,8 +121,8 @@ void DramClockFilter::Refresh()
 	FindZeroCrossings(clk, clkedges);
 
 	//Create output waveforms
-	auto rdclk = new DigitalWaveform;
-	auto wrclk = new DigitalWaveform;
+	auto rdclk = WaveformPool::Get<DigitalWaveform>();
+	auto wrclk = WaveformPool::Get<DigitalWaveform>();
 	rdclk->m_timescale 			= 1;
 	wrclk->m_timescale 			= 1;
 	SetData(rdclk, 0);
@@ -81,7 +81,7 @@ void DramRefreshActivateMeasurement::Refresh()
 	auto din = dynamic_cast<SDRAMWaveform*>(GetInputWaveform(0));
 
 	//Create the output
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 
 	//Measure delay from refreshing a bank until an activation to the same bank
 	int64_t lastRef[8] = {0, 0, 0, 0, 0, 0, 0, 0};
@@ -124,7 +124,7 @@ void DramRefreshActivateMeasurement::Refresh()
 
 	if(cap->m_samples.empty())
 	{
-		delete cap;
+		WaveformPool::Return(cap);
 		SetData(NULL, 0);
 		return;
 	}
@@ -81,7 +81,7 @@ void DramRowColumnLatencyMeasurement::Refresh()
 	auto din = dynamic_cast<SDRAMWaveform*>(GetInputWaveform(0));
 
 	//Create the output
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 
 	//Measure delay from activating a row in a bank until a read or write to the same bank
 	int64_t lastAct[8] = {0, 0, 0, 0, 0, 0, 0, 0};
@@ -127,7 +127,7 @@ void DramRowColumnLatencyMeasurement::Refresh()
 
 	if(cap->m_samples.empty())
 	{
-		delete cap;
+		WaveformPool::Return(cap);
 		SetData(NULL, 0);
 		return;
 	}
@@ -120,7 +120,7 @@ void ESPIDecoder::Refresh()
 	int64_t timestamp	= 0;
 
 	//Create the waveform. Call SetData() early on so we can use GetText() in the packet decode
-	auto cap = new ESPIWaveform;
+	auto cap = WaveformPool::Get<ESPIWaveform>();
 	cap->m_timescale = clk->m_timescale;
 	cap->m_startTimestamp = clk->m_startTimestamp;
 	cap->m_startFemtoseconds = clk->m_startFemtoseconds;
@@ -81,7 +81,7 @@ void Ethernet1000BaseXDecoder::Refresh()
 	auto data = dynamic_cast<IBM8b10bWaveform*>(GetInputWaveform(0));
 
 	//Create the output capture
-	auto cap = new EthernetWaveform;
+	auto cap = WaveformPool::Get<EthernetWaveform>();
 	cap->m_timescale = data->m_timescale;
 	cap->m_startTimestamp = data->m_startTimestamp;
 	cap->m_startFemtoseconds = data->m_startFemtoseconds;
@@ -66,7 +66,7 @@ void Ethernet100BaseTDecoder::Refresh()
 	auto din = GetAnalogInputWaveform(0);
 
 	//Copy our time scales from the input
-	EthernetWaveform* cap = new EthernetWaveform;
+	EthernetWaveform* cap = WaveformPool::Get<EthernetWaveform>();
 	cap->m_timescale = din->m_timescale;
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startFemtoseconds = din->m_startFemtoseconds;
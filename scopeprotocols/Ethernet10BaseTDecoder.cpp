@@ -71,7 +71,7 @@ void Ethernet10BaseTDecoder::Refresh()
 	size_t len = din->m_samples.size();
 
 	//Copy our time scales from the input
-	auto cap = new EthernetWaveform;
+	auto cap = WaveformPool::Get<EthernetWaveform>();
 	cap->m_timescale = din->m_timescale;
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startFemtoseconds = din->m_startFemtoseconds;
@@ -82,7 +82,7 @@ void Ethernet10GBaseRDecoder::Refresh()
 	auto data = dynamic_cast<Ethernet64b66bWaveform*>(GetInputWaveform(0));
 
 	//Create the output capture
-	auto cap = new EthernetWaveform;
+	auto cap = WaveformPool::Get<EthernetWaveform>();
 	cap->m_timescale = data->m_timescale;
 	cap->m_startTimestamp = data->m_startTimestamp;
 	cap->m_startFemtoseconds = data->m_startFemtoseconds;
@@ -83,7 +83,7 @@ void Ethernet64b66bDecoder::Refresh()
 	auto clkin = GetDigitalInputWaveform(1);
 
 	//Create the capture
-	auto cap = new Ethernet64b66bWaveform;
+	auto cap = WaveformPool::Get<Ethernet64b66bWaveform>();
 	cap->m_timescale = 1;
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startFemtoseconds = din->m_startFemtoseconds;
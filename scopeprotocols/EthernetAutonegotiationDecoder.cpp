@@ -82,7 +82,7 @@ void EthernetAutonegotiationDecoder::Refresh()
 	auto din = GetAnalogInputWaveform(0);
 
 	//Create the outbound data
-	auto* cap = new EthernetAutonegotiationWaveform;
+	auto* cap = WaveformPool::Get<EthernetAutonegotiationWaveform>();
 	cap->m_timescale = din->m_timescale;
 
 	//Crunch it
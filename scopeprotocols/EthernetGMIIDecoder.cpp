@@ -109,7 +109,7 @@ void EthernetGMIIDecoder::Refresh()
 	SampleOnRisingEdges(data, clk, ddata);
 
 	//Create the output capture
-	auto cap = new EthernetWaveform;
+	auto cap = WaveformPool::Get<EthernetWaveform>();
 	cap->m_timescale = 1;
 	cap->m_startTimestamp = data->m_startTimestamp;
 	cap->m_startFemtoseconds = data->m_startFemtoseconds;
@@ -130,15 +130,7 @@ void EthernetGMIIDecoder::Refresh()
 		//TODO: handle error signal (ignored for now)
 		while( (i < len) && (den.m_samples[i]) )
 		{
-			//Convert bits to bytes
-			uint8_t dval = 0;
-			for(size_t j=0; j<8; j++)
-			{
-				if(ddata.m_samples[i][j])
-					dval |= (1 << j);
-			}
-
-			bytes.push_back(dval);
+			bytes.push_back(ddata.m_samples[i] & 0xff);
 			starts.push_back(ddata.m_offsets[i]);
 			ends.push_back(ddata.m_offsets[i] + ddata.m_durations[i]);
 			i++;
@@ -114,7 +114,7 @@ void EthernetRGMIIDecoder::Refresh()
 	len -= 4;
 
 	//Create the output capture
-	auto cap = new EthernetWaveform;
+	auto cap = WaveformPool::Get<EthernetWaveform>();
 	cap->m_timescale = 1;
 	cap->m_startTimestamp = data->m_startTimestamp;
 	cap->m_startFemtoseconds = data->m_startFemtoseconds;
@@ -126,12 +126,7 @@ void EthernetRGMIIDecoder::Refresh()
 		if(!dctl.m_samples[i])
 		{
 			//Extract in-band status
-			uint8_t status = 0;
-			for(size_t j=0; j<4; j++)
-			{
-				if(ddata.m_samples[i][j])
-					status |= (1 << j);
-			}
+			uint8_t status = ddata.m_samples[i] & 0xf;
 
 			//Same status? Merge samples
 			bool extend = false;
@@ -181,19 +176,8 @@ void EthernetRGMIIDecoder::Refresh()
 
 			if(ddr)
 			{
-				//Convert bits to bytes
-				uint8_t dval = 0;
-				for(size_t j=0; j<8; j++)
-				{
-					if(j < 4)
-					{
-						if(ddata.m_samples[i][j])
-							dval |= (1 << j);
-					}
-					else if(ddata.m_samples[i+1][j-4])
-						dval |= (1 << j);
-				}
-				bytes.push_back(dval);
+				//Low nibble on the rising edge, high nibble on the falling edge
+				bytes.push_back( (ddata.m_samples[i] & 0xf) | ( (ddata.m_samples[i+1] & 0xf) << 4) );
 
 				ends.push_back(ddata.m_offsets[i+1] + ddata.m_durations[i+1]);
 				i += 2;
@@ -201,19 +185,8 @@ void EthernetRGMIIDecoder::Refresh()
 
 			else
 			{
-				//Convert bits to bytes
-				uint8_t dval = 0;
-				for(size_t j=0; j<8; j++)
-				{
-					if(j < 4)
-					{
-						if(ddata.m_samples[i][j])
-							dval |= (1 << j);
-					}
-					else if(ddata.m_samples[i+2][j-4])
-						dval |= (1 << j);
-				}
-				bytes.push_back(dval);
+				//Low nibble first, then high nibble one clock later
+				bytes.push_back( (ddata.m_samples[i] & 0xf) | ( (ddata.m_samples[i+2] & 0xf) << 4) );
 
 				ends.push_back(ddata.m_offsets[i+3] + ddata.m_durations[i+3]);
 				i += 4;
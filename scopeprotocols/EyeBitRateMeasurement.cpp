@@ -90,7 +90,7 @@ void EyeBitRateMeasurement::Refresh()
 	auto din = dynamic_cast<EyeWaveform*>(GetInputWaveform(0));
 
 	//Create the output
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 	cap->m_offsets.push_back(0);
 	cap->m_durations.push_back(2 * din->m_uiWidth);
 	m_value = FS_PER_SECOND / din->m_uiWidth;
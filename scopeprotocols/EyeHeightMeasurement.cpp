@@ -96,7 +96,7 @@ void EyeHeightMeasurement::Refresh()
 	auto din = dynamic_cast<EyeWaveform*>(GetInputWaveform(0));
 
 	//Create the output
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 
 	//Make sure times are in the right order
 	float tstart = m_parameters[m_startname].GetFloatVal();
@@ -38,7 +38,7 @@
 
 #include "EyeMask.h"
 
-class EyeWaveform : public WaveformBase
+class EyeWaveform : public DensityFunctionWaveform
 {
 public:
 	EyeWaveform(size_t width, size_t height, float center);
@@ -92,7 +92,7 @@ void EyeWidthMeasurement::Refresh()
 	auto din = dynamic_cast<EyeWaveform*>(GetInputWaveform(0));
 
 	//Create the output
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 
 	//Make sure voltages are in the right order
 	float vstart = m_parameters[m_startname].GetFloatVal();
@@ -298,9 +298,15 @@ void FFTFilter::Refresh()
 		SetData(NULL, 0);
 		return;
 	}
-	auto din = GetAnalogInputWaveform(0);
 
-	const size_t npoints_raw = din->m_samples.size();
+	//Uniformly sampled inputs are used as is, there's no need to expand their timestamps
+	auto udin = GetUniformAnalogInputWaveform(0);
+	AnalogWaveform* din = NULL;
+	if(!udin)
+		din = GetAnalogInputWaveform(0);
+	auto& samples = udin ? udin->m_samples : din->m_samples;
+
+	const size_t npoints_raw = samples.size();
 	size_t npoints;
 	if(m_parameters[m_roundingName].GetIntVal() == ROUND_TRUNCATE)
 		npoints = prev_pow2(npoints_raw);
@@ -315,12 +321,17 @@ void FFTFilter::Refresh()
 		ReallocateBuffers(npoints_raw, npoints, nouts);
 	LogTrace("Output: %zu\n", nouts);
 
-	double fs = din->m_timescale * (din->m_offsets[1] - din->m_offsets[0]);
-	DoRefresh(din, din->m_samples, fs, npoints, nouts, true);
+	if(udin)
+		DoRefresh(udin, samples, udin->m_timescale, npoints, nouts, true);
+	else
+	{
+		double fs = din->m_timescale * (din->m_offsets[1] - din->m_offsets[0]);
+		DoRefresh(din, samples, fs, npoints, nouts, true);
+	}
 }
 
 void FFTFilter::DoRefresh(
-	AnalogWaveform* din,
+	WaveformBase* din,
 	vector<EmptyConstructorWrapper<float>, AlignedAllocator<EmptyConstructorWrapper<float>, 64>>& data,
 	double fs_per_sample,
 	size_t npoints,
@@ -337,7 +348,7 @@ void FFTFilter::DoRefresh(
 	AnalogWaveform* cap = dynamic_cast<AnalogWaveform*>(GetData(0));
 	if(cap == NULL)
 	{
-		cap = new AnalogWaveform;
+		cap = WaveformPool::Get<AnalogWaveform>();
 		SetData(cap, 0);
 	}
 	cap->m_startTimestamp = din->m_startTimestamp;
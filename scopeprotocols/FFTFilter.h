@@ -92,7 +92,7 @@ protected:
 	void ReallocateBuffers(size_t npoints_raw, size_t npoints, size_t nouts);
 
 	void DoRefresh(
-		AnalogWaveform* din,
+		WaveformBase* din,
 		std::vector<EmptyConstructorWrapper<float>, AlignedAllocator<EmptyConstructorWrapper<float>, 64>>& data,
 		double fs_per_sample, size_t npoints, size_t nouts, bool log_output);
 
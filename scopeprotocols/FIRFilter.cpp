@@ -30,6 +30,7 @@
 #include "scopeprotocols.h"
 #include "FIRFilter.h"
 #include <immintrin.h>
+#include <omp.h>
 
 using namespace std;
 
@@ -227,6 +228,20 @@ void FIRFilter::DoFilterKernel(
 	else
 	#endif
 
+	if(coefficients.size() >= GetFFTCrossover())
+		DoFilterKernelFFT(coefficients, din, cap, m_fftState);
+	else
+		DoFilterKernelDirect(coefficients, din, cap);
+}
+
+/**
+	@brief Performs a FIR filter by direct convolution, using the best instruction set available
+ */
+void FIRFilter::DoFilterKernelDirect(
+	vector<float>& coefficients,
+	AnalogWaveform* din,
+	AnalogWaveform* cap)
+{
 	if(g_hasAvx512F)
 		DoFilterKernelAVX512F(coefficients, din, cap);
 	else if(g_hasAvx2)
@@ -235,6 +250,209 @@ void FIRFilter::DoFilterKernel(
 		DoFilterKernelGeneric(coefficients, din, cap);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// FFT convolution
+
+FIRFilter::FFTState::FFTState()
+	: m_fftSize(0)
+{
+}
+
+FIRFilter::FFTState::~FFTState()
+{
+	FreePlans();
+}
+
+void FIRFilter::FFTState::FreePlans()
+{
+	for(auto plan : m_forwardPlans)
+		ffts_free(plan);
+	for(auto plan : m_reversePlans)
+		ffts_free(plan);
+	m_forwardPlans.clear();
+	m_reversePlans.clear();
+}
+
+/**
+	@brief Creates plans and buffers for a filter, and calculates its frequency response
+
+	Nothing is recalculated if the coefficients and thread count are the same as last time.
+ */
+void FIRFilter::FFTState::Setup(const vector<float>& coefficients)
+{
+	//Use an FFT several times longer than the filter, so most of each block is valid output
+	size_t filterlen = coefficients.size();
+	size_t fftsize = max(next_pow2(filterlen * 4), (uint64_t)1024);
+	size_t nthreads = omp_get_max_threads();
+
+	if( (fftsize != m_fftSize) || (nthreads != m_forwardPlans.size()) )
+	{
+		FreePlans();
+		for(size_t i=0; i<nthreads; i++)
+		{
+			m_forwardPlans.push_back(ffts_init_1d_real(fftsize, FFTS_FORWARD));
+			m_reversePlans.push_back(ffts_init_1d_real(fftsize, FFTS_BACKWARD));
+		}
+
+		m_timeBufs.resize(nthreads);
+		m_freqBufs.resize(nthreads);
+		for(size_t i=0; i<nthreads; i++)
+		{
+			m_timeBufs[i].resize(fftsize);
+			m_freqBufs[i].resize(fftsize + 2);
+		}
+
+		m_fftSize = fftsize;
+		m_coefficients.clear();
+	}
+
+	if(coefficients == m_coefficients)
+		return;
+	m_coefficients = coefficients;
+
+	//The direct kernels correlate with the coefficients, so reverse them to get the equivalent convolution.
+	//Fold the inverse FFT's scaling into the response while we're at it.
+	auto& buf = m_timeBufs[0];
+	for(size_t i=0; i<filterlen; i++)
+		buf[i] = coefficients[filterlen - 1 - i] / fftsize;
+	for(size_t i=filterlen; i<fftsize; i++)
+		buf[i] = 0;
+
+	m_spectrum.resize(fftsize + 2);
+	ffts_execute(m_forwardPlans[0], &buf[0], &m_spectrum[0]);
+}
+
+/**
+	@brief Performs a FIR filter by overlap-save FFT convolution
+
+	Cost per sample grows with the log of the filter length rather than linearly, so this wins for long filters.
+	Blocks are independent and run in parallel.
+ */
+void FIRFilter::DoFilterKernelFFT(
+	vector<float>& coefficients,
+	AnalogWaveform* din,
+	AnalogWaveform* cap,
+	FFTState& state)
+{
+	size_t len = din->m_samples.size();
+	size_t filterlen = coefficients.size();
+	if(len <= filterlen)
+		return;
+	size_t end = len - filterlen;
+
+	state.Setup(coefficients);
+
+	//Each block overlaps the previous one by filterlen-1 samples, which are corrupted by circular wraparound
+	size_t fftsize = state.m_fftSize;
+	size_t step = fftsize - (filterlen - 1);
+	size_t nblocks = (end + step - 1) / step;
+	size_t nouts = fftsize/2 + 1;
+
+	const float* pin = (const float*)&din->m_samples[0];
+	float* pout = (float*)&cap->m_samples[0];
+	const float* response = &state.m_spectrum[0];
+
+	#pragma omp parallel for
+	for(size_t block=0; block<nblocks; block++)
+	{
+		int tid = omp_get_thread_num();
+		float* tbuf = &state.m_timeBufs[tid][0];
+		float* fbuf = &state.m_freqBufs[tid][0];
+
+		//Copy the input, then fill any extra space past the end of the waveform with zeroes
+		size_t base = block * step;
+		size_t navail = min(fftsize, len - base);
+		memcpy(tbuf, pin + base, navail * sizeof(float));
+		for(size_t i=navail; i<fftsize; i++)
+			tbuf[i] = 0;
+
+		ffts_execute(state.m_forwardPlans[tid], tbuf, fbuf);
+
+		//Apply the filter response
+		for(size_t i=0; i<nouts; i++)
+		{
+			float re = fbuf[i*2];
+			float im = fbuf[i*2 + 1];
+			float hre = response[i*2];
+			float him = response[i*2 + 1];
+			fbuf[i*2]		= re*hre - im*him;
+			fbuf[i*2 + 1]	= re*him + im*hre;
+		}
+
+		ffts_execute(state.m_reversePlans[tid], fbuf, tbuf);
+
+		//Keep the valid part
+		size_t nvalid = min(step, end - base);
+		memcpy(pout + base, tbuf + filterlen - 1, nvalid * sizeof(float));
+	}
+}
+
+atomic<size_t> FIRFilter::m_fftCrossover(FIRFilter::DEFAULT_FFT_CROSSOVER);
+
+/**
+	@brief Gets the shortest filter which is run by FFT rather than by direct convolution
+ */
+size_t FIRFilter::GetFFTCrossover()
+{
+	return m_fftCrossover;
+}
+
+/**
+	@brief Overrides the filter length at which FIR filters switch to FFT convolution
+
+	The best value depends on the CPU, instruction set, and core count. Applications that want it tuned can call
+	MeasureFFTCrossover() once at startup (or on a background thread) and pass the result here. It's deliberately not
+	measured during a refresh, since that would stall the first filter to run and make its output depend on load.
+ */
+void FIRFilter::SetFFTCrossover(size_t taps)
+{
+	m_fftCrossover = taps;
+}
+
+/**
+	@brief Times direct and FFT convolution at increasing filter lengths until FFT wins
+
+	Takes a few hundred milliseconds and uses every core, so don't call this from a refresh.
+ */
+size_t FIRFilter::MeasureFFTCrossover()
+{
+	//Only the size of the test signal matters, not its content
+	const size_t len = 65536;
+	AnalogWaveform din;
+	AnalogWaveform cap;
+	din.Resize(len);
+	cap.Resize(len);
+	for(size_t i=0; i<len; i++)
+		din.m_samples[i] = sin(i * 0.01f);
+
+	FFTState state;
+	for(size_t filterlen = 15; filterlen < 4096; filterlen = filterlen*2 + 1)
+	{
+		vector<float> coeffs(filterlen, 1.0f / filterlen);
+
+		//Best of a few runs, to filter out noise from other threads
+		double tdirect = FLT_MAX;
+		double tfft = FLT_MAX;
+		for(int i=0; i<3; i++)
+		{
+			double start = GetTime();
+			DoFilterKernelDirect(coeffs, &din, &cap);
+			double mid = GetTime();
+			DoFilterKernelFFT(coeffs, &din, &cap, state);
+			double end = GetTime();
+
+			tdirect = min(tdirect, mid - start);
+			tfft = min(tfft, end - mid);
+		}
+
+		if(tfft < tdirect)
+			return filterlen;
+	}
+
+	//FFT never wins, don't use it
+	return SIZE_MAX;
+}
+
 #ifdef HAVE_OPENCL
 void FIRFilter::DoFilterKernelOpenCL(
 		std::vector<float>& coefficients,
@@ -405,7 +623,7 @@ void FIRFilter::DoFilterKernelAVX2(
 	}
 
 	//Catch any stragglers
-	for(; i<end_rounded; i++)
+	for(; i<end; i++)
 	{
 		float v = 0;
 		for(size_t j=0; j<filterlen; j++)
@@ -475,7 +693,7 @@ void FIRFilter::DoFilterKernelAVX512F(
 	}
 
 	//Catch any stragglers
-	for(; i<end_rounded; i++)
+	for(; i<end; i++)
 	{
 		float v = 0;
 		for(size_t j=0; j<filterlen; j++)
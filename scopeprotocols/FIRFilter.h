@@ -35,6 +35,8 @@
 #ifndef FIRFilter_h
 #define FIRFilter_h
 
+#include <ffts.h>
+
 /**
 	@brief Performs an arbitrary FIR filter with tap delay equal to the sample rate
  */
@@ -65,6 +67,13 @@ public:
 		FILTER_TYPE_NOTCH
 	};
 
+	static size_t GetFFTCrossover();
+	static void SetFFTCrossover(size_t taps);
+	static size_t MeasureFFTCrossover();
+
+	///@brief Filter length at which FFT convolution is used unless overridden with SetFFTCrossover()
+	static const size_t DEFAULT_FFT_CROSSOVER = 64;
+
 protected:
 
 	static void CalculateFilterCoefficients(
@@ -76,7 +85,57 @@ protected:
 
 	static float Bessel(float x);
 
-	void DoFilterKernelGeneric(
+	/**
+		@brief Plans, buffers, and filter spectrum for overlap-save FFT convolution
+
+		Each thread gets its own plans and buffers since ffts plans can't be executed concurrently.
+	 */
+	class FFTState
+	{
+	public:
+		FFTState();
+		~FFTState();
+
+		FFTState(const FFTState&) =delete;
+		FFTState& operator=(const FFTState&) =delete;
+
+		void Setup(const std::vector<float>& coefficients);
+
+		///@brief FFT length, in samples
+		size_t m_fftSize;
+
+		///@brief Coefficients m_spectrum was calculated from
+		std::vector<float> m_coefficients;
+
+		///@brief Frequency response of the filter, interleaved real/imaginary, pre-scaled by 1/m_fftSize
+		std::vector<float, AlignedAllocator<float, 64> > m_spectrum;
+
+		std::vector<ffts_plan_t*> m_forwardPlans;
+		std::vector<ffts_plan_t*> m_reversePlans;
+		std::vector< std::vector<float, AlignedAllocator<float, 64> > > m_timeBufs;
+		std::vector< std::vector<float, AlignedAllocator<float, 64> > > m_freqBufs;
+
+	protected:
+		void FreePlans();
+	};
+
+	FFTState m_fftState;
+
+	///@brief Filters with at least this many taps use FFT convolution
+	static std::atomic<size_t> m_fftCrossover;
+
+	static void DoFilterKernelFFT(
+		std::vector<float>& coefficients,
+		AnalogWaveform* din,
+		AnalogWaveform* cap,
+		FFTState& state);
+
+	static void DoFilterKernelDirect(
+		std::vector<float>& coefficients,
+		AnalogWaveform* din,
+		AnalogWaveform* cap);
+
+	static void DoFilterKernelGeneric(
 		std::vector<float>& coefficients,
 		AnalogWaveform* din,
 		AnalogWaveform* cap);
@@ -88,12 +147,12 @@ protected:
 		AnalogWaveform* cap);
 #endif
 
-	void DoFilterKernelAVX2(
+	static void DoFilterKernelAVX2(
 		std::vector<float>& coefficients,
 		AnalogWaveform* din,
 		AnalogWaveform* cap);
 
-	void DoFilterKernelAVX512F(
+	static void DoFilterKernelAVX512F(
 		std::vector<float>& coefficients,
 		AnalogWaveform* din,
 		AnalogWaveform* cap);
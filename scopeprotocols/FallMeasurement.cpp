@@ -99,7 +99,7 @@ void FallMeasurement::Refresh()
 	float vend = base + m_parameters[m_endname].GetFloatVal()*delta;
 
 	//Create the output
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 
 	float last = -1e20;
 	double tedge = 0;
@@ -86,26 +86,24 @@ void FrequencyMeasurement::Refresh()
 
 	auto din = GetInputWaveform(0);
 	auto din_analog = GetAnalogInputWaveform(0);
-	auto din_digital = GetDigitalInputWaveform(0);
-	vector<int64_t> edges;
 
-	//Auto-threshold analog signals at 50% of full scale range
+	//Auto-threshold analog signals at 50% of full scale range.
+	//Digital signals ignore the threshold and we just find edges.
+	float threshold = 0;
 	if(din_analog)
-		FindZeroCrossings(din_analog, GetAvgVoltage(din_analog), edges);
-
-	//Just find edges in digital signals
-	else
-		FindZeroCrossings(din_digital, edges);
+		threshold = GetAvgVoltage(din_analog);
+	auto elist = GetEdges(din, threshold, EdgeCache::EDGE_ANY);
 
 	//We need at least one full cycle of the waveform to have a meaningful frequency
-	if(edges.size() < 2)
+	if(!elist || (elist->size() < 2) )
 	{
 		SetData(NULL, 0);
 		return;
 	}
+	auto& edges = *elist;
 
 	//Create the output
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 
 	size_t elen = edges.size();
 	for(size_t i=0; i < (elen - 2); i+= 2)
@@ -156,7 +156,7 @@ void HistogramFilter::Refresh()
 	if(reallocate)
 	{
 		//Reallocate our waveform
-		cap = new AnalogWaveform;
+		cap = WaveformPool::Get<AnalogWaveform>();
 		cap->m_timescale = 1;
 		cap->m_startTimestamp = din->m_startTimestamp;
 		cap->m_startFemtoseconds = din->m_startFemtoseconds;
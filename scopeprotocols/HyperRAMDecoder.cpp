@@ -93,7 +93,7 @@ void HyperRAMDecoder::Refresh()
 		data.push_back(GetDigitalInputWaveform(i + 3));
 
 	//Create the capture
-	auto cap = new HyperRAMWaveform;
+	auto cap = WaveformPool::Get<HyperRAMWaveform>();
 	cap->m_timescale = 1;
 	cap->m_startTimestamp = clk->m_startTimestamp;
 	cap->m_startFemtoseconds = clk->m_startFemtoseconds;
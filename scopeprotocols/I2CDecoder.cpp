@@ -44,6 +44,14 @@ using namespace std;
 
 I2CDecoder::I2CDecoder(const string& color)
 	: Filter(OscilloscopeChannel::CHANNEL_TYPE_COMPLEX, color, CAT_BUS)
+	, m_nextSample(0)
+	, m_lastScl(true)
+	, m_lastSda(true)
+	, m_symbolStart(0)
+	, m_currentType(I2CSymbol::TYPE_ERROR)
+	, m_currentByte(0)
+	, m_bitcount(0)
+	, m_lastWasStart(false)
 {
 	//Set up channels
 	CreateInput("sda");
@@ -72,6 +80,11 @@ string I2CDecoder::GetProtocolName()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Actual decoder logic
 
+bool I2CDecoder::SupportsIncrementalRefresh()
+{
+	return true;
+}
+
 void I2CDecoder::Refresh()
 {
 	if(!VerifyAllInputsOK())
@@ -84,14 +97,9 @@ void I2CDecoder::Refresh()
 	auto sda = GetDigitalInputWaveform(0);
 	auto scl = GetDigitalInputWaveform(1);
 
-	//Create the capture
-	auto cap = new I2CWaveform;
-	cap->m_timescale = sda->m_timescale;
-	cap->m_startTimestamp = sda->m_startTimestamp;
-	cap->m_startFemtoseconds = sda->m_startFemtoseconds;
-
 	//Loop over the data and look for transactions
 	//For now, assume equal sample rate
+	size_t				istart = 0;
 	bool				last_scl = true;
 	bool 				last_sda = true;
 	size_t				symbol_start	= 0;
@@ -101,7 +109,32 @@ void I2CDecoder::Refresh()
 	bool				last_was_start	= 0;
 	size_t len = sda->m_samples.size();
 	len = min(len, scl->m_samples.size());
-	for(size_t i=0; i<len; i++)
+
+	//If new samples were appended to the same inputs, keep the symbols we already have and carry on from the
+	//first sample we haven't looked at yet
+	auto cap = dynamic_cast<I2CWaveform*>(GetData(0));
+	if(IsIncrementalRefresh() && cap)
+	{
+		istart = m_nextSample;
+		last_scl = m_lastScl;
+		last_sda = m_lastSda;
+		symbol_start = m_symbolStart;
+		current_type = m_currentType;
+		current_byte = m_currentByte;
+		bitcount = m_bitcount;
+		last_was_start = m_lastWasStart;
+	}
+
+	//Otherwise create a new capture
+	else
+	{
+		cap = WaveformPool::Get<I2CWaveform>();
+		cap->m_timescale = sda->m_timescale;
+		cap->m_startTimestamp = sda->m_startTimestamp;
+		cap->m_startFemtoseconds = sda->m_startFemtoseconds;
+	}
+
+	for(size_t i=istart; i<len; i++)
 	{
 		bool cur_sda = sda->m_samples[i];
 		bool cur_scl = scl->m_samples[i];
@@ -206,6 +239,16 @@ void I2CDecoder::Refresh()
 		last_scl = cur_scl;
 	}
 
+	//Save our state for the next incremental refresh
+	m_nextSample = max(len, istart);
+	m_lastScl = last_scl;
+	m_lastSda = last_sda;
+	m_symbolStart = symbol_start;
+	m_currentType = current_type;
+	m_currentByte = current_byte;
+	m_bitcount = bitcount;
+	m_lastWasStart = last_was_start;
+
 	SetData(cap, 0);
 }
 
@@ -79,6 +79,7 @@ public:
 	virtual Gdk::Color GetColor(int i);
 
 	virtual void Refresh();
+	virtual bool SupportsIncrementalRefresh();
 
 	static std::string GetProtocolName();
 
@@ -87,6 +88,16 @@ public:
 	PROTOCOL_DECODER_INITPROC(I2CDecoder)
 
 protected:
+
+	//Decoder state as of the end of the last refresh, so an incremental refresh can carry on from there
+	size_t m_nextSample;
+	bool m_lastScl;
+	bool m_lastSda;
+	size_t m_symbolStart;
+	I2CSymbol::stype m_currentType;
+	uint8_t m_currentByte;
+	uint8_t m_bitcount;
+	bool m_lastWasStart;
 };
 
 #endif
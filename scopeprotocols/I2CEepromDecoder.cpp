@@ -140,7 +140,7 @@ void I2CEepromDecoder::Refresh()
 	int pointer_bits = min(16, raw_bits);
 
 	//Set up output
-	auto cap = new I2CEepromWaveform;
+	auto cap = WaveformPool::Get<I2CEepromWaveform>();
 	cap->m_timescale = din->m_timescale;
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startFemtoseconds = din->m_startFemtoseconds;
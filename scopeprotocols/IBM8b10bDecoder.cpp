@@ -93,7 +93,7 @@ void IBM8b10bDecoder::Refresh()
 	auto clkin = GetDigitalInputWaveform(1);
 
 	//Create the capture
-	auto cap = new IBM8b10bWaveform;
+	auto cap = WaveformPool::Get<IBM8b10bWaveform>();
 	cap->m_timescale = 1;
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startFemtoseconds = din->m_startFemtoseconds;
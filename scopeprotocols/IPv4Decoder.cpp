@@ -81,7 +81,7 @@ void IPv4Decoder::Refresh()
 	size_t len = din->m_samples.size();
 
 	//Loop over the events and process stuff
-	auto cap = new IPv4Waveform;
+	auto cap = WaveformPool::Get<IPv4Waveform>();
 	cap->m_timescale = din->m_timescale;
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startFemtoseconds = din->m_startFemtoseconds;
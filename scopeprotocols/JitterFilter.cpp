@@ -81,6 +81,12 @@ string JitterFilter::GetProtocolName()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Actual decoder logic
 
+bool JitterFilter::IsResultCacheable()
+{
+	//Add fresh random jitter every time, even if the input is unchanged
+	return false;
+}
+
 void JitterFilter::Refresh()
 {
 	//Make sure we've got valid inputs
@@ -142,7 +142,7 @@ void JtagDecoder::Refresh()
 	SampleOnRisingEdges(tms, tck, dtms);
 
 	//Create the capture
-	auto cap = new JtagWaveform;
+	auto cap = WaveformPool::Get<JtagWaveform>();
 	cap->m_timescale = 1;
 	cap->m_startTimestamp = tck->m_startTimestamp;
 	cap->m_startFemtoseconds = tck->m_startFemtoseconds;
@@ -97,7 +97,7 @@ void MDIODecoder::Refresh()
 	int phytype = m_parameters[m_typename].GetIntVal();
 
 	//Create the capture
-	auto cap = new MDIOWaveform;
+	auto cap = WaveformPool::Get<MDIOWaveform>();
 	cap->m_timescale = 1;	//SampleOnRisingEdges() gives us fs level timestamps
 	cap->m_startTimestamp = mdc->m_startTimestamp;
 	cap->m_startFemtoseconds = mdc->m_startFemtoseconds;
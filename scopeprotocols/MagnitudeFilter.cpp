@@ -86,7 +86,7 @@ void MagnitudeFilter::Refresh()
 	SetYAxisUnits(m_inputs[0].GetYAxisUnits(), 0);
 
 	//Set up the output waveform
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 	cap->Resize(len);
 	cap->CopyTimestamps(a);
 
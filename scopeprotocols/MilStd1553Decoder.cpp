@@ -94,7 +94,7 @@ void MilStd1553Decoder::Refresh()
 	size_t len = din->m_samples.size();
 
 	//Copy our time scales from the input
-	auto cap = new MilStd1553Waveform;
+	auto cap = WaveformPool::Get<MilStd1553Waveform>();
 	cap->m_timescale = din->m_timescale;
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startFemtoseconds = din->m_startFemtoseconds;
@@ -44,7 +44,7 @@ string MinimumStatistic::GetStatisticName()
 bool MinimumStatistic::Calculate(StreamDescriptor stream, double& value)
 {
 	//Can't do anything if we have no data
-	auto data = dynamic_cast<AnalogWaveform*>(stream.GetData());
+	auto data = GetAnalogWaveform(stream.GetData());
 	if(!data)
 		return false;
 
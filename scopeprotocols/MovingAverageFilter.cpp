@@ -70,6 +70,34 @@ string MovingAverageFilter::GetProtocolName()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Actual decoder logic
 
+/**
+	@brief Computes output samples [start, end) of the moving average
+ */
+void MovingAverageFilter::AverageBlock(AnalogWaveform* din, AnalogWaveform* cap, size_t depth, size_t start, size_t end)
+{
+	const float* samples = reinterpret_cast<const float*>(&din->m_samples[0]);
+	float* out = reinterpret_cast<float*>(&cap->m_samples[0]);
+
+	double sum = 0;
+	for(size_t j=0; j<depth; j++)
+		sum += samples[start+j];
+
+	size_t off = depth/2;
+	for(size_t i=start; i<end; i++)
+	{
+		out[i] = sum / depth;
+		sum += (double)samples[i+depth] - samples[i];
+	}
+
+	memcpy(&cap->m_offsets[start], &din->m_offsets[start+off], (end-start) * sizeof(int64_t));
+	memcpy(&cap->m_durations[start], &din->m_durations[start+off], (end-start) * sizeof(int64_t));
+}
+
+bool MovingAverageFilter::SupportsIncrementalRefresh()
+{
+	return true;
+}
+
 void MovingAverageFilter::Refresh()
 {
 	if(!VerifyAllInputsOKAndAnalog())
@@ -91,22 +119,29 @@ void MovingAverageFilter::Refresh()
 	m_xAxisUnit = m_inputs[0].m_channel->GetXAxisUnits();
 	SetYAxisUnits(m_inputs[0].GetYAxisUnits(), 0);
 
-	//Do the average
-	auto cap = new AnalogWaveform;
+	//If we're only appending to the last output, keep the samples we already have.
+	//Otherwise start over with a new waveform.
 	size_t nsamples = len - depth;
-	size_t off = depth/2;
+	size_t start = 0;
+	auto cap = dynamic_cast<AnalogWaveform*>(GetData(0));
+	if(IsIncrementalRefresh() && cap)
+		start = min(cap->size(), nsamples);
+	else
+		cap = WaveformPool::Get<AnalogWaveform>();
+
+	//Do the average.
+	//Each block keeps a running sum of the window, so the cost per sample doesn't depend on the depth.
+	//Blocks start from a freshly computed sum, which bounds rounding error and lets them run in parallel.
+	//Make sure blocks are long enough that summing the first window doesn't dominate.
 	cap->Resize(nsamples);
-	//#pragma omp parallel for
-	for(size_t i=0; i<nsamples; i++)
+	size_t blocksize = max(depth, (size_t)65536);
+	size_t nblocks = (nsamples - start + blocksize - 1) / blocksize;
+	#pragma omp parallel for
+	for(size_t block=0; block<nblocks; block++)
 	{
-		float v = 0;
-		for(size_t j=0; j<depth; j++)
-			v += din->m_samples[i+j];
-		v /= depth;
-
-		cap->m_offsets[i] = din->m_offsets[i+off];
-		cap->m_durations[i] = din->m_durations[i+off];
-		cap->m_samples[i] = v;
+		size_t bstart = start + block*blocksize;
+		size_t bend = min(bstart + blocksize, nsamples);
+		AverageBlock(din, cap, depth, bstart, bend);
 	}
 	SetData(cap, 0);
 
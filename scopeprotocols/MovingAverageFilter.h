@@ -41,6 +41,7 @@ public:
 	MovingAverageFilter(const std::string& color);
 
 	virtual void Refresh();
+	virtual bool SupportsIncrementalRefresh();
 
 	static std::string GetProtocolName();
 
@@ -49,6 +50,8 @@ public:
 	PROTOCOL_DECODER_INITPROC(MovingAverageFilter)
 
 protected:
+	static void AverageBlock(AnalogWaveform* din, AnalogWaveform* cap, size_t depth, size_t start, size_t end);
+
 	std::string m_depthname;
 };
 
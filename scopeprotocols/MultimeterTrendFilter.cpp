@@ -83,7 +83,7 @@ AnalogWaveform* MultimeterTrendFilter::GetWaveform(size_t stream)
 	auto wfm = dynamic_cast<AnalogWaveform*>(GetData(stream));
 	if(wfm == NULL)
 	{
-		wfm = new AnalogWaveform;
+		wfm = WaveformPool::Get<AnalogWaveform>();
 		SetData(wfm, stream);
 
 		//Base time unit is milliseconds, and sampling is irregular
@@ -129,37 +129,62 @@ void MultimeterTrendFilter::OnDataReady(double prival, double secval)
 	m_tlast = now;
 }
 
+/**
+	@brief Appends a sample to one of our output waveforms
+
+	Sample offsets are measured from the waveform's start time, which stays put while new samples come in, so the
+	waveform is only ever appended to and downstream filters supporting incremental refresh only see the new samples.
+	Once the history gets too long the oldest half is dropped in one go and a new append session is started.
+ */
 void MultimeterTrendFilter::AddSample(AnalogWaveform* wfm, double value, double now)
 {
 	//Remove old samples
 	size_t nmax = 4096;
-	while(wfm->m_samples.size() > nmax)
+	size_t len = wfm->m_samples.size();
+	if(len >= 2*nmax)
 	{
-		wfm->m_samples.erase(wfm->m_samples.begin());
-		wfm->m_durations.erase(wfm->m_durations.begin());
-		wfm->m_offsets.erase(wfm->m_offsets.begin());
+		size_t ndrop = len - nmax;
+		int64_t tfirst = wfm->m_offsets[ndrop];
+		wfm->m_samples.erase(wfm->m_samples.begin(), wfm->m_samples.begin() + ndrop);
+		wfm->m_durations.erase(wfm->m_durations.begin(), wfm->m_durations.begin() + ndrop);
+		wfm->m_offsets.erase(wfm->m_offsets.begin(), wfm->m_offsets.begin() + ndrop);
+
+		//Move the start time up to the first remaining sample
+		for(auto& t : wfm->m_offsets)
+			t -= tfirst;
+		double tstart = GetStartTime(wfm) + tfirst * wfm->m_timescale / FS_PER_SECOND;
+		SetStartTime(wfm, tstart);
+
+		wfm->StartAppendSession();
 	}
 
-	//Update timestamp
-	wfm->m_startTimestamp = floor(now);
-	wfm->m_startFemtoseconds = (now - wfm->m_startTimestamp) * FS_PER_SECOND;
-
-	//Update duration of previous sample
-	size_t len = wfm->m_samples.size();
-	double dt = (now - m_tlast) * (FS_PER_SECOND / wfm->m_timescale);
-	if(len > 0)
-		wfm->m_durations[len-1] = dt;
+	//First sample of a new session starts the timebase
+	if(wfm->m_samples.empty())
+	{
+		SetStartTime(wfm, now);
+		wfm->StartAppendSession();
+	}
 
 	//Add the new sample
+	len = wfm->m_samples.size();
+	int64_t offset = round( (now - GetStartTime(wfm)) * FS_PER_SECOND / wfm->m_timescale );
+	int64_t dt = round( (now - m_tlast) * FS_PER_SECOND / wfm->m_timescale );
+	if(len > 0)
+		wfm->m_durations[len-1] = offset - wfm->m_offsets[len-1];
 	wfm->m_samples.push_back(value);
 	wfm->m_durations.push_back(dt);
-	if(wfm->m_offsets.empty())
-		wfm->m_offsets.push_back(0);
-	else
-		wfm->m_offsets.push_back(dt + wfm->m_offsets[len-1]);
+	wfm->m_offsets.push_back(offset);
 
-	//Update offsets of old samples
-	len = wfm->m_samples.size();
-	for(size_t i=0; i<len; i++)
-		wfm->m_offsets[i] -= dt;
+	wfm->MarkModified();
+}
+
+double MultimeterTrendFilter::GetStartTime(AnalogWaveform* wfm)
+{
+	return wfm->m_startTimestamp + wfm->m_startFemtoseconds / FS_PER_SECOND;
+}
+
+void MultimeterTrendFilter::SetStartTime(AnalogWaveform* wfm, double t)
+{
+	wfm->m_startTimestamp = floor(t);
+	wfm->m_startFemtoseconds = (t - wfm->m_startTimestamp) * FS_PER_SECOND;
 }
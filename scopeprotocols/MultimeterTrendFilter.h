@@ -60,6 +60,8 @@ protected:
 	double m_tlast;
 
 	void AddSample(AnalogWaveform* wfm, double value, double now);
+	static double GetStartTime(AnalogWaveform* wfm);
+	static void SetStartTime(AnalogWaveform* wfm, double t);
 	AnalogWaveform* GetWaveform(size_t stream);
 };
 
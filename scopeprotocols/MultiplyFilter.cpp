@@ -68,6 +68,11 @@ string MultiplyFilter::GetProtocolName()
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Actual decoder logic
 
+bool MultiplyFilter::SupportsIncrementalRefresh()
+{
+	return true;
+}
+
 void MultiplyFilter::Refresh()
 {
 	//Make sure we've got valid inputs
@@ -94,6 +99,7 @@ void MultiplyFilter::Refresh()
 	float* fa = (float*)__builtin_assume_aligned(&a->m_samples[0], 16);
 	float* fb = (float*)__builtin_assume_aligned(&b->m_samples[0], 16);
 	float* fdst = (float*)__builtin_assume_aligned(&cap->m_samples[0], 16);
-	for(size_t i=0; i<len; i++)
+	size_t start = min(GetFirstNewSample(0), GetFirstNewSample(1));
+	for(size_t i=start; i<len; i++)
 		fdst[i] = fa[i] * fb[i];
 }
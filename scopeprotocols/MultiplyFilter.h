@@ -41,6 +41,7 @@ public:
 	MultiplyFilter(const std::string& color);
 
 	virtual void Refresh();
+	virtual bool SupportsIncrementalRefresh();
 
 	static std::string GetProtocolName();
 
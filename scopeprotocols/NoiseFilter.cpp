@@ -74,6 +74,12 @@ string NoiseFilter::GetProtocolName()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Actual decoder logic
 
+bool NoiseFilter::IsResultCacheable()
+{
+	//Add fresh random noise every time, even if the input is unchanged
+	return false;
+}
+
 void NoiseFilter::Refresh()
 {
 	//Make sure we've got valid inputs
@@ -43,6 +43,7 @@ public:
 	NoiseFilter(const std::string& color);
 
 	virtual void Refresh();
+	virtual bool IsResultCacheable();
 
 	static std::string GetProtocolName();
 
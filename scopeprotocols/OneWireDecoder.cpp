@@ -83,7 +83,7 @@ void OneWireDecoder::Refresh()
 
 	//Set up the output waveform
 	auto din = GetDigitalInputWaveform(0);
-	auto cap = new OneWireWaveform;
+	auto cap = WaveformPool::Get<OneWireWaveform>();
 	cap->m_timescale = din->m_timescale;
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startFemtoseconds = din->m_startFemtoseconds;
@@ -86,7 +86,7 @@ void OvershootMeasurement::Refresh()
 	float midpoint = (top+base)/2;
 
 	//Create the output
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 
 	int64_t		tmax = 0;
 	float		vmax = 0;
@@ -87,7 +87,7 @@ void PCIeDataLinkDecoder::Refresh()
 	auto data = dynamic_cast<PCIeLogicalWaveform*>(GetInputWaveform(0));
 
 	//Create the capture
-	auto cap = new PCIeDataLinkWaveform;
+	auto cap = WaveformPool::Get<PCIeDataLinkWaveform>();
 	cap->m_timescale = data->m_timescale;
 	cap->m_startTimestamp = data->m_startTimestamp;
 	cap->m_startFemtoseconds = data->m_startFemtoseconds;
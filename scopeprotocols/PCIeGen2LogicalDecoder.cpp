@@ -120,7 +120,7 @@ void PCIeGen2LogicalDecoder::Refresh()
 
 	//Create the capture
 	//Output is time aligned with the input
-	auto cap = new PCIeLogicalWaveform;
+	auto cap = WaveformPool::Get<PCIeLogicalWaveform>();
 	auto in0 = inputs[0];
 	cap->m_timescale = 1;
 	cap->m_startTimestamp = in0->m_startTimestamp;
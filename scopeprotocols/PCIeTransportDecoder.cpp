@@ -87,7 +87,7 @@ void PCIeTransportDecoder::Refresh()
 	auto data = dynamic_cast<PCIeDataLinkWaveform*>(GetInputWaveform(0));
 
 	//Create the capture
-	auto cap = new PCIeTransportWaveform;
+	auto cap = WaveformPool::Get<PCIeTransportWaveform>();
 	cap->m_timescale = data->m_timescale;
 	cap->m_startTimestamp = data->m_startTimestamp;
 	cap->m_startFemtoseconds = data->m_startFemtoseconds;
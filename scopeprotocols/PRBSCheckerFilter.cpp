@@ -147,7 +147,7 @@ void PRBSCheckerFilter::Refresh()
 	auto dout = dynamic_cast<DigitalWaveform*>(GetData(0));
 	if(!dout)
 	{
-		dout = new DigitalWaveform;
+		dout = WaveformPool::Get<DigitalWaveform>();
 		SetData(dout, 0);
 	}
 	dout->m_timescale = 1;
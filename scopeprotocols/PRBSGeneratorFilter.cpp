@@ -153,6 +153,12 @@ bool PRBSGeneratorFilter::RunPRBS(uint32_t& state, Polynomials poly)
 	return (bool)next;
 }
 
+bool PRBSGeneratorFilter::IsResultCacheable()
+{
+	//We generate a new waveform every time
+	return false;
+}
+
 void PRBSGeneratorFilter::Refresh()
 {
 	size_t depth = m_parameters[m_depthname].GetIntVal();
@@ -167,7 +173,7 @@ void PRBSGeneratorFilter::Refresh()
 	DigitalWaveform* dat = dynamic_cast<DigitalWaveform*>(GetData(0));
 	if(!dat)
 	{
-		dat = new DigitalWaveform;
+		dat = WaveformPool::Get<DigitalWaveform>();
 		SetData(dat, 0);
 	}
 	dat->m_timescale = samplePeriod;
@@ -180,7 +186,7 @@ void PRBSGeneratorFilter::Refresh()
 	DigitalWaveform* clk = dynamic_cast<DigitalWaveform*>(GetData(1));
 	if(!clk)
 	{
-		clk = new DigitalWaveform;
+		clk = WaveformPool::Get<DigitalWaveform>();
 		SetData(clk, 1);
 	}
 	clk->m_timescale = samplePeriod;
@@ -41,6 +41,7 @@ public:
 	PRBSGeneratorFilter(const std::string& color);
 
 	virtual void Refresh();
+	virtual bool IsResultCacheable();
 
 	static std::string GetProtocolName();
 	virtual void SetDefaultName();
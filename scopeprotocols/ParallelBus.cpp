@@ -106,14 +106,17 @@ void ParallelBus::Refresh()
 
 	//Merge all of our samples
 	//TODO: handle variable sample rates etc
-	auto cap = new DigitalBusWaveform;
+	auto cap = WaveformPool::Get<DigitalBusWaveform>(len);
 	cap->Resize(len);
 	cap->CopyTimestamps(inputs[0]);
+	cap->m_width = width;
 	#pragma omp parallel for
 	for(size_t i=0; i<len; i++)
 	{
+		uint64_t value = 0;
 		for(int j=0; j<width; j++)
-			cap->m_samples[i].push_back(inputs[j]->m_samples[i]);
+			value |= (uint64_t)inputs[j]->m_samples[i].m_value << j;
+		cap->m_samples[i] = value;
 	}
 	SetData(cap, 0);
 
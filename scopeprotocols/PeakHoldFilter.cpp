@@ -95,7 +95,7 @@ void PeakHoldFilter::Refresh()
 	bool first = false;
 	if(cap == NULL)
 	{
-		cap = new AnalogWaveform;
+		cap = WaveformPool::Get<AnalogWaveform>();
 		cap->Resize(len);
 		SetData(cap, 0);
 		first = true;
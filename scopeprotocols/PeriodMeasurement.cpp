@@ -83,8 +83,8 @@ void PeriodMeasurement::Refresh()
 	float midpoint = GetAvgVoltage(din);
 
 	//Timestamps of the edges
-	vector<int64_t> edges;
-	FindZeroCrossings(din, midpoint, edges);
+	auto elist = GetEdges(din, midpoint, EdgeCache::EDGE_ANY);
+	auto& edges = *elist;
 	if(edges.size() < 2)
 	{
 		SetData(NULL, 0);
@@ -92,7 +92,7 @@ void PeriodMeasurement::Refresh()
 	}
 
 	//Create the output
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 
 	for(size_t i=0; i < (edges.size()-2); i+= 2)
 	{
@@ -89,7 +89,7 @@ void PkPkMeasurement::Refresh()
 	float midpoint = (top+base)/2;
 
 	//Create the output
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 
 	int64_t		tmin		= 0;
 	float		vmin		= FLT_MAX;
@@ -97,7 +97,7 @@ void QSPIDecoder::Refresh()
 	auto data0 = GetDigitalInputWaveform(5);
 
 	//Create the capture
-	auto cap = new SPIWaveform;
+	auto cap = WaveformPool::Get<SPIWaveform>();
 	cap->m_timescale = clk->m_timescale;
 	cap->m_startTimestamp = clk->m_startTimestamp;
 	cap->m_startFemtoseconds = clk->m_startFemtoseconds;
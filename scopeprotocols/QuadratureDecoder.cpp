@@ -109,7 +109,7 @@ void QuadratureDecoder::Refresh()
 	int64_t debounce_samples = debounce_fs / a->m_timescale;
 
 	//Create the output waveform
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 	cap->m_timescale = a->m_timescale;
 	cap->m_startTimestamp = a->m_startTimestamp;
 	cap->m_startFemtoseconds = a->m_startFemtoseconds;
@@ -281,7 +281,7 @@ void QuadratureDecoder::Refresh()
 	//If less than 2 samples, stop
 	if(cap->m_durations.size() < 2)
 	{
-		delete cap;
+		WaveformPool::Return(cap);
 		SetData(NULL, 0);
 		return;
 	}
@@ -96,7 +96,7 @@ void SDCmdDecoder::Refresh()
 	size_t len = dcmd.m_samples.size();
 
 	//Create the capture
-	auto cap = new SDCmdWaveform;
+	auto cap = WaveformPool::Get<SDCmdWaveform>();
 	cap->m_timescale = 1;
 	cap->m_startTimestamp = clk->m_startTimestamp;
 	cap->m_startFemtoseconds = clk->m_startFemtoseconds;
@@ -111,7 +111,7 @@ void SDDataDecoder::Refresh()
 	len = min(len, d3.m_samples.size());
 
 	//Create the capture
-	auto cap = new SDDataWaveform;
+	auto cap = WaveformPool::Get<SDDataWaveform>();
 	cap->m_timescale = 1;
 	cap->m_startTimestamp = clk->m_startTimestamp;
 	cap->m_startFemtoseconds = clk->m_startFemtoseconds;
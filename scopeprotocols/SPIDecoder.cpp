@@ -44,6 +44,15 @@ using namespace std;
 
 SPIDecoder::SPIDecoder(const string& color)
 	: Filter(OscilloscopeChannel::CHANNEL_TYPE_COMPLEX, color, CAT_BUS)
+	, m_state(SPI_STATE_IDLE)
+	, m_currentByte(0)
+	, m_bitcount(0)
+	, m_bytestart(0)
+	, m_first(false)
+	, m_ics(0)
+	, m_iclk(0)
+	, m_idata(0)
+	, m_timestamp(0)
 {
 	CreateInput("clk");
 	CreateInput("cs#");
@@ -72,6 +81,11 @@ string SPIDecoder::GetProtocolName()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Actual decoder logic
 
+bool SPIDecoder::SupportsIncrementalRefresh()
+{
+	return true;
+}
+
 void SPIDecoder::Refresh()
 {
 	//Make sure we've got valid inputs
@@ -86,25 +100,12 @@ void SPIDecoder::Refresh()
 	auto csn = GetDigitalInputWaveform(1);
 	auto data = GetDigitalInputWaveform(2);
 
-	//Create the capture
-	auto cap = new SPIWaveform;
-	cap->m_timescale = clk->m_timescale;
-	cap->m_startTimestamp = clk->m_startTimestamp;
-	cap->m_startFemtoseconds = clk->m_startFemtoseconds;
-	cap->m_triggerPhase = clk->m_triggerPhase;
-
 	//TODO: different cpha/cpol modes
 
 	//TODO: packets based on CS# pulses?
 
 	//Loop over the data and look for transactions
-	enum
-	{
-		STATE_IDLE,
-		STATE_DESELECTED,
-		STATE_SELECTED_CLKLO,
-		STATE_SELECTED_CLKHI
-	} state = STATE_IDLE;
+	SPIDecodeState state = SPI_STATE_IDLE;
 
 	uint8_t	current_byte	= 0;
 	uint8_t	bitcount 		= 0;
@@ -121,8 +122,56 @@ void SPIDecoder::Refresh()
 	size_t cslen = csn->m_samples.size();
 	size_t datalen = data->m_samples.size();
 
+	//If new samples were appended to the same inputs, keep the symbols we already have and carry on from the
+	//last event we processed
+	auto cap = dynamic_cast<SPIWaveform*>(GetData(0));
+	bool resuming = IsIncrementalRefresh() && cap;
+	if(resuming)
+	{
+		state = m_state;
+		current_byte = m_currentByte;
+		bitcount = m_bitcount;
+		bytestart = m_bytestart;
+		first = m_first;
+		ics = m_ics;
+		iclk = m_iclk;
+		idata = m_idata;
+		timestamp = m_timestamp;
+	}
+
+	//Otherwise create a new capture
+	else
+	{
+		cap = WaveformPool::Get<SPIWaveform>();
+		cap->m_timescale = clk->m_timescale;
+		cap->m_startTimestamp = clk->m_startTimestamp;
+		cap->m_startFemtoseconds = clk->m_startFemtoseconds;
+		cap->m_triggerPhase = clk->m_triggerPhase;
+	}
+
+	//The samples at the starting position have only been processed already if we're resuming
+	bool advance = resuming;
 	while(true)
 	{
+		if(advance)
+		{
+			//Get timestamps of next event on each channel
+			int64_t next_cs = GetNextEventTimestamp(csn, ics, cslen, timestamp);
+			int64_t next_clk = GetNextEventTimestamp(clk, iclk, clklen, timestamp);
+
+			//If we can't move forward, stop (don't bother looking for glitches on data)
+			int64_t next_timestamp = min(next_clk, next_cs);
+			if(next_timestamp == timestamp)
+				break;
+
+			//All good, move on
+			timestamp = next_timestamp;
+			AdvanceToTimestamp(csn, ics, cslen, timestamp);
+			AdvanceToTimestamp(clk, iclk, clklen, timestamp);
+			AdvanceToTimestamp(data, idata, datalen, timestamp);
+		}
+		advance = true;
+
 		//Get the current samples
 		bool cur_cs = csn->m_samples[ics];
 		bool cur_clk = clk->m_samples[iclk];
@@ -131,16 +180,16 @@ void SPIDecoder::Refresh()
 		switch(state)
 		{
 			//Just started the decode, wait for CS# to go high (and don't attempt to decode a partial packet)
-			case STATE_IDLE:
+			case SPI_STATE_IDLE:
 				if(cur_cs)
-					state = STATE_DESELECTED;
+					state = SPI_STATE_DESELECTED;
 				break;
 
 			//wait for falling edge of CS#
-			case STATE_DESELECTED:
+			case SPI_STATE_DESELECTED:
 				if(!cur_cs)
 				{
-					state = STATE_SELECTED_CLKLO;
+					state = SPI_STATE_SELECTED_CLKLO;
 					current_byte = 0;
 					bitcount = 0;
 					bytestart = timestamp;
@@ -149,7 +198,7 @@ void SPIDecoder::Refresh()
 				break;
 
 			//wait for rising edge of clk
-			case STATE_SELECTED_CLKLO:
+			case SPI_STATE_SELECTED_CLKLO:
 				if(cur_clk)
 				{
 					if(bitcount == 0)
@@ -174,7 +223,7 @@ void SPIDecoder::Refresh()
 						bytestart = timestamp;
 					}
 
-					state = STATE_SELECTED_CLKHI;
+					state = SPI_STATE_SELECTED_CLKHI;
 
 					//TODO: selectable msb/lsb first direction
 					bitcount ++;
@@ -204,14 +253,14 @@ void SPIDecoder::Refresh()
 					cap->m_samples.push_back(SPISymbol(SPISymbol::TYPE_DESELECT, 0));
 
 					bytestart = timestamp;
-					state = STATE_DESELECTED;
+					state = SPI_STATE_DESELECTED;
 				}
 				break;
 
 			//wait for falling edge of clk
-			case STATE_SELECTED_CLKHI:
+			case SPI_STATE_SELECTED_CLKHI:
 				if(!cur_clk)
-					state = STATE_SELECTED_CLKLO;
+					state = SPI_STATE_SELECTED_CLKLO;
 
 				//end of packet
 				//TODO: error if a byte is truncated
@@ -222,28 +271,24 @@ void SPIDecoder::Refresh()
 					cap->m_samples.push_back(SPISymbol(SPISymbol::TYPE_DESELECT, 0));
 
 					bytestart = timestamp;
-					state = STATE_DESELECTED;
+					state = SPI_STATE_DESELECTED;
 				}
 
 				break;
 		}
-
-		//Get timestamps of next event on each channel
-		int64_t next_cs = GetNextEventTimestamp(csn, ics, cslen, timestamp);
-		int64_t next_clk = GetNextEventTimestamp(clk, iclk, clklen, timestamp);
-
-		//If we can't move forward, stop (don't bother looking for glitches on data)
-		int64_t next_timestamp = min(next_clk, next_cs);
-		if(next_timestamp == timestamp)
-			break;
-
-		//All good, move on
-		timestamp = next_timestamp;
-		AdvanceToTimestamp(csn, ics, cslen, timestamp);
-		AdvanceToTimestamp(clk, iclk, clklen, timestamp);
-		AdvanceToTimestamp(data, idata, datalen, timestamp);
 	}
 
+	//Save our state for the next incremental refresh
+	m_state = state;
+	m_currentByte = current_byte;
+	m_bitcount = bitcount;
+	m_bytestart = bytestart;
+	m_first = first;
+	m_ics = ics;
+	m_iclk = iclk;
+	m_idata = idata;
+	m_timestamp = timestamp;
+
 	SetData(cap, 0);
 }
 
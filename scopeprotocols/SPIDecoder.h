@@ -75,6 +75,7 @@ public:
 	virtual Gdk::Color GetColor(int i);
 
 	virtual void Refresh();
+	virtual bool SupportsIncrementalRefresh();
 
 	static std::string GetProtocolName();
 
@@ -83,6 +84,24 @@ public:
 	PROTOCOL_DECODER_INITPROC(SPIDecoder)
 
 protected:
+	enum SPIDecodeState
+	{
+		SPI_STATE_IDLE,
+		SPI_STATE_DESELECTED,
+		SPI_STATE_SELECTED_CLKLO,
+		SPI_STATE_SELECTED_CLKHI
+	};
+
+	//Decoder state as of the end of the last refresh, so an incremental refresh can carry on from there
+	SPIDecodeState m_state;
+	uint8_t m_currentByte;
+	uint8_t m_bitcount;
+	int64_t m_bytestart;
+	bool m_first;
+	size_t m_ics;
+	size_t m_iclk;
+	size_t m_idata;
+	int64_t m_timestamp;
 };
 
 #endif
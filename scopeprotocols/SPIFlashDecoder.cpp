@@ -146,7 +146,7 @@ void SPIFlashDecoder::Refresh()
 		quadlen = dquad->m_samples.size();
 
 	//Create the waveform. Call SetData() early on so we can use GetText() in the packet decode
-	auto cap = new SPIFlashWaveform;
+	auto cap = WaveformPool::Get<SPIFlashWaveform>();
 	cap->m_timescale = din->m_timescale;
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startFemtoseconds = din->m_startFemtoseconds;
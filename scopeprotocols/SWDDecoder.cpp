@@ -98,7 +98,7 @@ void SWDDecoder::Refresh()
 	auto data = GetDigitalInputWaveform(1);
 
 	//Create the capture
-	auto cap = new SWDWaveform;
+	auto cap = WaveformPool::Get<SWDWaveform>();
 	cap->m_timescale = 1;
 	cap->m_startTimestamp = clk->m_startTimestamp;
 	cap->m_startFemtoseconds = clk->m_startFemtoseconds;
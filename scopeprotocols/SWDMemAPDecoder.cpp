@@ -94,7 +94,7 @@ void SWDMemAPDecoder::Refresh()
 	}
 
 	//Set up output
-	auto cap = new SWDMemAPWaveform;
+	auto cap = WaveformPool::Get<SWDMemAPWaveform>();
 	cap->m_timescale = din->m_timescale;
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startFemtoseconds = din->m_startFemtoseconds;
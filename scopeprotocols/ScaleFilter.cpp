@@ -80,6 +80,11 @@ void ScaleFilter::SetDefaultName()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Actual decoder logic
 
+bool ScaleFilter::SupportsIncrementalRefresh()
+{
+	return true;
+}
+
 void ScaleFilter::Refresh()
 {
 	//Make sure we've got valid inputs
@@ -98,6 +103,6 @@ void ScaleFilter::Refresh()
 	auto cap = SetupOutputWaveform(din, 0, 0, 0);
 	float* out = (float*)__builtin_assume_aligned(&cap->m_samples[0], 16);
 	float* a = (float*)__builtin_assume_aligned(&din->m_samples[0], 16);
-	for(size_t i=0; i<len; i++)
+	for(size_t i=GetFirstNewSample(0); i<len; i++)
 		out[i] = a[i] * scalefactor;
 }
@@ -41,6 +41,7 @@ public:
 	ScaleFilter(const std::string& color);
 
 	virtual void Refresh();
+	virtual bool SupportsIncrementalRefresh();
 
 	static std::string GetProtocolName();
 	virtual void SetDefaultName();
@@ -37,7 +37,7 @@
 
 #include <ffts.h>
 
-class SpectrogramWaveform : public WaveformBase
+class SpectrogramWaveform : public DensityFunctionWaveform
 {
 public:
 	SpectrogramWaveform(size_t width, size_t height, float fmax, int64_t tstart, int64_t duration);
@@ -79,6 +79,12 @@ string StepGeneratorFilter::GetProtocolName()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Actual decoder logic
 
+bool StepGeneratorFilter::IsResultCacheable()
+{
+	//We generate a new waveform every time
+	return false;
+}
+
 void StepGeneratorFilter::Refresh()
 {
 	int64_t samplerate = m_parameters[m_ratename].GetIntVal();
@@ -94,7 +100,7 @@ void StepGeneratorFilter::Refresh()
 	AnalogWaveform* cap = dynamic_cast<AnalogWaveform*>(GetData(0));
 	if(!cap)
 	{
-		cap = new AnalogWaveform;
+		cap = WaveformPool::Get<AnalogWaveform>();
 		SetData(cap, 0);
 	}
 	cap->m_timescale = samplePeriod;
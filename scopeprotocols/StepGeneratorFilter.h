@@ -41,6 +41,7 @@ public:
 	StepGeneratorFilter(const std::string& color);
 
 	virtual void Refresh();
+	virtual bool IsResultCacheable();
 
 	static std::string GetProtocolName();
 
@@ -79,6 +79,11 @@ string SubtractFilter::GetProtocolName()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Actual decoder logic
 
+bool SubtractFilter::SupportsIncrementalRefresh()
+{
+	return true;
+}
+
 void SubtractFilter::Refresh()
 {
 	//Make sure we've got valid inputs
@@ -104,11 +109,17 @@ void SubtractFilter::Refresh()
 	//We need meaningful data
 	size_t len = min(din_p->m_samples.size(), din_n->m_samples.size());
 
+	//If we've already processed some of the input, only do the new stuff
+	//(rounded down to a cache line since the vector loop needs aligned pointers)
+	size_t start = min(GetFirstNewSample(0), GetFirstNewSample(1));
+	start = min(start - (start % 16), len);
+
 	//Create the output and copy timestamps
 	auto cap = SetupOutputWaveform(din_p, 0, 0, 0);
-	float* out = (float*)&cap->m_samples[0];
-	float* a = (float*)&din_p->m_samples[0];
-	float* b = (float*)&din_n->m_samples[0];
+	float* out = (float*)&cap->m_samples[start];
+	float* a = (float*)&din_p->m_samples[start];
+	float* b = (float*)&din_n->m_samples[start];
+	len -= start;
 
 	//Special case if input units are degrees: we want to do modular arithmetic
 	//TODO: vectorized version of this
@@ -41,6 +41,7 @@ public:
 	SubtractFilter(const std::string& color);
 
 	virtual void Refresh();
+	virtual bool SupportsIncrementalRefresh();
 
 	static std::string GetProtocolName();
 	virtual void SetDefaultName();
@@ -94,10 +94,10 @@ void TIEMeasurement::Refresh()
 	auto clk_digital = GetDigitalInputWaveform(0);
 	WaveformBase* clk = GetInputWaveform(0);
 	auto golden = GetDigitalInputWaveform(1);
-	size_t len = min(clk->m_offsets.size(), golden->m_offsets.size());
+	size_t len = min(clk->size(), golden->m_offsets.size());
 
 	//Create the output
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 
 	//Timestamps of the edges
 	vector<int64_t> edges;
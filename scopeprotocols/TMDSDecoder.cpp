@@ -88,7 +88,7 @@ void TMDSDecoder::Refresh()
 	auto clkin = GetDigitalInputWaveform(1);
 
 	//Create the capture
-	auto cap = new TMDSWaveform;
+	auto cap = WaveformPool::Get<TMDSWaveform>();
 	cap->m_timescale = 1;
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startFemtoseconds = din->m_startFemtoseconds;
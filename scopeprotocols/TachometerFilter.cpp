@@ -87,8 +87,8 @@ void TachometerFilter::Refresh()
 	float midpoint = GetAvgVoltage(din);
 
 	//Timestamps of the edges
-	vector<int64_t> edges;
-	FindZeroCrossings(din, midpoint, edges);
+	auto elist = GetEdges(din, midpoint, EdgeCache::EDGE_ANY);
+	auto& edges = *elist;
 	if(edges.size() < 2)
 	{
 		SetData(NULL, 0);
@@ -96,7 +96,7 @@ void TachometerFilter::Refresh()
 	}
 
 	//Create the output
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 
 	int64_t pulses_per_rev = m_parameters[m_ticksname].GetIntVal();
 	float pulses_to_rpm = 60.0f / pulses_per_rev;
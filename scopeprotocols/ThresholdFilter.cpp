@@ -75,6 +75,78 @@ string ThresholdFilter::GetProtocolName()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Actual decoder logic
 
+/**
+	@brief Converts a voltage threshold to an integer code threshold
+
+	@param din		Input waveform
+	@param volts	Threshold voltage
+	@param sign		Polarity of the waveform's gain (-1 or +1)
+	@param above	True to get the threshold for "code above volts", false for "code below volts"
+ */
+template<class T>
+static int32_t GetCodeThreshold(ADCCodeWaveform<T>* din, float volts, int32_t sign, bool above)
+{
+	//Clamp well outside the range of any ADC code so the cast can't overflow
+	float code = sign * din->VoltageToCode(volts);
+	code = max(code, -1e6f);
+	code = min(code, 1e6f);
+
+	//With integer codes, code > c is the same as code > floor(c), and code < c is the same as code < ceil(c)
+	if(above)
+		return floor(code);
+	else
+		return ceil(code);
+}
+
+/**
+	@brief Thresholds a waveform of raw ADC codes without converting it to volts
+
+	Samples before start are assumed to have been thresholded already.
+ */
+template<class T>
+static void ThresholdCodes(ADCCodeWaveform<T>* din, DigitalWaveform* cap, float midpoint, float hys, size_t start)
+{
+	//If the gain is negative, higher codes are lower voltages.
+	//Multiply codes by -1 in that case so "greater" always means "higher voltage"
+	int32_t sign = (din->m_gain < 0) ? -1 : 1;
+	size_t len = din->m_samples.size();
+	const T* samples = &din->m_samples[0];
+
+	int32_t thresh = GetCodeThreshold(din, midpoint, sign, true);
+	if(hys == 0)
+	{
+		#pragma omp parallel for
+		for(size_t i=start; i<len; i++)
+			cap->m_samples[i] = (sign * samples[i]) > thresh;
+	}
+	else
+	{
+		//Pick up the hysteresis state where we left off
+		bool cur;
+		if(start > 0)
+			cur = cap->m_samples[start-1];
+		else
+			cur = (sign * samples[0]) > thresh;
+		int32_t thresh_rising = GetCodeThreshold(din, midpoint + hys/2, sign, true);
+		int32_t thresh_falling = GetCodeThreshold(din, midpoint - hys/2, sign, false);
+
+		for(size_t i=start; i<len; i++)
+		{
+			int32_t code = sign * samples[i];
+			if(cur && (code < thresh_falling))
+				cur = false;
+			else if(!cur && (code > thresh_rising))
+				cur = true;
+			cap->m_samples[i] = cur;
+		}
+	}
+}
+
+bool ThresholdFilter::SupportsIncrementalRefresh()
+{
+	return true;
+}
+
 void ThresholdFilter::Refresh()
 {
 	if(!VerifyAllInputsOKAndAnalog())
@@ -83,30 +155,50 @@ void ThresholdFilter::Refresh()
 		return;
 	}
 
-	//Get the input data
-	auto din = GetAnalogInputWaveform(0);
-	auto len = din->m_samples.size();
-
 	//Setup
 	float midpoint = m_parameters[m_threshname].GetFloatVal();
 	float hys = m_parameters[m_hysname].GetFloatVal();
-	auto cap = SetupDigitalOutputWaveform(din, 0, 0, 0);
+	auto cap = SetupDigitalOutputWaveform(GetInputWaveform(0), 0, 0, 0);
+	size_t start = GetFirstNewSample(0);
+
+	//If the input is still raw ADC codes, work on those directly
+	auto codes8 = dynamic_cast<ADC8Waveform*>(GetInputWaveform(0));
+	if(codes8)
+	{
+		ThresholdCodes(codes8, cap, midpoint, hys, start);
+		return;
+	}
+	auto codes16 = dynamic_cast<ADC16Waveform*>(GetInputWaveform(0));
+	if(codes16)
+	{
+		ThresholdCodes(codes16, cap, midpoint, hys, start);
+		return;
+	}
+
+	//Get the input data
+	auto din = GetAnalogInputWaveform(0);
+	auto len = din->m_samples.size();
 
 	//Threshold all of our samples
 	//Optimized inner loop if no hysteresis
 	if(hys == 0)
 	{
 		#pragma omp parallel for
-		for(size_t i=0; i<len; i++)
+		for(size_t i=start; i<len; i++)
 			cap->m_samples[i] = din->m_samples[i] > midpoint;
 	}
 	else
 	{
-		bool cur = din->m_samples[0] > midpoint;
+		//Pick up the hysteresis state where we left off
+		bool cur;
+		if(start > 0)
+			cur = cap->m_samples[start-1];
+		else
+			cur = din->m_samples[0] > midpoint;
 		float thresh_rising = midpoint + hys/2;
 		float thresh_falling = midpoint - hys/2;
 
-		for(size_t i=0; i<len; i++)
+		for(size_t i=start; i<len; i++)
 		{
 			float f = din->m_samples[i];
 			if(cur && (f < thresh_falling))
@@ -93,6 +93,12 @@ void ToneGeneratorFilter::SetDefaultName()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Actual decoder logic
 
+bool ToneGeneratorFilter::IsResultCacheable()
+{
+	//We generate a new waveform every time
+	return false;
+}
+
 void ToneGeneratorFilter::Refresh()
 {
 	int64_t samplerate = m_parameters[m_ratename].GetIntVal();
@@ -110,7 +116,7 @@ void ToneGeneratorFilter::Refresh()
 	AnalogWaveform* cap = dynamic_cast<AnalogWaveform*>(GetData(0));
 	if(!cap)
 	{
-		cap = new AnalogWaveform;
+		cap = WaveformPool::Get<AnalogWaveform>();
 		SetData(cap, 0);
 	}
 	cap->m_timescale = samplePeriod;
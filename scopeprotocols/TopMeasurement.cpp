@@ -105,7 +105,7 @@ void TopMeasurement::Refresh()
 	float global_top = fbin*range + min;
 
 	//Create the output
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 
 	float last = min;
 	int64_t tedge = 0;
@@ -106,7 +106,7 @@ void TouchstoneImportFilter::OnFileNameChanged()
 			size_t base = (to*nports + from) * 2;
 
 			//Create new waveform for magnitude and phase channels
-			auto mwfm = new AnalogWaveform;
+			auto mwfm = WaveformPool::Get<AnalogWaveform>();
 			mwfm->m_timescale = 1;
 			mwfm->m_startTimestamp = timestamp;
 			mwfm->m_startFemtoseconds = fs;
@@ -115,7 +115,7 @@ void TouchstoneImportFilter::OnFileNameChanged()
 			mwfm->Resize(nsamples);
 			SetData(mwfm, base);
 
-			auto pwfm = new AnalogWaveform;
+			auto pwfm = WaveformPool::Get<AnalogWaveform>();
 			pwfm->m_timescale = 1;
 			pwfm->m_startTimestamp = timestamp;
 			pwfm->m_startFemtoseconds = fs;
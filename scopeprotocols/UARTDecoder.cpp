@@ -43,6 +43,9 @@ using namespace std;
 
 UARTDecoder::UARTDecoder(const string& color)
 	: PacketDecoder(OscilloscopeChannel::CHANNEL_TYPE_COMPLEX, color, CAT_BUS)
+	, m_resumeSample(0)
+	, m_resumeTime(0)
+	, m_openPacket(NULL)
 {
 	//Set up channels
 	CreateInput("din");
@@ -85,12 +88,16 @@ string UARTDecoder::GetProtocolName()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Actual decoder logic
 
-void UARTDecoder::Refresh()
+bool UARTDecoder::SupportsIncrementalRefresh()
 {
-	ClearPackets();
+	return true;
+}
 
+void UARTDecoder::Refresh()
+{
 	if(!VerifyAllInputsOK())
 	{
+		ClearPackets();
 		SetData(NULL, 0);
 		return;
 	}
@@ -103,18 +110,38 @@ void UARTDecoder::Refresh()
 	int64_t ibitper = bit_period;
 	int64_t scaledbitper = ibitper / din->m_timescale;
 
-	//UART processing
-	auto cap = new AsciiWaveform;
-	cap->m_timescale = din->m_timescale;
-	cap->m_startTimestamp = din->m_startTimestamp;
-	cap->m_startFemtoseconds = din->m_startFemtoseconds;
-
 	//Time-domain processing to reflect potentially variable sampling rate for RLE captures
 	int64_t next_value = 0;
 	size_t isample = 0;
 	int64_t tlast = 0;
 	Packet* pack = NULL;
 	size_t len = din->m_samples.size();
+
+	//If new samples were appended to the same input, pick up where we left off: keep the bytes we already have and
+	//reopen the packet that was in progress (it was closed off at the end of the previous data)
+	auto cap = dynamic_cast<AsciiWaveform*>(GetData(0));
+	if(IsIncrementalRefresh() && cap)
+	{
+		isample = m_resumeSample;
+		tlast = m_resumeTime;
+		if(m_openPacket && !m_packets.empty() && (m_packets.back() == m_openPacket) )
+		{
+			pack = m_openPacket;
+			m_packets.pop_back();
+		}
+	}
+
+	//Otherwise start from scratch
+	else
+	{
+		ClearPackets();
+		cap = WaveformPool::Get<AsciiWaveform>();
+		cap->m_timescale = din->m_timescale;
+		cap->m_startTimestamp = din->m_startTimestamp;
+		cap->m_startFemtoseconds = din->m_startFemtoseconds;
+	}
+
+	size_t resume = isample;
 	while(isample < len)
 	{
 		//Wait for signal to go high (idle state)
@@ -190,6 +217,9 @@ void UARTDecoder::Refresh()
 		//Append to the existing packet
 		pack->m_data.push_back(dval);
 		tlast = tstart;
+
+		//Byte is complete, so if we run out of data after this point we can resume here
+		resume = isample;
 	}
 
 	//If we have a packet in progress, add it
@@ -199,6 +229,11 @@ void UARTDecoder::Refresh()
 		FinishPacket(pack);
 	}
 
+	//Save our state for the next incremental refresh
+	m_resumeSample = resume;
+	m_resumeTime = tlast;
+	m_openPacket = pack;
+
 	SetData(cap, 0);
 }
 
@@ -48,6 +48,7 @@ public:
 	virtual std::string GetText(int i);
 
 	virtual void Refresh();
+	virtual bool SupportsIncrementalRefresh();
 
 	static std::string GetProtocolName();
 
@@ -60,6 +61,15 @@ public:
 protected:
 	void FinishPacket(Packet* pack);
 	std::string m_baudname;
+
+	///@brief Input sample to resume decoding from on an incremental refresh (start of the first incomplete byte)
+	size_t m_resumeSample;
+
+	///@brief Start time of the last byte decoded
+	int64_t m_resumeTime;
+
+	///@brief Packet that was still in progress at the end of the last refresh
+	Packet* m_openPacket;
 };
 
 #endif
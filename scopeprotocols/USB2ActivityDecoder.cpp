@@ -81,7 +81,7 @@ void USB2ActivityDecoder::Refresh()
 	auto din = dynamic_cast<USB2PCSWaveform*>(GetInputWaveform(0));
 	size_t len = din->m_samples.size();
 
-	auto cap = new DigitalWaveform;
+	auto cap = WaveformPool::Get<DigitalWaveform>();
 
 	//Start low, go high when we see a SYNC, low at EOP
 	int64_t last = 0;
@@ -81,7 +81,7 @@ void USB2PCSDecoder::Refresh()
 	size_t len = din->m_samples.size();
 
 	//Make the capture and copy our time scales from the input
-	auto cap = new USB2PCSWaveform;
+	auto cap = WaveformPool::Get<USB2PCSWaveform>();
 	cap->m_timescale = din->m_timescale;
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startFemtoseconds = din->m_startFemtoseconds;
@@ -115,7 +115,7 @@ void USB2PMADecoder::Refresh()
 
 
 	//Figure out the line state for each input (no clock recovery yet)
-	auto cap = new USB2PMAWaveform;
+	auto cap = WaveformPool::Get<USB2PMAWaveform>();
 	for(size_t i=0; i<len; i++)
 	{
 		bool bp = (din_p->m_samples[i] > threshold);
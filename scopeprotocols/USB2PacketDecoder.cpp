@@ -98,7 +98,7 @@ void USB2PacketDecoder::Refresh()
 	size_t len = din->m_samples.size();
 
 	//Make the capture and copy our time scales from the input
-	auto cap = new USB2PacketWaveform;
+	auto cap = WaveformPool::Get<USB2PacketWaveform>();
 	cap->m_timescale = din->m_timescale;
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startFemtoseconds = din->m_startFemtoseconds;
@@ -92,7 +92,7 @@ void UartClockRecoveryFilter::Refresh()
 	int64_t fs = static_cast<int64_t>(FS_PER_SECOND / baud);
 
 	//Create the output waveform and copy our timescales
-	auto cap = new DigitalWaveform;
+	auto cap = WaveformPool::Get<DigitalWaveform>();
 	cap->m_startTimestamp = din->m_startTimestamp;
 	cap->m_startFemtoseconds = din->m_startFemtoseconds;
 	cap->m_triggerPhase = 0;
@@ -86,7 +86,7 @@ void UndershootMeasurement::Refresh()
 	float midpoint = (top+base)/2;
 
 	//Create the output
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 
 	int64_t		tmin = 0;
 	float		vmin = FLT_MAX;
@@ -34,6 +34,7 @@
 
 #include "../scopehal/scopehal.h"
 #include "UpsampleFilter.h"
+#include <immintrin.h>
 
 using namespace std;
 
@@ -65,6 +66,8 @@ float blackman(float x, float width)
 
 UpsampleFilter::UpsampleFilter(const string& color)
 	: Filter(OscilloscopeChannel::CHANNEL_TYPE_ANALOG, color, CAT_MATH)
+	, m_cachedFactor(0)
+	, m_tapStride(0)
 {
 	//Set up channels
 	CreateInput("din");
@@ -114,65 +117,196 @@ void UpsampleFilter::Refresh()
 	//Configuration parameters that eventually have to be user specified
 	size_t upsample_factor = m_parameters[m_factorname].GetIntVal();
 	size_t window = 5;
-	size_t kernel = window*upsample_factor;
+	if(upsample_factor == 0)
+	{
+		SetData(NULL, 0);
+		return;
+	}
+	UpdateTaps(upsample_factor, window);
+
+	//Create the output and configure it, reusing the last one if we can
+	size_t len = din->m_samples.size();
+	size_t outlen = len * upsample_factor;
+	auto cap = SetupEmptyOutputWaveform(din, 0, false);
+	cap->Resize(outlen);
+
+	//TODO: make this work on not-dense-packed waveforms
+
+	//Logically, we upsample by inserting zeroes, then convolve with the sinc filter.
+	//Optimization: don't actually waste time multiplying by zero. Each output sample between input i and i+1 is
+	//the dot product of input samples i...i+window with one phase of the filter.
+	//Outputs too close to the end for a full window are left at zero.
+	const float* in = reinterpret_cast<const float*>(&din->m_samples[0]);
+	float* out = reinterpret_cast<float*>(&cap->m_samples[0]);
+	size_t imax = (len > window) ? len - window : 0;
+	const size_t blocksize = 16384;
+	size_t nblocks = (len + blocksize - 1) / blocksize;
+	#pragma omp parallel for
+	for(size_t block=0; block<nblocks; block++)
+	{
+		size_t istart = block * blocksize;
+		size_t iend = min(istart + blocksize, len);
+		size_t vend = min(iend, imax);
+
+		if(istart < vend)
+		{
+			if(g_hasAvx512F)
+				InterpolateAVX512F(in, out, &m_taps[0], window+1, upsample_factor, m_tapStride, istart, vend);
+			else if(g_hasAvx2)
+				InterpolateAVX2(in, out, &m_taps[0], window+1, upsample_factor, m_tapStride, istart, vend);
+			else
+				InterpolateGeneric(in, out, &m_taps[0], window+1, upsample_factor, m_tapStride, istart, vend);
+		}
+		for(size_t i=max(istart, imax)*upsample_factor; i<iend*upsample_factor; i++)
+			out[i] = 0;
+
+		for(size_t i=istart*upsample_factor; i<iend*upsample_factor; i++)
+		{
+			cap->m_offsets[i] = i;
+			cap->m_durations[i] = 1;
+		}
+	}
+
+	//Copy our time scales from the input, and correct for the upsampling
+	cap->m_timescale = din->m_timescale / upsample_factor;
+	cap->m_startTimestamp = din->m_startTimestamp;
+	cap->m_startFemtoseconds = din->m_startFemtoseconds;
+	cap->m_triggerPhase = din->m_triggerPhase;
+}
+
+/**
+	@brief Builds the polyphase filter bank for an upsample factor, if it's not the one we already have
+
+	@param factor	Upsample factor
+	@param window	Width of the interpolation filter, in input samples
+ */
+void UpsampleFilter::UpdateTaps(size_t factor, size_t window)
+{
+	if(factor == m_cachedFactor)
+		return;
 
 	//Create the interpolation filter
-	float frac_kernel = kernel * 1.0f / upsample_factor;
+	size_t kernel = window*factor;
+	float frac_kernel = kernel * 1.0f / factor;
 	vector<float> filter;
 	for(size_t i=0; i<kernel; i++)
 	{
-		float frac = i*1.0f / upsample_factor;
+		float frac = i*1.0f / factor;
 		filter.push_back(sinc(frac, frac_kernel) * blackman(frac, frac_kernel));
 	}
 
-	//Create the output and configure it
-	auto cap = new AnalogWaveform;
+	//Split it into phases. Phase 0 lines up with input sample i and uses filter taps 0, factor, 2*factor...
+	//Phase j>0 is offset by one input sample and uses taps factor-j, 2*factor-j...
+	//Transpose so each input sample's weights for all phases are contiguous.
+	m_tapStride = (factor + 15) & ~15;
+	m_taps.assign((window+1) * m_tapStride, 0);
+	for(size_t j=0; j<factor; j++)
+	{
+		size_t start = 0;
+		size_t sstart = 0;
+		if(j > 0)
+		{
+			sstart = 1;
+			start = factor - j;
+		}
+
+		for(size_t k = start; k<kernel; k += factor, sstart ++)
+			m_taps[sstart*m_tapStride + j] = filter[k];
+	}
+
+	m_cachedFactor = factor;
+}
 
-	//TODO: make this work on not-dense-packed waveforms
+/**
+	@brief Calculates the upsampled output between input samples istart and iend
 
-	//Fill out the input with samples
-	size_t len = din->m_samples.size();
-	for(size_t i=0; i < len; i++)
+	@param in		Input samples
+	@param out		Output samples
+	@param taps		Polyphase filter bank, see m_taps
+	@param ntaps	Number of rows in the filter bank
+	@param factor	Upsample factor
+	@param stride	Distance between rows of the filter bank
+	@param istart	First input sample
+	@param iend		One past the last input sample
+ */
+void UpsampleFilter::InterpolateGeneric(
+	const float* in, float* out, const float* taps, size_t ntaps, size_t factor, size_t stride,
+	size_t istart, size_t iend)
+{
+	for(size_t i=istart; i<iend; i++)
 	{
-		for(size_t j=0; j<upsample_factor; j++)
+		float* orow = out + i*factor;
+		for(size_t j=0; j<factor; j++)
 		{
-			cap->m_offsets.push_back(i * upsample_factor + j);
-			cap->m_durations.push_back(1);
-			cap->m_samples.push_back(0);
+			float f = 0;
+			for(size_t t=0; t<ntaps; t++)
+				f += taps[t*stride + j] * in[i+t];
+			orow[j] = f;
 		}
 	}
+}
 
-	//Logically, we upsample by inserting zeroes, then convolve with the sinc filter.
-	//Optimization: don't actually waste time multiplying by zero
-	//TODO: vectorize this instead of multithreading
-	size_t imax = len - window;
-	#pragma omp parallel for
-	for(size_t i=0; i < imax; i++)
+/**
+	@brief AVX2 version of InterpolateGeneric(), computing 8 phases per iteration
+ */
+__attribute__((target("avx2")))
+void UpsampleFilter::InterpolateAVX2(
+	const float* in, float* out, const float* taps, size_t ntaps, size_t factor, size_t stride,
+	size_t istart, size_t iend)
+{
+	//Mask off the phases past the end of the last vector
+	size_t rem = factor % 8;
+	__m256i tailmask = _mm256_cmpgt_epi32(_mm256_set1_epi32(rem), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+	size_t jfull = factor - rem;
+
+	for(size_t i=istart; i<iend; i++)
 	{
-		size_t offset = i * upsample_factor;
-		for(size_t j=0; j<upsample_factor; j++)
+		float* orow = out + i*factor;
+		for(size_t j=0; j<factor; j += 8)
 		{
-			size_t start = 0;
-			size_t sstart = 0;
-			if(j > 0)
+			__m256 acc = _mm256_setzero_ps();
+			for(size_t t=0; t<ntaps; t++)
 			{
-				sstart = 1;
-				start = upsample_factor - j;
+				__m256 coeff = _mm256_load_ps(taps + t*stride + j);
+				acc = _mm256_add_ps(acc, _mm256_mul_ps(coeff, _mm256_set1_ps(in[i+t])));
 			}
 
-			float f = 0;
-			for(size_t k = start; k<kernel; k += upsample_factor, sstart ++)
-				f += filter[k] * din->m_samples[i + sstart];
-
-			cap->m_samples[offset + j] = f;
+			if(j < jfull)
+				_mm256_storeu_ps(orow + j, acc);
+			else
+				_mm256_maskstore_ps(orow + j, tailmask, acc);
 		}
 	}
+}
 
-	//Copy our time scales from the input, and correct for the upsampling
-	cap->m_timescale = din->m_timescale / upsample_factor;
-	cap->m_startTimestamp = din->m_startTimestamp;
-	cap->m_startFemtoseconds = din->m_startFemtoseconds;
-	cap->m_triggerPhase = din->m_triggerPhase;
+/**
+	@brief AVX-512 version of InterpolateGeneric(), computing 16 phases per iteration
+ */
+__attribute__((target("avx512f")))
+void UpsampleFilter::InterpolateAVX512F(
+	const float* in, float* out, const float* taps, size_t ntaps, size_t factor, size_t stride,
+	size_t istart, size_t iend)
+{
+	size_t rem = factor % 16;
+	__mmask16 tailmask = (1 << rem) - 1;
+	size_t jfull = factor - rem;
 
-	SetData(cap, 0);
+	for(size_t i=istart; i<iend; i++)
+	{
+		float* orow = out + i*factor;
+		for(size_t j=0; j<factor; j += 16)
+		{
+			__m512 acc = _mm512_setzero_ps();
+			for(size_t t=0; t<ntaps; t++)
+			{
+				__m512 coeff = _mm512_load_ps(taps + t*stride + j);
+				acc = _mm512_fmadd_ps(coeff, _mm512_set1_ps(in[i+t]), acc);
+			}
+
+			if(j < jfull)
+				_mm512_storeu_ps(orow + j, acc);
+			else
+				_mm512_mask_storeu_ps(orow + j, tailmask, acc);
+		}
+	}
 }
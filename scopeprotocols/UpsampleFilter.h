@@ -49,7 +49,32 @@ public:
 	PROTOCOL_DECODER_INITPROC(UpsampleFilter)
 
 protected:
+	void UpdateTaps(size_t factor, size_t window);
+
+	static void InterpolateGeneric(
+		const float* in, float* out, const float* taps, size_t ntaps, size_t factor, size_t stride,
+		size_t istart, size_t iend);
+	static void InterpolateAVX2(
+		const float* in, float* out, const float* taps, size_t ntaps, size_t factor, size_t stride,
+		size_t istart, size_t iend);
+	static void InterpolateAVX512F(
+		const float* in, float* out, const float* taps, size_t ntaps, size_t factor, size_t stride,
+		size_t istart, size_t iend);
+
 	std::string m_factorname;
+
+	///@brief Upsample factor m_taps was calculated for
+	size_t m_cachedFactor;
+
+	///@brief Distance between rows of m_taps (factor rounded up to a whole number of AVX-512 vectors)
+	size_t m_tapStride;
+
+	/**
+		@brief Polyphase filter bank
+
+		Row t holds the weight of input sample i+t for each of the output samples between input samples i and i+1.
+	 */
+	std::vector<float, AlignedAllocator<float, 64> > m_taps;
 };
 
 #endif
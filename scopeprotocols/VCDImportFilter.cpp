@@ -99,7 +99,6 @@ void VCDImportFilter::OnFileNameChanged()
 
 	//Map of signal IDs to signals
 	map<string, WaveformBase*> waveforms;
-	map<string, size_t> widths;
 
 	//VCD is a line based format, so process everything in lines
 	char buf[2048];
@@ -246,9 +245,20 @@ void VCDImportFilter::OnFileNameChanged()
 					//Create the waveform
 					WaveformBase* wfm;
 					if(width == 1)
-						wfm = new DigitalWaveform;
+						wfm = WaveformPool::Get<DigitalWaveform>();
 					else
-						wfm = new DigitalBusWaveform;
+					{
+						if(width > 64)
+						{
+							LogWarning("Signal \"%s\" is %d bits wide, only the low 64 bits will be imported\n",
+								name, width);
+							width = 64;
+						}
+
+						auto bus = WaveformPool::Get<DigitalBusWaveform>();
+						bus->m_width = width;
+						wfm = bus;
+					}
 
 					wfm->m_timescale = timescale;
 					wfm->m_startTimestamp = timestamp;
@@ -256,7 +266,6 @@ void VCDImportFilter::OnFileNameChanged()
 					wfm->m_triggerPhase = 0;
 					wfm->m_densePacked = false;
 					waveforms[symbol] = wfm;
-					widths[symbol] = width;
 					SetData(wfm, m_streams.size() - 1);
 				}
 				break;	//end STATE_VARS
@@ -275,21 +284,16 @@ void VCDImportFilter::OnFileNameChanged()
 						auto wfm = dynamic_cast<DigitalBusWaveform*>(waveforms[symbol]);
 						if(wfm)
 						{
-							//Parse the sample data (skipping the leading 'b')
-							vector<bool> sample;
-							for(size_t i = ispace-1; i > 0; i--)
+							//Parse the sample data (skipping the leading 'b'), LSB is last.
+							//Anything past the stored width is discarded, missing MSBs are zero.
+							uint64_t sample = 0;
+							size_t width = wfm->m_width;
+							for(size_t i = ispace-1, bit = 0; (i > 0) && (bit < width); i--, bit++)
 							{
 								if(s[i] == '1')
-									sample.push_back(true);
-								else
-									sample.push_back(false);
+									sample |= (1ULL << bit);
 							}
 
-							//Zero-pad the sample out to full width
-							auto width = widths[symbol];
-							while(sample.size() < width)
-								sample.push_back(false);
-
 							//Extend the previous sample, if there is one
 							auto len = wfm->m_samples.size();
 							if(len)
@@ -86,7 +86,7 @@ void VectorPhaseFilter::Refresh()
 	auto len = min(a->m_samples.size(), b->m_samples.size());
 
 	//Set up the output waveform
-	auto cap = new AnalogWaveform;
+	auto cap = WaveformPool::Get<AnalogWaveform>();
 	cap->Resize(len);
 	cap->CopyTimestamps(a);
 
@@ -194,7 +194,7 @@ void WAVImportFilter::OnFileNameChanged()
 	for(size_t i=0; i<nchans; i++)
 	{
 		//Create new waveform for channel
-		auto wfm = new AnalogWaveform;
+		auto wfm = WaveformPool::Get<AnalogWaveform>();
 		wfm->m_timescale = interval;
 		wfm->m_startTimestamp = timestamp;
 		wfm->m_startFemtoseconds = fs;
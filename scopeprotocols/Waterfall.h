@@ -35,7 +35,7 @@
 #ifndef Waterfall_h
 #define Waterfall_h
 
-class WaterfallWaveform : public WaveformBase
+class WaterfallWaveform : public DensityFunctionWaveform
 {
 public:
 	WaterfallWaveform(size_t width, size_t height);
@@ -28,7 +28,6 @@
 ***********************************************************************************************************************/
 
 #include "../scopehal/scopehal.h"
-#include <complex>
 #include "WindowedAutocorrelationFilter.h"
 
 using namespace std;
@@ -101,7 +100,7 @@ void WindowedAutocorrelationFilter::Refresh()
 
 	//We need meaningful data, bail if it's too short
 	auto len = min(din_i->m_samples.size(), din_q->m_samples.size());
-	if(len < period_samples)
+	if(len < 2*period_samples)
 	{
 		SetData(NULL, 0);
 		return;
@@ -110,23 +109,60 @@ void WindowedAutocorrelationFilter::Refresh()
 	//Set up the output waveform
 	auto cap = SetupOutputWaveform(din_i, 0, 0, 2*period_samples);
 
+	//Slide the window along one sample at a time, adding the product entering it and subtracting the one leaving.
+	//Blocks start from a freshly computed sum, which bounds rounding error and lets them run in parallel.
+	//Make sure blocks are long enough that summing the first window doesn't dominate.
 	size_t end = len - 2*period_samples;
-	for(size_t i=0; i < end; i ++)
+	size_t blocksize = max(window_samples, (size_t)65536);
+	size_t nblocks = (end + blocksize - 1) / blocksize;
+	#pragma omp parallel for
+	for(size_t block=0; block<nblocks; block++)
 	{
-		complex<float> total = 0;
-		for(size_t j=0; j<window_samples; j++)
-		{
-			size_t first = i + j;
-			size_t second = first + period_samples;
-
-			complex<float> a(din_i->m_samples[first], din_q->m_samples[first]);
-			complex<float> b(din_i->m_samples[second], din_q->m_samples[second]);
-
-			total += a*b;
-		}
+		size_t bstart = block*blocksize;
+		size_t bend = min(bstart + blocksize, end);
+		CorrelateBlock(din_i, din_q, cap, window_samples, period_samples, bstart, bend);
+	}
+}
 
-		float v = abs(total) / window_samples;
+/**
+	@brief Calculates output samples [start, end)
+ */
+void WindowedAutocorrelationFilter::CorrelateBlock(
+	AnalogWaveform* din_i,
+	AnalogWaveform* din_q,
+	AnalogWaveform* cap,
+	size_t window_samples,
+	size_t period_samples,
+	size_t start,
+	size_t end)
+{
+	const float* pi = reinterpret_cast<const float*>(&din_i->m_samples[0]);
+	const float* pq = reinterpret_cast<const float*>(&din_q->m_samples[0]);
+	float* out = reinterpret_cast<float*>(&cap->m_samples[0]);
+
+	//Sum of (I[k] + jQ[k]) * (I[k+period] + jQ[k+period]) over the window
+	double re = 0;
+	double im = 0;
+	for(size_t j=0; j<window_samples; j++)
+	{
+		size_t first = start + j;
+		size_t second = first + period_samples;
+		re += (double)pi[first]*pi[second] - (double)pq[first]*pq[second];
+		im += (double)pi[first]*pq[second] + (double)pq[first]*pi[second];
+	}
 
-		cap->m_samples[i] = v;
+	for(size_t i=start; i<end; i++)
+	{
+		out[i] = sqrt(re*re + im*im) / window_samples;
+
+		//Window end never runs past the input, since end is 2*period_samples short of it and window <= period
+		size_t enter = i + window_samples;
+		size_t enter2 = enter + period_samples;
+		size_t leave = i;
+		size_t leave2 = leave + period_samples;
+		re += ((double)pi[enter]*pi[enter2] - (double)pq[enter]*pq[enter2])
+			- ((double)pi[leave]*pi[leave2] - (double)pq[leave]*pq[leave2]);
+		im += ((double)pi[enter]*pq[enter2] + (double)pq[enter]*pi[enter2])
+			- ((double)pi[leave]*pq[leave2] + (double)pq[leave]*pi[leave2]);
 	}
 }
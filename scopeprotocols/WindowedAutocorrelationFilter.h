@@ -49,6 +49,15 @@ public:
 	PROTOCOL_DECODER_INITPROC(WindowedAutocorrelationFilter)
 
 protected:
+	static void CorrelateBlock(
+		AnalogWaveform* din_i,
+		AnalogWaveform* din_q,
+		AnalogWaveform* cap,
+		size_t window_samples,
+		size_t period_samples,
+		size_t start,
+		size_t end);
+
 	std::string m_windowName;
 	std::string m_periodName;
 };